@@ -24,6 +24,7 @@ int main() {
 #include "rocksdb/env.h"
 #include "util/gflags_compat.h"
 #include "util/mutexlock.h"
+#include "util/numa_util.h"
 #include "util/random.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
@@ -48,6 +49,13 @@ DEFINE_int32(erase_percent, 10,
 
 DEFINE_bool(use_clock_cache, false, "");
 
+DEFINE_bool(numa_aware, false,
+            "Give every NUMA node its own LRU cache shards, see "
+            "LRUCacheOptions::numa_aware");
+
+DEFINE_bool(bind_numa_nodes, false,
+            "Bind benchmark thread i to NUMA node i % number of nodes");
+
 namespace rocksdb {
 
 class CacheBench;
@@ -139,7 +147,11 @@ class CacheBench {
         exit(1);
       }
     } else {
-      cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+      LRUCacheOptions cache_opts(FLAGS_cache_size, FLAGS_num_shard_bits,
+                                 false /* strict_capacity_limit */,
+                                 0.0 /* high_pri_pool_ratio */);
+      cache_opts.numa_aware = FLAGS_numa_aware;
+      cache_ = NewLRUCache(cache_opts);
     }
   }
 
@@ -200,6 +212,9 @@ class CacheBench {
   static void ThreadBody(void* v) {
     ThreadState* thread = reinterpret_cast<ThreadState*>(v);
     SharedState* shared = thread->shared;
+    if (FLAGS_bind_numa_nodes) {
+      NumaBindCurrentThread(static_cast<int>(thread->tid % NumaNumNodes()));
+    }
 
     {
       MutexLock l(shared->GetMutex());
@@ -252,6 +267,9 @@ class CacheBench {
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %d\n", FLAGS_num_shard_bits);
+    printf("NUMA nodes          : %d\n", NumaNumNodes());
+    printf("NUMA aware cache    : %d\n", FLAGS_numa_aware);
+    printf("Bind NUMA nodes     : %d\n", FLAGS_bind_numa_nodes);
     printf("Max key             : %" PRIu64 "\n", FLAGS_max_key);
     printf("Populate cache      : %d\n", FLAGS_populate_cache);
     printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
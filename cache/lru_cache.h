@@ -60,6 +60,8 @@ struct LRUHandle {
   //   in_high_pri_pool: whether this entry is in high-pri pool.
   char flags;
 
+  uint8_t numa_node;  // NUMA node of the owning shard
+
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
 
   char key_data[1];  // Beginning of key
@@ -160,7 +162,7 @@ class LRUHandleTable {
 class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
  public:
   LRUCacheShard(size_t capacity, bool strict_capacity_limit,
-                double high_pri_pool_ratio);
+                double high_pri_pool_ratio, int numa_node = 0);
   virtual ~LRUCacheShard();
 
   // Separate from constructor so caller can easily make an array of LRUCache
@@ -243,6 +245,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // Remember the value to avoid recomputing each time.
   double high_pri_pool_capacity_;
 
+  // NUMA node whose threads use this shard, stamped into its handles
+  uint8_t numa_node_;
+
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
   // LRU contains items which can be evicted, ie reference only by cache
@@ -280,7 +285,8 @@ class LRUCache : public ShardedCache {
  public:
   LRUCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
            double high_pri_pool_ratio,
-           std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
+           std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+           int num_numa_nodes = 1);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -288,6 +294,7 @@ class LRUCache : public ShardedCache {
   virtual void* Value(Handle* handle) override;
   virtual size_t GetCharge(Handle* handle) const override;
   virtual uint32_t GetHash(Handle* handle) const override;
+  virtual int GetNumaNode(Handle* handle) const override;
   virtual void DisownData() override;
 
   //  Retrieves number of elements in LRU, for unit test purpose only
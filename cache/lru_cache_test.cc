@@ -188,6 +188,41 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+TEST_F(LRUCacheTest, NumaNodeShards) {
+  // Two nodes with two shards each
+  LRUCache lru_cache(8, 1 /*num_shard_bits*/, false /*strict_capacity_limit*/,
+                     0.0 /*high_pri_pool_ratio*/,
+                     nullptr /*memory_allocator*/, 2 /*num_numa_nodes*/);
+  Cache* cache = &lru_cache;
+  ASSERT_EQ(2, lru_cache.GetNumNumaNodes());
+  ASSERT_EQ(4, lru_cache.GetNumShards());
+  ASSERT_EQ(8, cache->GetCapacity());
+
+  Cache::Handle* handle = nullptr;
+  ASSERT_OK(cache->Insert("a", nullptr /*value*/, 1 /*charge*/,
+                          nullptr /*deleter*/, &handle));
+  ASSERT_NE(nullptr, handle);
+  int node = lru_cache.GetNumaNode(handle);
+  ASSERT_TRUE(node == 0 || node == 1);
+  ASSERT_EQ(1, cache->GetPinnedUsage());
+  ASSERT_FALSE(cache->Release(handle));
+  ASSERT_EQ(0, cache->GetPinnedUsage());
+  ASSERT_EQ(1, cache->GetUsage());
+  if (NumaNumNodes() == 1) {
+    // Every thread runs on node 0, so lookups see the insert
+    ASSERT_EQ(0, node);
+    handle = cache->Lookup("a");
+    ASSERT_NE(nullptr, handle);
+    ASSERT_EQ(0, lru_cache.GetNumaNode(handle));
+    cache->Release(handle);
+  }
+
+  // Erase reaches every node
+  cache->Erase("a");
+  ASSERT_EQ(0, cache->GetUsage());
+  ASSERT_EQ(nullptr, cache->Lookup("a"));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
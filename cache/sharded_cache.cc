@@ -13,6 +13,7 @@
 
 #include "cache/sharded_cache.h"
 
+#include <algorithm>
 #include <string>
 
 #include "util/mutexlock.h"
@@ -21,15 +22,17 @@ namespace rocksdb {
 
 ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
                            bool strict_capacity_limit,
-                           std::shared_ptr<MemoryAllocator> allocator)
+                           std::shared_ptr<MemoryAllocator> allocator,
+                           int num_numa_nodes)
     : Cache(std::move(allocator)),
       num_shard_bits_(num_shard_bits),
+      num_numa_nodes_(std::max(1, num_numa_nodes)),
       capacity_(capacity),
       strict_capacity_limit_(strict_capacity_limit),
       last_id_(1) {}
 
 void ShardedCache::SetCapacity(size_t capacity) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
   MutexLock l(&capacity_mutex_);
   for (int s = 0; s < num_shards; s++) {
@@ -39,7 +42,7 @@ void ShardedCache::SetCapacity(size_t capacity) {
 }
 
 void ShardedCache::SetStrictCapacityLimit(bool strict_capacity_limit) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   MutexLock l(&capacity_mutex_);
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->SetStrictCapacityLimit(strict_capacity_limit);
@@ -51,28 +54,31 @@ Status ShardedCache::Insert(const Slice& key, void* value, size_t charge,
                             void (*deleter)(const Slice& key, void* value),
                             Handle** handle, Priority priority) {
   uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))
+  return GetShard(LocalShard(hash))
       ->Insert(key, hash, value, charge, deleter, handle, priority);
 }
 
 Cache::Handle* ShardedCache::Lookup(const Slice& key, Statistics* /*stats*/) {
   uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))->Lookup(key, hash);
+  return GetShard(LocalShard(hash))->Lookup(key, hash);
 }
 
 bool ShardedCache::Ref(Handle* handle) {
   uint32_t hash = GetHash(handle);
-  return GetShard(Shard(hash))->Ref(handle);
+  return GetShard(Shard(GetNumaNode(handle), hash))->Ref(handle);
 }
 
 bool ShardedCache::Release(Handle* handle, bool force_erase) {
   uint32_t hash = GetHash(handle);
-  return GetShard(Shard(hash))->Release(handle, force_erase);
+  return GetShard(Shard(GetNumaNode(handle), hash))
+      ->Release(handle, force_erase);
 }
 
 void ShardedCache::Erase(const Slice& key) {
   uint32_t hash = HashSlice(key);
-  GetShard(Shard(hash))->Erase(key, hash);
+  for (int node = 0; node < num_numa_nodes_; ++node) {
+    GetShard(Shard(node, hash))->Erase(key, hash);
+  }
 }
 
 uint64_t ShardedCache::NewId() {
@@ -91,7 +97,7 @@ bool ShardedCache::HasStrictCapacityLimit() const {
 
 size_t ShardedCache::GetUsage() const {
   // We will not lock the cache when getting the usage from shards.
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   size_t usage = 0;
   for (int s = 0; s < num_shards; s++) {
     usage += GetShard(s)->GetUsage();
@@ -105,7 +111,7 @@ size_t ShardedCache::GetUsage(Handle* handle) const {
 
 size_t ShardedCache::GetPinnedUsage() const {
   // We will not lock the cache when getting the usage from shards.
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   size_t usage = 0;
   for (int s = 0; s < num_shards; s++) {
     usage += GetShard(s)->GetPinnedUsage();
@@ -115,14 +121,14 @@ size_t ShardedCache::GetPinnedUsage() const {
 
 void ShardedCache::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                           bool thread_safe) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->ApplyToAllCacheEntries(callback, thread_safe);
   }
 }
 
 void ShardedCache::EraseUnRefEntries() {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->EraseUnRefEntries();
   }
@@ -140,6 +146,8 @@ std::string ShardedCache::GetPrintableOptions() const {
     ret.append(buffer);
     snprintf(buffer, kBufferSize, "    num_shard_bits : %d\n", num_shard_bits_);
     ret.append(buffer);
+    snprintf(buffer, kBufferSize, "    num_numa_nodes : %d\n", num_numa_nodes_);
+    ret.append(buffer);
     snprintf(buffer, kBufferSize, "    strict_capacity_limit : %d\n",
              strict_capacity_limit_);
     ret.append(buffer);
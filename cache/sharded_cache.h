@@ -15,6 +15,7 @@
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "util/hash.h"
+#include "util/numa_util.h"
 
 namespace rocksdb {
 
@@ -45,10 +46,16 @@ class CacheShard {
 // Generic cache interface which shards cache by hash of keys. 2^num_shard_bits
 // shards will be created, with capacity split evenly to each of the shards.
 // Keys are sharded by the highest num_shard_bits bits of hash value.
+//
+// With num_numa_nodes > 1 every NUMA node has its own 2^num_shard_bits shards,
+// node n owning shards [n << num_shard_bits, (n + 1) << num_shard_bits).
+// Inserts and lookups go to the shards of the caller's node, handles are
+// routed by GetNumaNode() and erases go to every node.
 class ShardedCache : public Cache {
  public:
   ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-               std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
+               std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+               int num_numa_nodes = 1);
   virtual ~ShardedCache() = default;
   virtual const char* Name() const override = 0;
   virtual CacheShard* GetShard(int shard) = 0;
@@ -56,6 +63,8 @@ class ShardedCache : public Cache {
   virtual void* Value(Handle* handle) override = 0;
   virtual size_t GetCharge(Handle* handle) const = 0;
   virtual uint32_t GetHash(Handle* handle) const = 0;
+  // Node whose shards hold the handle, only needed with num_numa_nodes > 1
+  virtual int GetNumaNode(Handle* /*handle*/) const { return 0; }
   virtual void DisownData() override = 0;
 
   virtual void SetCapacity(size_t capacity) override;
@@ -80,6 +89,8 @@ class ShardedCache : public Cache {
   virtual std::string GetPrintableOptions() const override;
 
   int GetNumShardBits() const { return num_shard_bits_; }
+  int GetNumNumaNodes() const { return num_numa_nodes_; }
+  int GetNumShards() const { return num_numa_nodes_ << num_shard_bits_; }
 
  private:
   static inline uint32_t HashSlice(const Slice& s) {
@@ -91,7 +102,17 @@ class ShardedCache : public Cache {
     return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
   }
 
+  uint32_t Shard(int numa_node, uint32_t hash) {
+    return (static_cast<uint32_t>(numa_node) << num_shard_bits_) | Shard(hash);
+  }
+
+  uint32_t LocalShard(uint32_t hash) {
+    return num_numa_nodes_ > 1 ? Shard(NumaNodeOfCurrentThread(), hash)
+                               : Shard(hash);
+  }
+
   int num_shard_bits_;
+  int num_numa_nodes_;
   mutable port::Mutex capacity_mutex_;
   size_t capacity_;
   bool strict_capacity_limit_;
@@ -52,17 +52,18 @@ TableBuilder* NewTableBuilder(
     const CompressionOptions& compression_opts, int level,
     double compaction_load, const std::string* compression_dict,
     bool skip_filters, uint64_t creation_time, uint64_t oldest_key_time,
-    SstPurpose sst_purpose) {
+    SstPurpose sst_purpose, bool urgent) {
   assert((column_family_id ==
           TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) ==
          column_family_name.empty());
-  return ioptions.table_factory->NewTableBuilder(
-      TableBuilderOptions(ioptions, moptions, internal_comparator,
-                          int_tbl_prop_collector_factories, compression_type,
-                          compression_opts, compression_dict, skip_filters,
-                          column_family_name, level, compaction_load,
-                          creation_time, oldest_key_time, sst_purpose),
-      column_family_id, file);
+  TableBuilderOptions table_builder_options(
+      ioptions, moptions, internal_comparator, int_tbl_prop_collector_factories,
+      compression_type, compression_opts, compression_dict, skip_filters,
+      column_family_name, level, compaction_load, creation_time,
+      oldest_key_time, sst_purpose);
+  table_builder_options.urgent = urgent;
+  return ioptions.table_factory->NewTableBuilder(table_builder_options,
+                                                 column_family_id, file);
 }
 
 Status BuildTable(
@@ -140,12 +141,17 @@ Status BuildTable(
       file_writer.reset(new WritableFileWriter(std::move(file), fname,
                                                env_options, ioptions.statistics,
                                                ioptions.listeners));
+      if (ioptions.io_heatmap != nullptr) {
+        file_writer->SetIOHeatmap(ioptions.io_heatmap,
+                                  sst_meta()->fd.GetNumber(), env);
+      }
       builder = NewTableBuilder(
           ioptions, mutable_cf_options, internal_comparator,
           int_tbl_prop_collector_factories, column_family_id,
           column_family_name, file_writer.get(), compression, compression_opts,
           level, compaction_load, nullptr /* compression_dict */,
-          false /* skip_filters */, creation_time, oldest_key_time);
+          false /* skip_filters */, creation_time, oldest_key_time,
+          kEssenceSst, reason == TableFileCreationReason::kFlush);
     }
 
     MergeHelper merge(env, internal_comparator.user_comparator(),
@@ -274,6 +280,10 @@ Status BuildTable(
         separate_helper.file_writer.reset(
             new WritableFileWriter(std::move(blob_file), fname, env_options,
                                    ioptions.statistics, ioptions.listeners));
+        if (ioptions.io_heatmap != nullptr) {
+          separate_helper.file_writer->SetIOHeatmap(
+              ioptions.io_heatmap, blob_meta->fd.GetNumber(), env);
+        }
         separate_helper.builder.reset(NewTableBuilder(
             ioptions, mutable_cf_options, internal_comparator,
             int_tbl_prop_collector_factories, column_family_id,
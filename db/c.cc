@@ -2425,6 +2425,11 @@ void rocksdb_options_set_max_manifest_edit_count(rocksdb_options_t* opt,
   opt->rep.max_manifest_edit_count = v;
 }
 
+void rocksdb_options_set_max_manifest_tail_ratio(rocksdb_options_t* opt,
+                                                 double v) {
+  opt->rep.max_manifest_tail_ratio = v;
+}
+
 void rocksdb_options_set_table_cache_numshardbits(rocksdb_options_t* opt,
                                                   int v) {
   opt->rep.table_cache_numshardbits = v;
@@ -26,6 +26,7 @@
 #include "db/db_impl.h"
 #include "db/internal_stats.h"
 #include "db/job_context.h"
+#include "db/merge_context.h"
 #include "db/range_del_aggregator.h"
 #include "db/table_properties_collector.h"
 #include "db/version_set.h"
@@ -471,6 +472,10 @@ ColumnFamilyData::ColumnFamilyData(
     internal_stats_.reset(
         new InternalStats(ioptions_.num_levels, db_options.env, this));
     table_cache_.reset(new TableCache(ioptions_, env_options, _table_cache));
+    if (ioptions_.merge_result_cache) {
+      PutVarint64(&merge_result_cache_id_,
+                  ioptions_.merge_result_cache->NewId());
+    }
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(new LevelCompactionPicker(
           table_cache_.get(), env_options, ioptions_, &internal_comparator_));
@@ -986,9 +991,26 @@ void ColumnFamilyData::CreateNewMemtable(
   mem_->Ref();
 }
 
+void ColumnFamilyData::SetMergeResultCache(const ReadOptions& read_options,
+                                           MergeContext* merge_context) const {
+  // Reads that skip a tier may see another newest operand for the same key.
+  // A compaction filter may drop or rewrite older operands without changing
+  // the sequence number of the newest one, which would leave stale results
+  if (ioptions_.merge_result_cache != nullptr &&
+      ioptions_.merge_operator != nullptr &&
+      ioptions_.compaction_filter == nullptr &&
+      ioptions_.compaction_filter_factory == nullptr &&
+      read_options.read_tier == kReadAllTier) {
+    merge_context->SetResultCache(ioptions_.merge_result_cache.get(),
+                                  merge_result_cache_id_);
+  }
+}
+
 bool ColumnFamilyData::NeedsCompaction() const {
-  return !current_->storage_info()->IsPickCompactionFail() &&
-         compaction_picker_->NeedsCompaction(current_->storage_info());
+  auto vstorage = current_->storage_info();
+  return !vstorage->IsPickCompactionFail() &&
+         (compaction_picker_->NeedsCompaction(vstorage) ||
+          !vstorage->FilesMarkedForMigration().empty());
 }
 
 bool ColumnFamilyData::NeedsGarbageCollection() const {
@@ -1004,6 +1026,11 @@ Compaction* ColumnFamilyData::PickCompaction(
   auto* result = compaction_picker_->PickCompaction(GetName(), mutable_options,
                                                     current_->storage_info(),
                                                     snapshots, log_buffer);
+  if (result == nullptr) {
+    // Files are only moved between paths when there's nothing to compact
+    result = compaction_picker_->PickTemperatureMigration(
+        GetName(), mutable_options, current_->storage_info(), log_buffer);
+  }
   if (result != nullptr) {
     result->SetInputVersion(current_);
     result->set_compaction_load(current_->GetCompactionLoad());
@@ -269,6 +269,11 @@ class ColumnFamilyData {
 
   TableCache* table_cache() const { return table_cache_.get(); }
 
+  // Lets a read with read_options reuse and keep full merge results in
+  // ioptions()->merge_result_cache
+  void SetMergeResultCache(const ReadOptions& read_options,
+                           MergeContext* merge_context) const;
+
   // See documentation in compaction_picker.h
   // REQUIRES: DB mutex held
   bool NeedsCompaction() const;
@@ -442,6 +447,9 @@ class ColumnFamilyData {
 
   std::unique_ptr<TableCache> table_cache_;
 
+  // Key prefix of this column family in ioptions_.merge_result_cache
+  std::string merge_result_cache_id_;
+
   std::unique_ptr<InternalStats> internal_stats_;
 
   WriteBufferManager* write_buffer_manager_;
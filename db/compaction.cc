@@ -235,6 +235,16 @@ Compaction::Compaction(CompactionParams&& params)
 
   GetBoundaryKeys(params.input_version, inputs_, &smallest_user_key_,
                   &largest_user_key_);
+
+  if (immutable_cf_options_.temperature_aware_placement &&
+      !is_manual_compaction_ && !deletion_compaction_ &&
+      compaction_reason_ != CompactionReason::kTemperatureMigration) {
+    // Map compactions only write a small index over their inputs
+    uint64_t output_size =
+        compaction_type_ == kMapCompaction ? 0 : CalculateTotalInputSize();
+    output_path_id_ = input_vstorage_->TemperaturePathId(
+        immutable_cf_options_, ReadDensity(), output_size, output_path_id_);
+  }
 }
 
 Compaction::~Compaction() {
@@ -261,6 +271,19 @@ bool Compaction::InputCompressionMatchesOutput() const {
   return matches;
 }
 
+double Compaction::ReadDensity() const {
+  uint64_t num_reads_sampled = 0;
+  uint64_t input_size = 0;
+  for (auto& input : inputs_) {
+    for (auto f : input.files) {
+      num_reads_sampled +=
+          f->stats.num_reads_sampled.load(std::memory_order_relaxed);
+      input_size += f->fd.GetFileSize();
+    }
+  }
+  return num_reads_sampled / std::max<double>(1, input_size);
+}
+
 bool Compaction::IsTrivialMove() const {
   // Avoid a move if there is lots of overlapping grandparent data.
   // Otherwise, the move could create a parent file that will require
@@ -273,6 +273,9 @@ class Compaction {
   // Whether need to write output file to second DB path.
   uint32_t output_path_id() const { return output_path_id_; }
 
+  // Sampled reads per byte over all input files.
+  double ReadDensity() const;
+
   // Is this a trivial compaction that can be implemented by just
   // moving a single input file to the next level (no merging or splitting)
   bool IsTrivialMove() const;
@@ -461,7 +464,7 @@ class Compaction {
   ColumnFamilyData* cfd_;
   Arena arena_;  // Arena used to allocate space for file_levels_
 
-  const uint32_t output_path_id_;
+  uint32_t output_path_id_;
   CompressionType output_compression_;
   CompressionOptions output_compression_opts_;
   // If true, then the comaction can be done by simply deleting input files.
@@ -5,6 +5,8 @@
 
 #include "db/compaction_iterator.h"
 
+#include <functional>
+
 #include "db/snapshot_checker.h"
 #include "port/likely.h"
 #include "rocksdb/listener.h"
@@ -103,6 +105,180 @@ InternalIterator* NewCompactionIterator(
                                                   arg, start_user_key);
 }
 
+// Reads a window of records ahead of the compaction iterator and fetches the
+// separated values the compaction filter asked for, sorted by blob file so
+// reads into the same file are issued back to back. It replaces both the
+// input iterator and the separate helper of CompactionIterator::input_, and
+// hands out a prefetched value when the record it belongs to is combined.
+class FilterValuePrefetcher : public InternalIterator, public SeparateHelper {
+ public:
+  using NeedValueCallback =
+      std::function<bool(const ParsedInternalKey&, const Slice&)>;
+
+  FilterValuePrefetcher(InternalIterator* iter, SeparateHelper* separate_helper,
+                        const Slice* end, const Comparator* cmp, size_t window,
+                        NeedValueCallback need_value)
+      : iter_(iter),
+        separate_helper_(separate_helper),
+        end_(end),
+        cmp_(cmp),
+        window_(window),
+        need_value_(std::move(need_value)) {
+    // Records are never moved once read, prefetched values refer to their
+    // user keys
+    window_records_.reserve(window_);
+  }
+
+  // The input may have been positioned before the prefetcher took it over
+  void EnsurePositioned() {
+    if (!positioned_) {
+      Fill();
+    }
+  }
+
+  bool Valid() const override { return pos_ < window_records_.size(); }
+  Slice key() const override {
+    assert(Valid());
+    return window_records_[pos_].key;
+  }
+  LazyBuffer value() const override {
+    assert(Valid());
+    return LazyBufferReference(window_records_[pos_].value);
+  }
+  Status status() const override {
+    return Valid() ? Status::OK() : iter_->status();
+  }
+  void Next() override {
+    assert(Valid());
+    if (++pos_ == window_records_.size()) {
+      Fill();
+    }
+  }
+  void Prev() override { assert(false); }
+  void Seek(const Slice& target) override {
+    iter_->Seek(target);
+    has_last_user_key_ = false;
+    Fill();
+  }
+  void SeekForPrev(const Slice& /*target*/) override { assert(false); }
+  void SeekToFirst() override {
+    iter_->SeekToFirst();
+    has_last_user_key_ = false;
+    Fill();
+  }
+  void SeekToLast() override { assert(false); }
+
+  using SeparateHelper::TransToSeparate;
+
+  Status TransToSeparate(const Slice& internal_key, LazyBuffer& value,
+                         const Slice& meta, bool is_merge,
+                         bool is_index) override {
+    return separate_helper_->TransToSeparate(internal_key, value, meta,
+                                             is_merge, is_index);
+  }
+
+  Status TransToSeparate(const Slice& internal_key,
+                         LazyBuffer& value) override {
+    return separate_helper_->TransToSeparate(internal_key, value);
+  }
+
+  LazyBuffer TransToCombined(const Slice& user_key, uint64_t sequence,
+                             const LazyBuffer& value) const override {
+    if (Valid()) {
+      auto& record = window_records_[pos_];
+      if (record.prefetched && record.sequence == sequence &&
+          ExtractUserKey(record.key) == user_key) {
+        record.prefetched = false;
+        return std::move(record.combined);
+      }
+    }
+    return separate_helper_->TransToCombined(user_key, sequence, value);
+  }
+
+ private:
+  struct Record {
+    std::string key;
+    // Copy of the input value, the input has moved on
+    LazyBuffer value;
+    uint64_t sequence = 0;
+    mutable bool prefetched = false;
+    mutable LazyBuffer combined;
+  };
+
+  void Fill();
+
+  InternalIterator* iter_;
+  SeparateHelper* separate_helper_;
+  const Slice* end_;
+  const Comparator* cmp_;
+  const size_t window_;
+  NeedValueCallback need_value_;
+  bool positioned_ = false;
+  std::vector<Record> window_records_;
+  size_t pos_ = 0;
+  // Only the newest version of a user key is passed to the filter
+  std::string last_user_key_;
+  bool has_last_user_key_ = false;
+};
+
+void FilterValuePrefetcher::Fill() {
+  positioned_ = true;
+  window_records_.clear();
+  pos_ = 0;
+  std::vector<size_t> prefetch;
+  while (window_records_.size() < window_ && iter_->Valid()) {
+    Slice internal_key = iter_->key();
+    ParsedInternalKey ikey;
+    bool parsed = ParseInternalKey(internal_key, &ikey);
+    if (parsed && end_ != nullptr &&
+        cmp_->Compare(ikey.user_key, *end_) >= 0) {
+      break;
+    }
+    window_records_.emplace_back();
+    Record& record = window_records_.back();
+    record.key.assign(internal_key.data(), internal_key.size());
+    record.value.assign(iter_->value());
+    iter_->Next();
+    if (!parsed) {
+      has_last_user_key_ = false;
+      continue;
+    }
+    record.sequence = ikey.sequence;
+    Slice user_key = ExtractUserKey(record.key);
+    bool newest =
+        !has_last_user_key_ || !cmp_->Equal(user_key, last_user_key_);
+    last_user_key_.assign(user_key.data(), user_key.size());
+    has_last_user_key_ = true;
+    if (!newest || ikey.type != kTypeValueIndex || !record.value.valid() ||
+        record.value.size() < sizeof(uint64_t)) {
+      continue;
+    }
+    ikey.user_key = user_key;
+    if (!need_value_(ikey, DecodeValueMeta(record.value.slice()))) {
+      continue;
+    }
+    record.combined = separate_helper_->TransToCombined(
+        user_key, ikey.sequence, record.value);
+    if (record.combined.file_number() != uint64_t(-1)) {
+      prefetch.emplace_back(window_records_.size() - 1);
+    }
+  }
+  // Blob SSTs are sorted by user key too, so input order within a file is
+  // file order
+  std::stable_sort(prefetch.begin(), prefetch.end(), [&](size_t a, size_t b) {
+    return window_records_[a].combined.file_number() <
+           window_records_[b].combined.file_number();
+  });
+  for (size_t i : prefetch) {
+    Record& record = window_records_[i];
+    // A failed fetch is retried and reported by the filter call
+    record.prefetched = record.combined.fetch().ok();
+    if (!record.prefetched) {
+      record.combined.reset();
+    }
+  }
+}
+
 CompactionIterator::CompactionIterator(
     InternalIterator* input, SeparateHelper* separate_helper, const Slice* end,
     const Comparator* cmp, MergeHelper* merge_helper,
@@ -187,6 +363,18 @@ CompactionIterator::CompactionIterator(
   } else {
     ignore_snapshots_ = false;
   }
+  size_t prefetch_window = compaction_filter_ == nullptr
+                               ? 0
+                               : compaction_filter_->ValuePrefetchWindow();
+  if (prefetch_window > 0 && input_.separate_helper() != nullptr) {
+    value_prefetcher_.reset(new FilterValuePrefetcher(
+        input_.iter_, input_.separate_helper(), end_, cmp_, prefetch_window,
+        [this](const ParsedInternalKey& ikey, const Slice& value_meta) {
+          return FilterNeedsValue(ikey, value_meta);
+        }));
+    input_.iter_ = value_prefetcher_.get();
+    input_.separate_helper_ = value_prefetcher_.get();
+  }
 }
 
 CompactionIterator::~CompactionIterator() {}
@@ -201,6 +389,9 @@ void CompactionIterator::ResetRecordCounts() {
 }
 
 void CompactionIterator::SeekToFirst() {
+  if (value_prefetcher_) {
+    value_prefetcher_->EnsurePositioned();
+  }
   NextFromInput();
   if (valid_) {
     PrepareOutput();
@@ -313,6 +504,18 @@ void CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
   }
 }
 
+bool CompactionIterator::FilterNeedsValue(const ParsedInternalKey& ikey,
+                                          const Slice& value_meta) {
+  // Same conditions as InvokeFilterIfNeeded(), except the commit check
+  return (visible_at_tip_ || ignore_snapshots_ ||
+          ikey.sequence > latest_snapshot_ ||
+          (snapshot_checker_ != nullptr &&
+           !snapshot_checker_->IsInSnapshot(ikey.sequence,
+                                            latest_snapshot_))) &&
+         compaction_filter_->NeedValue(compaction_->level(), ikey.user_key,
+                                       value_meta);
+}
+
 void CompactionIterator::SetFilterSampleInterval(size_t sample_interval) {
   assert((sample_interval & (sample_interval - 1)) == 0);  // must be power of 2
   filter_sample_interval_ = sample_interval;
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <deque>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,8 @@
 
 namespace rocksdb {
 
+class FilterValuePrefetcher;
+
 class CompactionIterator {
  public:
     friend class CompactionIteratorToInternalIterator;
@@ -124,6 +127,11 @@ class CompactionIterator {
   // Invoke compaction filter if needed.
   void InvokeFilterIfNeeded(bool* need_skip, Slice* skip_until);
 
+  // Whether InvokeFilterIfNeeded() is expected to pass the separated value of
+  // `ikey` to the compaction filter and the filter asks for it. Used to pick
+  // the values to prefetch.
+  bool FilterNeedsValue(const ParsedInternalKey& ikey, const Slice& value_meta);
+
   // Given a sequence number, return the sequence number of the
   // earliest snapshot that this sequence number is visible in.
   // The snapshots themselves are arranged in ascending order of
@@ -138,6 +146,9 @@ class CompactionIterator {
   // or seqnum be zero-ed out even if all other conditions for it are met.
   inline bool ikeyNotNeededForIncrementalSnapshot();
 
+  // Reads ahead of input_ to batch the value fetches of the compaction
+  // filter, see CompactionFilter::ValuePrefetchWindow()
+  std::unique_ptr<FilterValuePrefetcher> value_prefetcher_;
   CombinedInternalIterator input_;
   const Slice* end_;
   const Comparator* cmp_;
@@ -132,6 +132,8 @@ const char* GetCompactionReasonString(CompactionReason compaction_reason) {
       return "GarbageCollection";
     case CompactionReason::kRangeDeletion:
       return "RangeDeletion";
+    case CompactionReason::kTemperatureMigration:
+      return "TemperatureMigration";
     case CompactionReason::kNumOfReasons:
       // fall through
     default:
@@ -599,6 +601,43 @@ void CompactionJob::GenSubcompactionBoundaries(int max_usable_threads) {
       }
     }
   }
+  // File endpoints can't split a compaction of a few huge files, so files
+  // are also split at key anchors sampled from their tables. Every file gets
+  // anchors in proportion to its share of the input, the sizes of the ranges
+  // in between are weighed below like any other.
+  auto* vstorage = c->input_version()->storage_info();
+  std::vector<std::pair<const FileMetaData*, uint64_t>> input_files;
+  uint64_t total_input_size = 0;
+  for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+    int lvl = c->level(lvl_idx);
+    if (lvl < start_lvl || lvl > out_lvl) {
+      continue;
+    }
+    const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
+    for (size_t i = 0; i < flevel->num_files; i++) {
+      auto f = flevel->files[i].file_metadata;
+      uint64_t size = vstorage->FileSizeWithBlob(f, false, 1);
+      input_files.emplace_back(f, size);
+      total_input_size += size;
+    }
+  }
+  size_t total_anchors =
+      std::min<size_t>(max_usable_threads, c->max_subcompactions()) *
+      kKeyAnchorsPerSubcompaction;
+  key_anchors_.clear();
+  db_mutex_->Unlock();
+  for (auto& input : input_files) {
+    size_t num_anchors = static_cast<size_t>(
+        double(total_anchors) * input.second /
+        std::max<uint64_t>(1, total_input_size));
+    versions_->GetKeyAnchors(c->input_version(), input.first, num_anchors,
+                             &key_anchors_);
+  }
+  db_mutex_->Lock();
+  for (auto& anchor : key_anchors_) {
+    bounds.emplace_back(anchor);
+  }
+
   terark::sort_a(bounds, &ExtractUserKey < *cfd_comparator);
 
   // Remove duplicated entries from bounds
@@ -2326,6 +2365,17 @@ Status CompactionJob::InstallCompactionResults(
   }
 
   auto cfd = compaction->column_family_data();
+  // Outputs inherit the read heat of the inputs, otherwise temperature aware
+  // placement would take freshly compacted hot data for cold data.
+  double read_density =
+      compaction->immutable_cf_options()->temperature_aware_placement
+          ? compaction->ReadDensity()
+          : 0;
+  auto inherit_reads = [read_density](const FileMetaData& meta) {
+    meta.stats.num_reads_sampled.store(
+        static_cast<uint64_t>(read_density * meta.fd.GetFileSize()),
+        std::memory_order_relaxed);
+  };
   if (compaction->compaction_type() == kMapCompaction &&
       !compaction->input_range().empty()) {
     MapBuilder map_builder(job_id_, db_options_, env_options_, versions_,
@@ -2337,10 +2387,13 @@ Status CompactionJob::InstallCompactionResults(
                               ir.include_limit);
     }
     db_mutex_->Unlock();
+    // With a snapshot checker, sequence numbers alone can't tell whether a
+    // tombstone is visible, so don't drop covered ranges
     auto s = map_builder.Build(
         *compaction->inputs(), push_range, compaction->output_level(),
         compaction->output_path_id(), cfd, compaction->input_version(),
-        compact_->compaction->edit(), &output);
+        compact_->compaction->edit(), &output,
+        snapshot_checker_ == nullptr ? &existing_snapshots_ : nullptr);
     if (s.ok()) {
       for (auto& o : output) {
         // test map sst
@@ -2420,7 +2473,11 @@ Status CompactionJob::InstallCompactionResults(
                                added_files, compaction->output_level(),
                                compaction->output_path_id(), cfd,
                                compaction->input_version(),
-                               compact_->compaction->edit(), &file_meta, &prop);
+                               compact_->compaction->edit(), &file_meta, &prop,
+                               nullptr /* deleted_files */,
+                               snapshot_checker_ == nullptr
+                                   ? &existing_snapshots_
+                                   : nullptr);
     if (s.ok() && file_meta.fd.file_size > 0) {
       // test map sst
       DependenceMap empty_dependence_map;
@@ -2459,6 +2516,7 @@ Status CompactionJob::InstallCompactionResults(
 
     for (const auto& sub_compact : compact_->sub_compact_states) {
       for (const auto& out : sub_compact.outputs) {
+        inherit_reads(out.meta);
         compaction->edit()->AddFile(compaction->output_level(), out.meta);
         compaction->AddOutputTableFileNumber(out.meta.fd.GetNumber());
       }
@@ -2467,6 +2525,7 @@ Status CompactionJob::InstallCompactionResults(
 
   for (const auto& sub_compact : compact_->sub_compact_states) {
     for (const auto& out : sub_compact.blob_outputs) {
+      inherit_reads(out.meta);
       compaction->edit()->AddFile(-1, out.meta);
       compaction->AddOutputTableFileNumber(out.meta.fd.GetNumber());
     }
@@ -2578,6 +2637,10 @@ Status CompactionJob::OpenCompactionOutputFile(
   sub_compact->outfile.reset(
       new WritableFileWriter(std::move(writable_file), fname, env_options_,
                              db_options_.statistics.get(), listeners));
+  if (db_options_.io_heatmap != nullptr) {
+    sub_compact->outfile->SetIOHeatmap(db_options_.io_heatmap.get(),
+                                       file_number, env_);
+  }
 
   // If the Column family flag is to only optimize filters for hits,
   // we can skip creating filters if this is the bottommost_level where
@@ -2612,7 +2675,8 @@ Status CompactionJob::OpenCompactionOutputFile(
       0 /* oldest_key_time */,
       sub_compact->compaction->compaction_type() == kMapCompaction
           ? kMapSst
-          : kEssenceSst));
+          : kEssenceSst,
+      c->start_level() == 0 /* urgent */));
   LogFlush(db_options_.info_log);
   return s;
 }
@@ -2671,6 +2735,10 @@ Status CompactionJob::OpenCompactionOutputBlob(
   sub_compact->blob_outfile.reset(
       new WritableFileWriter(std::move(writable_file), fname, env_options_,
                              db_options_.statistics.get(), listeners));
+  if (db_options_.io_heatmap != nullptr) {
+    sub_compact->blob_outfile->SetIOHeatmap(db_options_.io_heatmap.get(),
+                                            file_number, env_);
+  }
 
   uint64_t output_file_creation_time =
       sub_compact->compaction->MaxInputFileCreationTime();
@@ -110,6 +110,10 @@ class CompactionJob {
  private:
   struct SubcompactionState;
 
+  // Key anchors taken from the input tables per subcompaction the
+  // compaction may be split into
+  static const size_t kKeyAnchorsPerSubcompaction = 4;
+
   void AggregateStatistics();
   void GenSubcompactionBoundaries(int max_usable_threads);
 
@@ -192,6 +196,8 @@ class CompactionJob {
   bool bottommost_level_;
   bool paranoid_file_checks_;
   bool measure_io_stats_;
+  // Keys sampled from the input tables, boundaries_ may point into them
+  std::vector<std::string> key_anchors_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<Slice> boundaries_;
   // Stores the approx size of keys covered in the range of each subcompaction
@@ -872,6 +872,39 @@ Compaction* CompactionPicker::PickGarbageCollection(
   return RegisterCompaction(new Compaction(std::move(params)));
 }
 
+Compaction* CompactionPicker::PickTemperatureMigration(
+    const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+    VersionStorageInfo* vstorage, LogBuffer* log_buffer) {
+  for (auto& migration : vstorage->FilesMarkedForMigration()) {
+    FileMetaData* f = migration.file;
+    if (f->being_compacted) {
+      continue;
+    }
+    std::vector<CompactionInputFiles> inputs(1);
+    inputs.front().level = migration.level;
+    inputs.front().files.push_back(f);
+    if (migration.level > 0 &&
+        FilesRangeOverlapWithCompaction(inputs, migration.level)) {
+      continue;
+    }
+    ROCKS_LOG_BUFFER(log_buffer,
+                     "[%s] Temperature migration of #%" PRIu64
+                     " at level-%d from path %" PRIu32 " to path %" PRIu32,
+                     cf_name.c_str(), f->fd.GetNumber(), migration.level,
+                     f->fd.GetPathId(), migration.path_id);
+
+    CompactionParams params(vstorage, ioptions_, mutable_cf_options);
+    params.inputs = std::move(inputs);
+    params.output_level = migration.level;
+    params.output_path_id = migration.path_id;
+    params.max_subcompactions = 1;
+    params.score = 0;
+    params.compaction_reason = CompactionReason::kTemperatureMigration;
+    return RegisterCompaction(new Compaction(std::move(params)));
+  }
+  return nullptr;
+}
+
 void CompactionPicker::InitFilesBeingCompact(
     const MutableCFOptions& mutable_cf_options, VersionStorageInfo* vstorage,
     const InternalKey* begin, const InternalKey* end,
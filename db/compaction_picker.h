@@ -107,6 +107,12 @@ class CompactionPicker {
                                     VersionStorageInfo* vstorage,
                                     LogBuffer* log_buffer);
 
+  // Pick a file marked by temperature aware placement and move it to the
+  // path its read density belongs to, without rewriting it.
+  Compaction* PickTemperatureMigration(
+      const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+      VersionStorageInfo* vstorage, LogBuffer* log_buffer);
+
   virtual void InitFilesBeingCompact(
       const MutableCFOptions& mutable_cf_options, VersionStorageInfo* vstorage,
       const InternalKey* begin, const InternalKey* end,
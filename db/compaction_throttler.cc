@@ -0,0 +1,109 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction_throttler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "options/db_options.h"
+
+namespace rocksdb {
+
+CompactionThrottler::CompactionThrottler(const ImmutableDBOptions& db_options,
+                                         HistReporterHandle* read_reporter,
+                                         HistReporterHandle* write_reporter)
+    : enabled_(db_options.compaction_throttle_read_p99_micros > 0 ||
+               db_options.compaction_throttle_write_p99_micros > 0),
+      read_p99_micros_(db_options.compaction_throttle_read_p99_micros),
+      write_p99_micros_(db_options.compaction_throttle_write_p99_micros),
+      min_ratio_(std::min(
+          1.0, std::max(0.0, db_options.compaction_throttle_min_ratio))),
+      rate_limiter_(db_options.rate_limiter.get()),
+      max_bytes_per_sec_(rate_limiter_ == nullptr
+                             ? 0
+                             : rate_limiter_->GetBytesPerSecond()),
+      read_reporter_(read_reporter, enabled_),
+      write_reporter_(write_reporter, enabled_),
+      ratio_(1.0) {
+  if (enabled_ && max_bytes_per_sec_ > 0) {
+    compaction_rate_limiter_.reset(
+        new ThrottledRateLimiter(rate_limiter_, max_bytes_per_sec_));
+  }
+}
+
+CompactionThrottler::ThrottledRateLimiter::ThrottledRateLimiter(
+    RateLimiter* base, int64_t bytes_per_sec)
+    : base_(base), throttle_(NewGenericRateLimiter(bytes_per_sec)) {}
+
+void CompactionThrottler::ThrottledRateLimiter::Request(
+    const int64_t bytes, const Env::IOPriority pri, Statistics* stats,
+    OpType op_type) {
+  if (pri == Env::IO_LOW) {
+    // statistics are recorded once, by the DB's rate limiter
+    throttle_->Request(bytes, pri, nullptr, op_type);
+  }
+  base_->Request(bytes, pri, stats, op_type);
+}
+
+int64_t CompactionThrottler::ThrottledRateLimiter::GetSingleBurstBytes()
+    const {
+  return std::min(base_->GetSingleBurstBytes(),
+                  throttle_->GetSingleBurstBytes());
+}
+
+bool CompactionThrottler::Tune() {
+  if (!enabled_) {
+    return false;
+  }
+  bool over_target = false;
+  bool headroom = true;
+  auto check = [&](HistogramStat* window, uint64_t target) {
+    if (target == 0) {
+      return;
+    }
+    if (window->num() >= kMinSamples) {
+      double p99 = window->Percentile(99);
+      over_target |= p99 > target;
+      headroom &= p99 <= target * 0.8;
+    }
+    window->Clear();
+  };
+  check(read_reporter_.window(), read_p99_micros_);
+  check(write_reporter_.window(), write_p99_micros_);
+
+  double old_ratio = ratio();
+  double new_ratio = old_ratio;
+  if (over_target) {
+    new_ratio = std::max(min_ratio_, old_ratio * 0.5);
+  } else if (headroom) {
+    new_ratio = std::min(1.0, old_ratio + (1.0 - min_ratio_) * 0.1);
+  }
+  if (new_ratio == old_ratio) {
+    return false;
+  }
+  ratio_.store(new_ratio, std::memory_order_relaxed);
+  if (compaction_rate_limiter_ != nullptr) {
+    compaction_rate_limiter_->throttle()->SetBytesPerSecond(std::max<int64_t>(
+        1, static_cast<int64_t>(max_bytes_per_sec_ * new_ratio)));
+  }
+  return true;
+}
+
+void CompactionThrottler::Reset() {
+  ratio_.store(1.0, std::memory_order_relaxed);
+  if (compaction_rate_limiter_ != nullptr) {
+    compaction_rate_limiter_->throttle()->SetBytesPerSecond(
+        max_bytes_per_sec_);
+  }
+}
+
+uint32_t CompactionThrottler::ThrottleSubcompactions(
+    uint32_t num_subcompactions) const {
+  double throttled = std::ceil(num_subcompactions * ratio());
+  return std::max<uint32_t>(1, static_cast<uint32_t>(throttled));
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,145 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "monitoring/histogram.h"
+#include "rocksdb/metrics_reporter.h"
+#include "rocksdb/rate_limiter.h"
+
+namespace rocksdb {
+
+struct ImmutableDBOptions;
+
+// Throttles compaction and garbage collection from foreground latency.
+//
+// The DB's read and write latency reporters are wrapped so every record is
+// also added to a window histogram. Tune() is called periodically: while the
+// p99 of either window is above its target the throttle ratio is halved,
+// once both have 20% headroom it recovers by 10% of the full range. The
+// ratio scales the number of subcompactions a compaction may use and, if
+// DBOptions::rate_limiter is set, the bytes per second of a second limiter
+// that compaction and GC output writes (IO_LOW) are charged to on top of
+// rate_limiter. Flush writes and the rate of rate_limiter itself are left
+// alone, so throttling can not slow flushes down and feed back into write
+// latency. The ratio never drops below compaction_throttle_min_ratio.
+class CompactionThrottler {
+ public:
+  // Passes every request to the DB's rate limiter, and charges IO_LOW writes
+  // to the throttled limiter first
+  class ThrottledRateLimiter : public RateLimiter {
+   public:
+    ThrottledRateLimiter(RateLimiter* base, int64_t bytes_per_sec);
+
+    void SetBytesPerSecond(int64_t bytes_per_second) override {
+      base_->SetBytesPerSecond(bytes_per_second);
+    }
+    using RateLimiter::Request;
+    void Request(const int64_t bytes, const Env::IOPriority pri,
+                 Statistics* stats, OpType op_type) override;
+    int64_t GetSingleBurstBytes() const override;
+    int64_t GetTotalBytesThrough(
+        const Env::IOPriority pri = Env::IO_TOTAL) const override {
+      return base_->GetTotalBytesThrough(pri);
+    }
+    int64_t GetTotalRequests(
+        const Env::IOPriority pri = Env::IO_TOTAL) const override {
+      return base_->GetTotalRequests(pri);
+    }
+    int64_t GetBytesPerSecond() const override {
+      return base_->GetBytesPerSecond();
+    }
+    bool IsRateLimited(OpType op_type) override {
+      return base_->IsRateLimited(op_type);
+    }
+
+    RateLimiter* throttle() { return throttle_.get(); }
+
+   private:
+    RateLimiter* base_;
+    std::unique_ptr<RateLimiter> throttle_;
+  };
+
+  // Forwards records to the wrapped reporter, and to a window histogram
+  // when the throttler is enabled.
+  class FeedbackReporter : public HistReporterHandle {
+   public:
+    FeedbackReporter(HistReporterHandle* target, bool enabled)
+        : target_(target), enabled_(enabled) {}
+
+    void AddRecord(size_t val) override {
+      target_->AddRecord(val);
+      if (enabled_) {
+        window_.Add(val);
+      }
+    }
+
+    HistogramStat* window() { return &window_; }
+
+   private:
+    HistReporterHandle* target_;
+    const bool enabled_;
+    HistogramStat window_;
+  };
+
+  // A window with fewer records carries no signal and is ignored
+  static const uint64_t kMinSamples = 20;
+  static const uint64_t kTunePeriodMicros = 1000000;
+
+  CompactionThrottler(const ImmutableDBOptions& db_options,
+                      HistReporterHandle* read_reporter,
+                      HistReporterHandle* write_reporter);
+
+  bool enabled() const { return enabled_; }
+
+  HistReporterHandle& read_reporter() { return read_reporter_; }
+  HistReporterHandle& write_reporter() { return write_reporter_; }
+
+  double ratio() const { return ratio_.load(std::memory_order_relaxed); }
+
+  // Closes the current windows and adjusts the ratio. Returns true if the
+  // ratio changed.
+  bool Tune();
+
+  // Back to ratio 1, when tuning stops
+  void Reset();
+
+  // The rate limiter of compaction and GC output files
+  RateLimiter* compaction_rate_limiter() const {
+    return compaction_rate_limiter_ != nullptr
+               ? compaction_rate_limiter_.get()
+               : rate_limiter_;
+  }
+
+  // Bytes per second compaction and GC output is throttled to, 0 without
+  // rate_limiter
+  int64_t throttled_bytes_per_sec() const {
+    return compaction_rate_limiter_ == nullptr
+               ? 0
+               : compaction_rate_limiter_->throttle()->GetBytesPerSecond();
+  }
+
+  // Scales the number of subcompactions of one compaction, at least 1
+  uint32_t ThrottleSubcompactions(uint32_t num_subcompactions) const;
+
+ private:
+  const bool enabled_;
+  const uint64_t read_p99_micros_;
+  const uint64_t write_p99_micros_;
+  const double min_ratio_;
+  RateLimiter* rate_limiter_;
+  // Bytes per second of rate_limiter_ when the DB was opened, the rate at
+  // ratio 1
+  int64_t max_bytes_per_sec_;
+  std::unique_ptr<ThrottledRateLimiter> compaction_rate_limiter_;
+  FeedbackReporter read_reporter_;
+  FeedbackReporter write_reporter_;
+  std::atomic<double> ratio_;
+};
+
+}  // namespace rocksdb
@@ -426,6 +426,30 @@ TEST_F(DBBasicTest, ManifestRollOver) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, ManifestTailRatio) {
+  Options options = CurrentOptions();
+  options.max_manifest_tail_ratio = 1;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  uint64_t manifest_number = dbfull()->TEST_Current_Manifest_FileNo();
+  int rolls = 0;
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(Flush());
+    uint64_t new_manifest_number = dbfull()->TEST_Current_Manifest_FileNo();
+    rolls += new_manifest_number != manifest_number;
+    manifest_number = new_manifest_number;
+  }
+  // Every flush adds a file to the checkpoint, so the tail allowed before the
+  // next roll keeps growing
+  ASSERT_GT(rolls, 0);
+  ASSERT_LT(rolls, 10);
+  Reopen(options);
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+}
+
 TEST_F(DBBasicTest, IdentityAcrossRestarts) {
   do {
     std::string id1;
@@ -448,6 +472,32 @@ TEST_F(DBBasicTest, IdentityAcrossRestarts) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, PersistTableWarmState) {
+  Options options = CurrentOptions();
+  options.persist_table_warm_state = true;
+  options.max_open_files = -1;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      ASSERT_OK(Put(Key(i * 10 + j), "v" + ToString(i * 10 + j)));
+    }
+    ASSERT_OK(Flush());
+  }
+  // Each reopen records the state of the previous run and opens the tables
+  // in the background, reads must not wait for it
+  for (int round = 0; round < 2; ++round) {
+    Reopen(options);
+    for (int i = 0; i < 30; ++i) {
+      ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+    }
+  }
+  Close();
+  ASSERT_OK(env_->FileExists(TableWarmStateFileName(dbname_)));
+  Reopen(options);
+  ASSERT_EQ("v0", Get(Key(0)));
+}
+
 #ifndef ROCKSDB_LITE
 TEST_F(DBBasicTest, Snapshot) {
   anon::OptionsOverride options_override;
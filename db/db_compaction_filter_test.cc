@@ -133,6 +133,46 @@ class SkipEvenFilter : public CompactionFilter {
   virtual const char* Name() const override { return "DeleteFilter"; }
 };
 
+// Needs the value of every third key, and removes those whose value starts
+// with 'x'. Counts how many values were already fetched when FilterV2() was
+// called.
+class PrefetchValueFilter : public CompactionFilter {
+ public:
+  virtual size_t ValuePrefetchWindow() const override { return 16; }
+
+  virtual bool NeedValue(int /*level*/, const Slice& key,
+                         const Slice& /*existing_value_meta*/) const override {
+    return std::stoi(key.ToString()) % 3 == 0;
+  }
+
+  virtual Decision FilterV2(int /*level*/, const Slice& key,
+                            ValueType /*value_type*/,
+                            const Slice& /*existing_value_meta*/,
+                            const LazyBuffer& existing_value,
+                            LazyBuffer* new_value,
+                            std::string* /*skip_until*/) const override {
+    cfilter_count++;
+    bool fetched = existing_value.valid();
+    if (std::stoi(key.ToString()) % 3 != 0) {
+      unneeded_fetched += fetched;
+      return Decision::kKeep;
+    }
+    prefetched += fetched;
+    auto s = existing_value.fetch();
+    if (!s.ok()) {
+      new_value->reset(std::move(s));
+      return Decision::kChangeValue;
+    }
+    return existing_value.slice().starts_with("x") ? Decision::kRemove
+                                                   : Decision::kKeep;
+  }
+
+  virtual const char* Name() const override { return "PrefetchValueFilter"; }
+
+  mutable int prefetched = 0;
+  mutable int unneeded_fetched = 0;
+};
+
 class DelayFilter : public CompactionFilter {
  public:
   explicit DelayFilter(DBTestBase* d) : db_test(d) {}
@@ -879,6 +919,43 @@ TEST_F(DBTestCompactionFilter, SkipUntilWithBloomFilter) {
   EXPECT_EQ("v50", val);
 }
 
+TEST_F(DBTestCompactionFilter, PrefetchSeparatedValues) {
+  PrefetchValueFilter filter;
+  Options options = CurrentOptions();
+  options.compaction_filter = &filter;
+  options.disable_auto_compactions = true;
+  options.blob_size = 128;
+  options.create_if_missing = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; ++i) {
+    char key[100];
+    snprintf(key, sizeof(key), "%010d", i);
+    ASSERT_OK(Put(key, std::string(1000, i % 6 == 0 ? 'x' : 'v')));
+  }
+  ASSERT_OK(Flush());
+
+  cfilter_count = 0;
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(100, cfilter_count);
+  // Every needed value was fetched before the filter saw it, no other
+  ASSERT_EQ(34, filter.prefetched);
+  ASSERT_EQ(0, filter.unneeded_fetched);
+
+  for (int i = 0; i < 100; ++i) {
+    char key[100];
+    snprintf(key, sizeof(key), "%010d", i);
+    std::string val;
+    Status s = db_->Get(ReadOptions(), key, &val);
+    if (i % 6 == 0) {
+      ASSERT_TRUE(s.IsNotFound());
+    } else {
+      ASSERT_OK(s);
+      ASSERT_EQ(std::string(1000, 'v'), val);
+    }
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -12,6 +12,7 @@
 #include "port/stack_trace.h"
 #include "rocksdb/experimental.h"
 #include "rocksdb/utilities/convenience.h"
+#include "table/block_based_table_factory.h"
 #include "util/fault_injection_test_env.h"
 #include "util/sync_point.h"
 #include "utilities/merge_operators/string_append/stringappend2.h"
@@ -3947,6 +3948,91 @@ TEST_F(DBCompactionTest, CompactionStatsTest) {
   VerifyCompactionStats(*cfd, *collector);
 }
 
+TEST_F(DBCompactionTest, SubcompactionsSplitSingleFile) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_subcompactions = 4;
+  options.max_background_jobs = 8;
+  options.target_file_size_base = 64 << 10;
+  options.compression = kNoCompression;
+  DestroyAndReopen(options);
+
+  // The output level must not be empty to form subcompactions
+  ASSERT_OK(Put(Key(0), "v"));
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+
+  // A single L0 file, its endpoints alone give one range
+  Random rnd(301);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 1000)));
+  }
+  ASSERT_OK(Flush());
+
+  std::atomic<int> num_subcompactions(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():Inprogress",
+      [&](void* /*arg*/) { num_subcompactions++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(4, num_subcompactions.load());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(1000, Get(Key(i)).size());
+  }
+}
+
+TEST_F(DBCompactionTest, BuildDeferredByTableFactory) {
+  // Refuses the first few compactions that aren't urgent
+  class DeferringTableFactory : public BlockBasedTableFactory {
+   public:
+    bool AdmitBuild(uint64_t /*table_size*/, int /*output_level*/,
+                    bool urgent) const override {
+      if (urgent) {
+        ++num_urgent;
+        return true;
+      }
+      return num_deferrals.fetch_sub(1) <= 0;
+    }
+    mutable std::atomic<int> num_deferrals{3};
+    mutable std::atomic<int> num_urgent{0};
+  };
+  auto table_factory = std::make_shared<DeferringTableFactory>();
+
+  Options options = CurrentOptions();
+  options.table_factory = table_factory;
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.disable_auto_compactions = true;
+  options.level0_file_num_compaction_trigger = 1;
+  options.max_bytes_for_level_base = 1;
+  options.num_levels = 3;
+  DestroyAndReopen(options);
+
+  // L1 far over its target, so L1 -> L2 compactions follow the L0 one
+  Random rnd(301);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 10; j++) {
+      ASSERT_OK(Put(Key(i * 10 + j), RandomString(&rnd, 100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(1);
+  ASSERT_OK(Put(Key(1), "v"));
+  ASSERT_OK(Flush());
+
+  ASSERT_OK(dbfull()->SetOptions({{"disable_auto_compactions", "false"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  ASSERT_GT(table_factory->num_urgent.load(), 0);
+  ASSERT_EQ(3, TestGetTickerCount(options, COMPACTION_BUILD_DEFERRED));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_EQ(0, NumTableFilesAtLevel(1));
+  ASSERT_EQ("v", Get(Key(1)));
+}
+
 TEST_F(DBCompactionTest, CompactFilesOutputRangeConflict) {
   // LSM setup:
   // L1:      [ba bz]
@@ -4173,6 +4259,105 @@ TEST_F(DBCompactionTest, PartialManualCompaction) {
   dbfull()->CompactRange(cro, nullptr, nullptr);
 }
 
+TEST_F(DBCompactionTest, TemperatureAwarePlacement) {
+  Options options = CurrentOptions();
+  options.enable_lazy_compaction = false;
+  options.temperature_aware_placement = true;
+  options.num_levels = 3;
+  options.compression = kNoCompression;
+  // Room for one of the two level-2 files only
+  options.db_paths.emplace_back(dbname_ + "_hot", 16 << 10);
+  options.db_paths.emplace_back(dbname_ + "_cold", 1 << 30);
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (char prefix : {'a', 'b'}) {
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_OK(Put(prefix + Key(i), RandomString(&rnd, 100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(2);
+  ASSERT_EQ("0,0,2", FilesPerLevel());
+  ASSERT_EQ(2, GetSstFileCount(options.db_paths[0].path));
+
+  // Only the 'a' file is read
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      Get('a' + Key(i));
+    }
+  }
+  // A new version reevaluates the placement
+  ASSERT_OK(Put("c", "v"));
+  ASSERT_OK(Flush());
+  dbfull()->TEST_WaitForCompact();
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  for (auto& file : files) {
+    if (file.level != 2) {
+      continue;
+    }
+    if (file.smallestkey[0] == 'a') {
+      ASSERT_EQ(options.db_paths[0].path, file.db_path);
+    } else {
+      ASSERT_EQ(options.db_paths[1].path, file.db_path);
+    }
+  }
+  ASSERT_EQ(1, GetSstFileCount(options.db_paths[1].path));
+
+  // The old copy goes away once no version refers to it
+  Reopen(options);
+  ASSERT_EQ(2, GetSstFileCount(options.db_paths[0].path));
+  ASSERT_EQ(1, GetSstFileCount(options.db_paths[1].path));
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_NE("NOT_FOUND", Get('b' + Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, TemperatureMigrationNotDeferredByTableFactory) {
+  // Refuses every compaction that isn't urgent
+  class RefusingTableFactory : public BlockBasedTableFactory {
+   public:
+    bool AdmitBuild(uint64_t /*table_size*/, int /*output_level*/,
+                    bool urgent) const override {
+      return urgent;
+    }
+  };
+
+  Options options = CurrentOptions();
+  options.table_factory = std::make_shared<RefusingTableFactory>();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.enable_lazy_compaction = false;
+  options.temperature_aware_placement = true;
+  options.num_levels = 3;
+  options.compression = kNoCompression;
+  options.db_paths.emplace_back(dbname_ + "_hot", 16 << 10);
+  options.db_paths.emplace_back(dbname_ + "_cold", 1 << 30);
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (char prefix : {'a', 'b'}) {
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_OK(Put(prefix + Key(i), RandomString(&rnd, 100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(2);
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      Get('a' + Key(i));
+    }
+  }
+  ASSERT_OK(Put("c", "v"));
+  ASSERT_OK(Flush());
+  dbfull()->TEST_WaitForCompact();
+
+  // The 'b' file still moves to the cold path
+  ASSERT_EQ(1, GetSstFileCount(options.db_paths[1].path));
+  ASSERT_EQ(0, TestGetTickerCount(options, COMPACTION_BUILD_DEFERRED));
+}
+
 TEST_F(DBCompactionTest, ManualCompactionFailsInReadOnlyMode) {
   // Regression test for bug where manual compaction hangs forever when the DB
   // is in read-only mode. Verify it now at least returns, despite failing.
@@ -22,6 +22,7 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -89,6 +90,7 @@
 #include "util/file_reader_writer.h"
 #include "util/file_util.h"
 #include "util/filename.h"
+#include "util/io_heatmap.h"
 #include "util/log_buffer.h"
 #include "util/logging.h"
 #include "util/mutexlock.h"
@@ -223,6 +225,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
           static_cast<int64_t>(mutable_db_options_.delayed_write_rate / 8),
           kDefaultLowPriThrottledRate))),
       last_batch_group_size_(0),
+      newest_snapshot_seq_(0),
+      fold_merge_seq_(0),
+      fold_merge_blockers_(0),
       unscheduled_flushes_(0),
       unscheduled_compactions_(0),
       unscheduled_garbage_collections_(0),
@@ -285,6 +290,14 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
               ? std::make_shared<ByteDanceMetricsReporterFactory>()
               : options.metrics_reporter_factory),
       console_runner_(this, dbname, env_, immutable_db_options_.info_log.get()),
+      compaction_throttler_(
+          immutable_db_options_,
+          metrics_reporter_factory_->BuildHistReporter(
+              read_latency_metric_name, bytedance_tags_,
+              immutable_db_options_.info_log.get()),
+          metrics_reporter_factory_->BuildHistReporter(
+              write_latency_metric_name, bytedance_tags_,
+              immutable_db_options_.info_log.get())),
 
       write_qps_reporter_(*metrics_reporter_factory_->BuildCountReporter(
           write_qps_metric_name, bytedance_tags_,
@@ -308,12 +321,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
           prev_qps_metric_name, bytedance_tags_,
           immutable_db_options_.info_log.get())),
 
-      write_latency_reporter_(*metrics_reporter_factory_->BuildHistReporter(
-          write_latency_metric_name, bytedance_tags_,
-          immutable_db_options_.info_log.get())),
-      read_latency_reporter_(*metrics_reporter_factory_->BuildHistReporter(
-          read_latency_metric_name, bytedance_tags_,
-          immutable_db_options_.info_log.get())),
+      write_latency_reporter_(compaction_throttler_.write_reporter()),
+      read_latency_reporter_(compaction_throttler_.read_reporter()),
       newiterator_latency_reporter_(
           *metrics_reporter_factory_->BuildHistReporter(
               newiterator_latency_metric_name, bytedance_tags_,
@@ -337,6 +346,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   // !batch_per_trx_ implies seq_per_batch_ because it is only unset for
   // WriteUnprepared, which should use seq_per_batch_.
   assert(batch_per_txn_ || seq_per_batch_);
+  // compaction_throttler_ is constructed after env_options_for_compaction_
+  env_options_for_compaction_.rate_limiter =
+      compaction_throttler_.compaction_rate_limiter();
   env_->GetAbsolutePath(dbname, &db_absolute_path_);
 
   // Reserve ten files or so for other uses and give the rest to TableCache.
@@ -511,6 +523,13 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
     mutex_.Lock();
     thread_dump_stats_.reset();
   }
+  if (thread_throttle_compaction_ != nullptr) {
+    mutex_.Unlock();
+    thread_throttle_compaction_->cancel();
+    mutex_.Lock();
+    thread_throttle_compaction_.reset();
+    compaction_throttler_.Reset();
+  }
   if (!shutting_down_.load(std::memory_order_acquire) &&
       has_unpersisted_data_.load(std::memory_order_relaxed) &&
       !mutable_db_options_.avoid_flush_during_shutdown) {
@@ -560,6 +579,18 @@ Status DBImpl::CloseHelper() {
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
 
+  if (table_warm_up_thread_.joinable()) {
+    table_warm_up_thread_.join();
+  }
+  if (opened_successfully_ && immutable_db_options_.persist_table_warm_state) {
+    Status s = WriteTableWarmState();
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Failed to write table warm state: %s",
+                     s.ToString().c_str());
+    }
+  }
+
   Status ret;
   mutex_.Lock();
   int bg_unscheduled = env_->UnSchedule(this, Env::Priority::BOTTOM);
@@ -770,6 +801,21 @@ void DBImpl::StartTimedTasks() {
             stats_dump_period_sec * 1000000));
       }
     }
+    if (compaction_throttler_.enabled() && !thread_throttle_compaction_) {
+      thread_throttle_compaction_.reset(new rocksdb::RepeatableThread(
+          [this]() { DBImpl::TuneCompactionThrottle(); }, "tune_cp", env_,
+          CompactionThrottler::kTunePeriodMicros,
+          CompactionThrottler::kTunePeriodMicros));
+    }
+  }
+}
+
+void DBImpl::TuneCompactionThrottle() {
+  if (compaction_throttler_.Tune()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Compaction throttle ratio changed to %.2f by foreground "
+                   "latency",
+                   compaction_throttler_.ratio());
   }
 }
 
@@ -1012,6 +1058,8 @@ Status DBImpl::SetDBOptions(
           env_options_for_compaction_, immutable_db_options_);
       env_options_for_compaction_.compaction_readahead_size =
           mutable_db_options_.compaction_readahead_size;
+      env_options_for_compaction_.rate_limiter =
+          compaction_throttler_.compaction_rate_limiter();
       WriteThread::Writer w;
       write_thread_.EnterUnbatched(&w, &mutex_);
       if (alive_log_files_.back().size > GetMaxWalSize() ||
@@ -1486,6 +1534,9 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
   // Prepare to store a list of merge operations if merge occurs.
   MergeContext merge_context;
   SequenceNumber max_covering_tombstone_seq = 0;
+  if (callback == nullptr) {
+    cfd->SetMergeResultCache(read_options, &merge_context);
+  }
 
   Status s;
   // First look in the memtable, then in the immutable memtable (if any).
@@ -1643,6 +1694,15 @@ std::vector<Status> DBImpl::MultiGet(
   StopWatch sw(env_, stats_, DB_MULTIGET);
   PERF_TIMER_GUARD(get_snapshot_time);
 
+  if (tracer_) {
+    // TODO: This mutex should be removed later, to improve performance when
+    // tracing is enabled.
+    InstrumentedMutexLock lock(&trace_mutex_);
+    if (tracer_) {
+      tracer_->MultiGet(column_family, keys);
+    }
+  }
+
   SequenceNumber snapshot;
 
   struct MultiGetColumnFamilyData {
@@ -1705,6 +1765,7 @@ std::vector<Status> DBImpl::MultiGet(
     assert(mgd_iter != multiget_cf_data.end());
     auto mgd = mgd_iter->second;
     auto super_version = mgd->super_version;
+    mgd->cfd->SetMergeResultCache(read_options, &merge_context);
     bool skip_memtable =
         (read_options.read_tier == kPersistedTier &&
          has_unpersisted_data_.load(std::memory_order_relaxed));
@@ -2272,21 +2333,53 @@ const Snapshot* DBImpl::GetSnapshotForWriteConflictBoundary() {
 }
 #endif  // ROCKSDB_LITE
 
+SequenceNumber DBImpl::BeginFoldMerge(SequenceNumber seq) {
+  SequenceNumber fold_seq = fold_merge_seq_.load(std::memory_order_relaxed);
+  while (fold_seq < seq &&
+         !fold_merge_seq_.compare_exchange_weak(fold_seq, seq)) {
+  }
+  // Pairs with GetSnapshotImpl: either it sees seq in fold_merge_seq_ and
+  // waits for it, or we see it in fold_merge_blockers_ and do not fold
+  if (fold_merge_blockers_.load() != 0) {
+    return kMaxSequenceNumber;
+  }
+  return newest_snapshot_seq_.load();
+}
+
 SnapshotImpl* DBImpl::GetSnapshotImpl(bool is_write_conflict_boundary) {
   int64_t unix_time = 0;
   env_->GetCurrentTime(&unix_time);  // Ignore error
   SnapshotImpl* s = new SnapshotImpl;
 
+  // A write that folded a merge operand changes the operand in place. The
+  // snapshot must not see it until the write is published, so wait for
+  // the writes that may have folded and keep new ones from folding.
+  fold_merge_blockers_.fetch_add(1);
+  SequenceNumber fold_seq = fold_merge_seq_.load();
+
   InstrumentedMutexLock l(&mutex_);
+  while ((last_seq_same_as_publish_seq_
+              ? versions_->LastSequence()
+              : versions_->LastPublishedSequence()) < fold_seq &&
+         error_handler_.GetBGError().ok()) {
+    // The write group may need mutex_ before it publishes its sequence
+    mutex_.Unlock();
+    std::this_thread::yield();
+    mutex_.Lock();
+  }
   // returns null if the underlying memtable does not support snapshot.
   if (!is_snapshot_supported_) {
+    fold_merge_blockers_.fetch_sub(1);
     delete s;
     return nullptr;
   }
   auto snapshot_seq = last_seq_same_as_publish_seq_
                           ? versions_->LastSequence()
                           : versions_->LastPublishedSequence();
-  return snapshots_.New(s, snapshot_seq, unix_time, is_write_conflict_boundary);
+  snapshots_.New(s, snapshot_seq, unix_time, is_write_conflict_boundary);
+  newest_snapshot_seq_.store(snapshots_.GetNewest());
+  fold_merge_blockers_.fetch_sub(1);
+  return s;
 }
 
 void DBImpl::ReleaseSnapshot(const Snapshot* s) {
@@ -2294,6 +2387,8 @@ void DBImpl::ReleaseSnapshot(const Snapshot* s) {
   {
     InstrumentedMutexLock l(&mutex_);
     snapshots_.Delete(casted_s);
+    newest_snapshot_seq_.store(snapshots_.GetNewest(),
+                               std::memory_order_release);
     uint64_t oldest_snapshot;
     if (snapshots_.empty()) {
       oldest_snapshot = last_seq_same_as_publish_seq_
@@ -2482,6 +2577,68 @@ bool DBImpl::GetPropertyHandleOptionsStatistics(std::string* value) {
   return true;
 }
 
+// The heatmap properties only hold the DB mutex while collecting the file
+// levels, the samples are copied from the lock-free ring and aggregated
+// outside of it.
+bool DBImpl::GetPropertyHandleIOHeatmap(std::string* value) {
+  IOHeatmap* heatmap = immutable_db_options_.io_heatmap.get();
+  if (heatmap == nullptr) {
+    return false;
+  }
+  std::unordered_map<uint64_t, int> file_levels;
+  GetIOHeatmapFileLevels(&file_levels);
+  *value = heatmap->ToString(
+      [&file_levels](uint64_t file_number, int* level) {
+        auto find = file_levels.find(file_number);
+        if (find == file_levels.end()) {
+          return false;
+        }
+        *level = find->second;
+        return true;
+      },
+      20 /* top_blocks */);
+  return true;
+}
+
+bool DBImpl::GetPropertyHandleIOHeatmapSamples(std::string* value) {
+  IOHeatmap* heatmap = immutable_db_options_.io_heatmap.get();
+  if (heatmap == nullptr) {
+    return false;
+  }
+  std::unordered_map<uint64_t, int> file_levels;
+  GetIOHeatmapFileLevels(&file_levels);
+  *value = heatmap->ToCSV([&file_levels](uint64_t file_number, int* level) {
+    auto find = file_levels.find(file_number);
+    if (find == file_levels.end()) {
+      return false;
+    }
+    *level = find->second;
+    return true;
+  });
+  return true;
+}
+
+void DBImpl::GetIOHeatmapFileLevels(
+    std::unordered_map<uint64_t, int>* file_levels) {
+  InstrumentedMutexLock l(&mutex_);
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    const auto* vstorage = cfd->current()->storage_info();
+    for (auto f : vstorage->LevelFiles(-1)) {
+      int level = f->is_gc_forbidden() ? IOHeatmap::kDependenceLevel
+                                       : IOHeatmap::kBlobLevel;
+      file_levels->emplace(f->fd.GetNumber(), level);
+    }
+    for (int level = 0; level < vstorage->num_levels(); ++level) {
+      for (auto f : vstorage->LevelFiles(level)) {
+        file_levels->emplace(f->fd.GetNumber(), level);
+      }
+    }
+  }
+}
+
 #ifndef ROCKSDB_LITE
 Status DBImpl::ResetStats() {
   InstrumentedMutexLock l(&mutex_);
@@ -21,6 +21,7 @@
 
 #include "db/column_family.h"
 #include "db/compaction_job.h"
+#include "db/compaction_throttler.h"
 #include "db/dbformat.h"
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
@@ -470,6 +471,11 @@ class DBImpl : public DB {
   int TEST_BGFlushesAllowed() const;
   size_t TEST_GetWalPreallocateBlockSize(uint64_t write_buffer_size) const;
   void TEST_WaitForTimedTaskRun(std::function<void()> callback) const;
+  // Tunes the compaction throttler now and returns its ratio
+  double TEST_TuneCompactionThrottle();
+  // Bytes per second compaction output is throttled to
+  int64_t TEST_ThrottledCompactionBytesPerSecond() const;
+  int TEST_GetSubCompactionSlots(uint32_t max_subcompactions);
 
 #endif  // NDEBUG
 
@@ -526,6 +532,14 @@ class DBImpl : public DB {
 
   const SnapshotList& snapshots() const { return snapshots_; }
 
+  // Called from the write path, without mutex_, before the write with
+  // sequence number seq folds merge operands (see fold_merge_operands).
+  // Returns the sequence number at or below which operands must not be
+  // folded: the newest live snapshot, or kMaxSequenceNumber while a snapshot
+  // is being taken. A snapshot taken after this call waits until seq is
+  // published, so no snapshot ends up between a folded operand and seq.
+  SequenceNumber BeginFoldMerge(SequenceNumber seq);
+
   const ImmutableDBOptions& immutable_db_options() const {
     return immutable_db_options_;
   }
@@ -1138,6 +1152,11 @@ class DBImpl : public DB {
   Status BackgroundFlush(bool* madeProgress, JobContext* job_context,
                          LogBuffer* log_buffer, FlushReason* reason);
 
+  // Moves the input files of a temperature migration to its output path and
+  // installs them there. Releases the mutex while the files are copied.
+  // REQUIRES: mutex held
+  Status MigrateCompactionFiles(Compaction* c, LogBuffer* log_buffer);
+
   bool EnoughRoomForCompaction(ColumnFamilyData* cfd,
                                const std::vector<CompactionInputFiles>& inputs,
                                bool* sfm_bookkeeping, LogBuffer* log_buffer);
@@ -1150,6 +1169,9 @@ class DBImpl : public DB {
   // dump rocksdb.stats to LOG
   void DumpStats();
 
+  // Feeds the latency windows of the last period to compaction_throttler_
+  void TuneCompactionThrottle();
+
   // Return the minimum empty level that could hold the total data in the
   // input level. Return the input level, if such level could not be found.
   int FindMinimumEmptyLevelFitting(ColumnFamilyData* cfd,
@@ -1182,6 +1204,15 @@ class DBImpl : public DB {
 
   Status CloseHelper();
 
+  // Opens the table readers DB::Open left closed because of
+  // DBOptions::persist_table_warm_state, hottest files first.
+  // Runs in table_warm_up_thread_.
+  void WarmUpTables();
+
+  // Records the sampled reads of each live SST into TABLE_WARM_STATE so the
+  // next WarmUpTables knows which files to open first.
+  Status WriteTableWarmState();
+
   void WaitForBackgroundWork();
 
   // table_cache_ provides its own synchronization
@@ -1369,6 +1400,14 @@ class DBImpl : public DB {
 
   SnapshotList snapshots_;
 
+  // snapshots_.GetNewest(), readable without mutex_ from the write path
+  std::atomic<SequenceNumber> newest_snapshot_seq_;
+  // Largest sequence number of a write that may have folded merge operands
+  std::atomic<SequenceNumber> fold_merge_seq_;
+  // Number of GetSnapshot calls waiting for fold_merge_seq_ to be published.
+  // No write starts folding while it is not 0.
+  std::atomic<int> fold_merge_blockers_;
+
   // For each background job, pending_outputs_ keeps the current file number at
   // the time that background job started.
   // FindObsoleteFiles()/PurgeObsoleteFiles() never deletes any file that has
@@ -1430,6 +1469,11 @@ class DBImpl : public DB {
   // `purge_queue_` and `files_grabbed_for_purge_`
   std::list<std::vector<uint64_t>*> candidate_file_listener_;
 
+  // Numbers of the files a temperature migration is copying to another path.
+  // Full scans skip them until the version that refers to the copies is
+  // installed, as only the old path is live before that.
+  std::vector<uint64_t> files_being_migrated_;
+
   // A queue to store superversions to delete
   std::deque<SuperVersion*> superversion_to_free_queue_;
 
@@ -1542,6 +1586,9 @@ class DBImpl : public DB {
   static const int KEEP_LOG_FILE_NUM = 1000;
   // MSVC version 1800 still does not have constexpr for ::max()
   static const uint64_t kNoTimeOut = port::kMaxUint64;
+  // How long a compaction the table factory didn't admit stays off its
+  // thread before it is picked again
+  static const uint64_t kBuildDeferredRetryMicros = 100000;
 
   std::string db_absolute_path_;
 
@@ -1588,6 +1635,12 @@ class DBImpl : public DB {
   // REQUIRES: mutex locked
   std::unique_ptr<rocksdb::RepeatableThread> thread_dump_stats_;
 
+  // Runs TuneCompactionThrottle() if the compaction throttler is enabled
+  std::unique_ptr<rocksdb::RepeatableThread> thread_throttle_compaction_;
+
+  // Opens table readers after DB::Open returns, joined by CloseHelper
+  port::Thread table_warm_up_thread_;
+
   // No copying allowed
   DBImpl(const DBImpl&);
   void operator=(const DBImpl&);
@@ -1619,6 +1672,12 @@ class DBImpl : public DB {
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
   bool GetPropertyHandleOptionsStatistics(std::string* value);
+  bool GetPropertyHandleIOHeatmap(std::string* value);
+  bool GetPropertyHandleIOHeatmapSamples(std::string* value);
+  // Level of every file of the current versions of all column families,
+  // level -1 files are mapped to IOHeatmap::kBlobLevel or
+  // IOHeatmap::kDependenceLevel by their gc_status
+  void GetIOHeatmapFileLevels(std::unordered_map<uint64_t, int>* file_levels);
 
   bool HasPendingManualCompaction();
   bool HasExclusiveManualCompaction();
@@ -1694,6 +1753,10 @@ class DBImpl : public DB {
   std::shared_ptr<MetricsReporterFactory> metrics_reporter_factory_;
   cheapis::ServerRunner console_runner_;
 
+  // Wraps the factory's write and read latency reporters, so it must be
+  // constructed before them
+  CompactionThrottler compaction_throttler_;
+
   QPSReporter write_qps_reporter_;
   QPSReporter read_qps_reporter_;
   QPSReporter newiterator_qps_reporter_;
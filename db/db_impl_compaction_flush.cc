@@ -17,15 +17,117 @@
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
 #include "db/map_builder.h"
+#include "db/table_cache.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_updater.h"
 #include "monitoring/thread_status_util.h"
+#include "util/file_util.h"
 #include "util/sst_file_manager_impl.h"
 #include "util/sync_point.h"
 
 namespace rocksdb {
 
+Status DBImpl::MigrateCompactionFiles(Compaction* c, LogBuffer* log_buffer) {
+  mutex_.AssertHeld();
+  auto cfd = c->column_family_data();
+  const auto& cf_paths = cfd->ioptions()->cf_paths;
+  const uint32_t path_id = c->output_path_id();
+  assert(path_id < cf_paths.size());
+
+  // Input files can't go away while they are being compacted, so they are
+  // copied without holding the mutex. The copies share the file numbers of
+  // the originals, which are deleted once no version refers to them.
+  std::vector<uint64_t> file_numbers;
+  for (auto& input : *c->inputs()) {
+    for (auto f : input.files) {
+      file_numbers.push_back(f->fd.GetNumber());
+    }
+  }
+  files_being_migrated_.insert(files_being_migrated_.end(),
+                               file_numbers.begin(), file_numbers.end());
+  for (auto listener : candidate_file_listener_) {
+    listener->insert(listener->end(), file_numbers.begin(),
+                     file_numbers.end());
+  }
+  auto migration_done = [&] {
+    for (auto number : file_numbers) {
+      files_being_migrated_.erase(std::find(files_being_migrated_.begin(),
+                                            files_being_migrated_.end(),
+                                            number));
+    }
+  };
+
+  std::vector<std::string> new_files;
+  Status s;
+  mutex_.Unlock();
+  for (auto& input : *c->inputs()) {
+    for (auto f : input.files) {
+      std::string src =
+          TableFileName(cf_paths, f->fd.GetNumber(), f->fd.GetPathId());
+      std::string dst = TableFileName(cf_paths, f->fd.GetNumber(), path_id);
+      // A hard link only touches metadata when both paths share a file system
+      s = env_->LinkFile(src, dst);
+      if (!s.ok()) {
+        s = CopyFile(env_, src, dst, 0, immutable_db_options_.use_fsync);
+      }
+      if (!s.ok()) {
+        break;
+      }
+      new_files.push_back(dst);
+    }
+    if (!s.ok()) {
+      break;
+    }
+  }
+  Directory* dir = GetDataDir(cfd, path_id);
+  if (s.ok() && dir != nullptr) {
+    s = dir->Fsync();
+  }
+  mutex_.Lock();
+
+  if (!s.ok()) {
+    // Nothing refers to the copies yet
+    for (auto& fname : new_files) {
+      env_->DeleteFile(fname);
+    }
+    migration_done();
+    return s;
+  }
+
+  uint64_t moved_bytes = 0;
+  for (auto& input : *c->inputs()) {
+    for (auto f : input.files) {
+      FileMetaData moved;
+      moved.fd = FileDescriptor(f->fd.GetNumber(), path_id, f->fd.GetFileSize(),
+                                f->fd.smallest_seqno, f->fd.largest_seqno);
+      moved.smallest = f->smallest;
+      moved.largest = f->largest;
+      moved.marked_for_compaction = f->marked_for_compaction;
+      moved.prop = f->prop;
+      moved.stats = f->stats;
+      if (input.level >= 0) {
+        c->edit()->DeleteFile(input.level, f->fd.GetNumber());
+      }
+      c->edit()->AddFile(input.level, moved);
+      c->AddOutputTableFileNumber(f->fd.GetNumber());
+      // Readers opened on the old path would keep its space in use, let the
+      // new version open the copy instead.
+      TableCache::Evict(table_cache_.get(), f->fd.GetNumber());
+      moved_bytes += f->fd.GetFileSize();
+    }
+  }
+  s = versions_->LogAndApply(cfd, *c->mutable_cf_options(), c->edit(), &mutex_,
+                             directories_.GetDbDir());
+  migration_done();
+  ROCKS_LOG_BUFFER(log_buffer,
+                   "[%s] Migrated %" ROCKSDB_PRIszt
+                   " files to path %" PRIu32 " %" PRIu64 " bytes: %s\n",
+                   cfd->GetName().c_str(), new_files.size(), path_id,
+                   moved_bytes, s.ToString().c_str());
+  return s;
+}
+
 bool DBImpl::EnoughRoomForCompaction(
     ColumnFamilyData* cfd, const std::vector<CompactionInputFiles>& inputs,
     bool* sfm_reserved_compact_space, LogBuffer* log_buffer) {
@@ -1930,7 +2032,10 @@ int DBImpl::GetSubCompactionSlots(uint32_t max_subcompactions) {
                      true /* parallelize_compactions */);
   int slots = bg_job_limits.max_compactions - bg_compaction_scheduled_ - 1;
   // max_subcompactions == 0 ? slots : min(max_subcompactions - 1, slots)
-  return (int)std::min(max_subcompactions - 1, uint32_t(std::max(0, slots)));
+  uint32_t extra =
+      std::min(max_subcompactions - 1, uint32_t(std::max(0, slots)));
+  // Foreground latency may throttle the number of subcompactions down
+  return (int)compaction_throttler_.ThrottleSubcompactions(extra + 1) - 1;
 }
 
 void DBImpl::AddToCompactionQueue(ColumnFamilyData* cfd) {
@@ -2299,7 +2404,14 @@ void DBImpl::BackgroundCallCompaction(PrepickedCompaction* prepicked_compaction,
     Status s = BackgroundCompaction(&made_progress, &job_context, &log_buffer,
                                     prepicked_compaction);
     TEST_SYNC_POINT("BackgroundCallCompaction:1");
-    if (!s.ok() && !s.IsShutdownInProgress()) {
+    if (s.IsBusy() && s.subcode() == Status::kBuildDeferred) {
+      // The compaction was deferred, wait a little bit before it's picked
+      // again
+      bg_cv_.SignalAll();
+      mutex_.Unlock();
+      env_->SleepForMicroseconds(kBuildDeferredRetryMicros);
+      mutex_.Lock();
+    } else if (!s.ok() && !s.IsShutdownInProgress()) {
       // Wait a little bit before retrying background compaction in
       // case this is an environmental problem and we do not want to
       // chew up resources for failed compactions for the duration of
@@ -2611,6 +2723,33 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
                                   log_buffer));
       TEST_SYNC_POINT("DBImpl::BackgroundCompaction():AfterPickCompaction");
 
+      // Map compactions only write a small index over their inputs and
+      // temperature migrations move files without building tables, neither
+      // needs build memory
+      if (c != nullptr && !c->deletion_compaction() && !c->IsTrivialMove() &&
+          c->compaction_type() != kMapCompaction &&
+          c->compaction_reason() != CompactionReason::kTemperatureMigration &&
+          !c->immutable_cf_options()->table_factory->AdmitBuild(
+              std::min(c->CalculateTotalInputSize(),
+                       c->max_output_file_size()),
+              c->output_level(), c->start_level() == 0)) {
+        // The table builders would only sit waiting for working memory, put
+        // the compaction back and retry later
+        TEST_SYNC_POINT("DBImpl::BackgroundCompaction():BuildDeferred");
+        RecordTick(stats_, COMPACTION_BUILD_DEFERRED);
+        c->ReleaseCompactionFiles(status);
+        c->column_family_data()
+            ->current()
+            ->storage_info()
+            ->ComputeCompactionScore(*(c->immutable_cf_options()),
+                                     *(c->mutable_cf_options()));
+        AddToCompactionQueue(cfd);
+        ++unscheduled_compactions_;
+
+        c.reset();
+        // BackgroundCallCompaction waits a little bit before retrying
+        status = Status::Busy(Status::kBuildDeferred);
+      }
       if (c != nullptr) {
         bool enough_room = EnoughRoomForCompaction(
             cfd, *(c->inputs()), &sfm_reserved_compact_space, log_buffer);
@@ -2686,6 +2825,21 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
                      c->column_family_data()->GetName().c_str(),
                      c->num_input_files(0));
     *made_progress = true;
+  } else if (c->compaction_reason() ==
+             CompactionReason::kTemperatureMigration) {
+    TEST_SYNC_POINT("DBImpl::BackgroundCompaction:TemperatureMigration");
+    compaction_job_stats.num_input_files = c->num_input_files(0);
+
+    NotifyOnCompactionBegin(c->column_family_data(), c.get(), status,
+                            compaction_job_stats, job_context->job_id);
+
+    status = MigrateCompactionFiles(c.get(), log_buffer);
+    if (status.ok()) {
+      InstallSuperVersionAndScheduleWork(
+          c->column_family_data(), &job_context->superversion_contexts[0],
+          *c->mutable_cf_options(), FlushReason::kAutoCompaction);
+    }
+    *made_progress = true;
   } else if (!trivial_move_disallowed && c->IsTrivialMove()) {
     TEST_SYNC_POINT("DBImpl::BackgroundCompaction:TrivialMove");
     // Instrument for event update
@@ -2837,7 +2991,8 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
                                 compaction_job_stats, job_context->job_id);
   }
 
-  if (status.ok() || status.IsCompactionTooLarge()) {
+  if (status.ok() || status.IsCompactionTooLarge() ||
+      (status.IsBusy() && status.subcode() == Status::kBuildDeferred)) {
     // Done
   } else if (status.IsShutdownInProgress()) {
     // Ignore compaction errors found during shutting down
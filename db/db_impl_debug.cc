@@ -255,5 +255,19 @@ void DBImpl::TEST_WaitForTimedTaskRun(std::function<void()> callback) const {
     thread_dump_stats_->TEST_WaitForRun(callback);
   }
 }
+
+double DBImpl::TEST_TuneCompactionThrottle() {
+  TuneCompactionThrottle();
+  return compaction_throttler_.ratio();
+}
+
+int64_t DBImpl::TEST_ThrottledCompactionBytesPerSecond() const {
+  return compaction_throttler_.throttled_bytes_per_sec();
+}
+
+int DBImpl::TEST_GetSubCompactionSlots(uint32_t max_subcompactions) {
+  InstrumentedMutexLock l(&mutex_);
+  return GetSubCompactionSlots(max_subcompactions);
+}
 }  // namespace rocksdb
 #endif  // NDEBUG
@@ -131,6 +131,9 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
     for (const auto& purge_file_info : purge_queue_) {
       job_context->skip_candidate_files.emplace_back(purge_file_info.number);
     }
+    job_context->skip_candidate_files.insert(
+        job_context->skip_candidate_files.end(), files_being_migrated_.begin(),
+        files_being_migrated_.end());
     candidate_file_listener_.emplace_front(&job_context->skip_candidate_files);
     auto candidate_file_listener_it = candidate_file_listener_.begin();
 
@@ -353,12 +356,30 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
 
   // Now, convert live list to an unordered map, WITHOUT mutex held;
   // set is slow.
-  std::unordered_set<uint64_t> sst_live;
+  // A temperature migration moves a file to another path under the same
+  // number, so for those column families a live file also records its path
+  // and the copy left in the old path is deleted once no version refers to
+  // it. nullptr means the file is kept in every path.
+  std::unordered_map<uint64_t, const std::string*> sst_live;
   for (auto v : state.version_ref) {
     auto vstorage = v->storage_info();
+    auto ioptions = v->cfd()->ioptions();
+    bool track_path = ioptions->temperature_aware_placement;
     for (int i = -1; i < vstorage->num_levels(); ++i) {
       for (auto f : vstorage->LevelFiles(i)) {
-        sst_live.emplace(f->fd.GetNumber());
+        const std::string* path = nullptr;
+        if (track_path) {
+          path = &ioptions->cf_paths[std::min<size_t>(
+                                         f->fd.GetPathId(),
+                                         ioptions->cf_paths.size() - 1)]
+                      .path;
+        }
+        auto ib = sst_live.emplace(f->fd.GetNumber(), path);
+        if (!ib.second && ib.first->second != path &&
+            (ib.first->second == nullptr || path == nullptr ||
+             *ib.first->second != *path)) {
+          ib.first->second = nullptr;
+        }
       }
     }
   }
@@ -467,12 +488,16 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
         // (can happen during manifest roll)
         keep = (number >= state.manifest_file_number);
         break;
-      case kTableFile:
+      case kTableFile: {
         // If the second condition is not there, this makes
         // DontDeletePendingOutputs fail
-        keep = (sst_live.find(number) != sst_live.end()) ||
+        auto find = sst_live.find(number);
+        keep = (find != sst_live.end() &&
+                (find->second == nullptr ||
+                 *find->second == *candidate_file.file_path)) ||
                number >= state.min_pending_output;
         break;
+      }
       case kTempFile:
         // Any temp files that are currently being written to must
         // be recorded in pending_outputs_, which is inserted into "live".
@@ -506,6 +531,7 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
       case kDBLockFile:
       case kIdentityFile:
       case kMetaDatabase:
+      case kTableWarmStateFile:
         keep = true;
         break;
     }
@@ -12,16 +12,24 @@
 #define __STDC_FORMAT_MACROS
 #endif
 #include <inttypes.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "db/builder.h"
 #include "db/error_handler.h"
 #include "db/map_builder.h"
+#include "db/table_cache.h"
 #include "options/options_helper.h"
 #include "rocksdb/wal_filter.h"
 #include "table/block_based_table_factory.h"
 #include "util/c_style_callback.h"
 #include "util/rate_limiter.h"
 #include "util/sst_file_manager_impl.h"
+#include "util/string_util.h"
 #include "util/sync_point.h"
 #if !defined(_MSC_VER) && !defined(__APPLE__)
 #include <sys/unistd.h>
@@ -69,6 +77,11 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
                                            Env::Priority::LOW);
   result.env->IncBackgroundThreadsIfNeeded(bg_job_limits.max_flushes,
                                            Env::Priority::HIGH);
+  if (result.numa_aware) {
+    result.env->BindThreadPoolToNumaNodes(Env::Priority::LOW);
+    result.env->BindThreadPoolToNumaNodes(Env::Priority::HIGH);
+    result.env->BindThreadPoolToNumaNodes(Env::Priority::BOTTOM);
+  }
 
   if (result.rate_limiter.get() != nullptr) {
     if (result.bytes_per_sync == 0) {
@@ -537,6 +550,99 @@ Status DBImpl::Recover(
   return s;
 }
 
+namespace {
+// Reads, reassembles and checksums WAL records on its own thread, so that
+// recovery only spends its time inserting them into memtables. The inserts
+// themselves are still applied serially by the recovering thread.
+class LogRecordPrefetcher {
+ public:
+  // `read_status` is the status the reporter of `reader` writes to, or
+  // nullptr when corruptions are ignored
+  LogRecordPrefetcher(log::Reader* reader, WALRecoveryMode recovery_mode,
+                      const Status* read_status)
+      : reader_(reader),
+        recovery_mode_(recovery_mode),
+        read_status_(read_status),
+        buffered_bytes_(0),
+        stop_(false),
+        done_(false),
+        finished_(false) {
+    thread_ = port::Thread([this] { Run(); });
+  }
+
+  ~LogRecordPrefetcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  // Returns false once the log has no more records, or its reporter has seen
+  // a corruption it does not tolerate.
+  bool Next(std::string* record) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !records_.empty() || done_; });
+    if (records_.empty()) {
+      finished_ = true;
+      return false;
+    }
+    *record = std::move(records_.front());
+    records_.pop_front();
+    buffered_bytes_ -= record->size();
+    cv_.notify_all();
+    return true;
+  }
+
+  // Whether Next consumed every record the reader returned
+  bool finished() const { return finished_; }
+
+ private:
+  // Bounds the memory held by records read ahead of recovery
+  static const size_t kMaxBufferedBytes = 64 << 20;
+
+  void Run() {
+    Slice record;
+    std::string scratch;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] {
+          return stop_ || buffered_bytes_ < kMaxBufferedBytes;
+        });
+        if (stop_) {
+          break;
+        }
+      }
+      if (!reader_->ReadRecord(&record, &scratch, recovery_mode_) ||
+          (read_status_ != nullptr && !read_status_->ok())) {
+        break;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      records_.emplace_back(record.data(), record.size());
+      buffered_bytes_ += record.size();
+      cv_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    cv_.notify_all();
+  }
+
+  log::Reader* reader_;
+  WALRecoveryMode recovery_mode_;
+  const Status* read_status_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::string> records_;
+  size_t buffered_bytes_;
+  bool stop_;
+  bool done_;
+  bool finished_;
+  port::Thread thread_;
+};
+}  // namespace
+
 // REQUIRES: log_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
                                SequenceNumber* next_sequence, bool read_only) {
@@ -657,24 +763,32 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
     } else {
       reporter.status = &status;
     }
+    // The reader runs on the prefetch thread and reports into its own status,
+    // which joins `status` once every record read before the corruption has
+    // been replayed
+    Status read_status;
+    LogReporter read_reporter = reporter;
+    if (reporter.status != nullptr) {
+      read_reporter.status = &read_status;
+    }
     // We intentially make log::Reader do checksumming even if
     // paranoid_checks==false so that corruptions cause entire commits
     // to be skipped instead of propagating bad information (like overly
     // large sequence numbers).
     log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, log_number,
+                       &read_reporter, true /*checksum*/, log_number,
                        false /* retry_after_eof */);
 
-    // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
-    std::string scratch;
-    Slice record;
+    LogRecordPrefetcher prefetcher(&reader,
+                                   immutable_db_options_.wal_recovery_mode,
+                                   read_reporter.status);
+    std::string record_buffer;
     WriteBatch batch;
 
-    while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode) &&
+    while (!stop_replay_by_wal_filter && prefetcher.Next(&record_buffer) &&
            status.ok()) {
+      Slice record(record_buffer);
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
@@ -821,6 +935,9 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       }
     }
 
+    if (status.ok() && prefetcher.finished()) {
+      status = read_status;
+    }
     if (!status.ok()) {
       if (status.IsNotSupported()) {
         // We should not treat NotSupported as corruption. It is rather a clear
@@ -1112,6 +1229,166 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
   return s;
 }
 
+Status DBImpl::WriteTableWarmState() {
+  std::vector<std::pair<uint64_t, uint64_t>> file_reads;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized()) {
+        continue;
+      }
+      auto vstorage = cfd->current()->storage_info();
+      auto add_file = [&](FileMetaData* f) {
+        uint64_t reads =
+            f->stats.num_reads_sampled.load(std::memory_order_relaxed);
+        if (reads > 0) {
+          file_reads.emplace_back(f->fd.GetNumber(), reads);
+        }
+      };
+      for (int level = 0; level < vstorage->num_levels(); ++level) {
+        for (auto f : vstorage->LevelFiles(level)) {
+          add_file(f);
+        }
+      }
+      for (auto& pair : vstorage->dependence_map()) {
+        add_file(pair.second);
+      }
+    }
+  }
+  // One "<file number> <sampled reads>" line per file
+  std::string data;
+  for (auto& pair : file_reads) {
+    AppendNumberTo(&data, pair.first);
+    data.push_back(' ');
+    AppendNumberTo(&data, pair.second);
+    data.push_back('\n');
+  }
+  std::string fname = TableWarmStateFileName(dbname_);
+  std::string tmp = fname + ".tmp";
+  Status s = WriteStringToFile(env_, data, tmp, true /* should_sync */);
+  if (s.ok()) {
+    s = env_->RenameFile(tmp, fname);
+  }
+  if (!s.ok()) {
+    env_->DeleteFile(tmp);
+  }
+  return s;
+}
+
+void DBImpl::WarmUpTables() {
+  // A missing or damaged file only costs the ordering, every table still gets
+  // opened
+  std::unordered_map<uint64_t, uint64_t> recorded_reads;
+  std::string data;
+  if (ReadFileToString(env_, TableWarmStateFileName(dbname_), &data).ok()) {
+    Slice input(data);
+    while (!input.empty()) {
+      uint64_t file_number, reads;
+      if (!ConsumeDecimalNumber(&input, &file_number) ||
+          !input.starts_with(" ")) {
+        break;
+      }
+      input.remove_prefix(1);
+      if (!ConsumeDecimalNumber(&input, &reads) || !input.starts_with("\n")) {
+        break;
+      }
+      input.remove_prefix(1);
+      recorded_reads[file_number] = reads;
+    }
+  }
+
+  struct TableToOpen {
+    ColumnFamilyData* cfd;
+    const FileMetaData* f;
+    int level;
+    uint64_t reads;
+    std::shared_ptr<const SliceTransform> prefix_extractor;
+  };
+  std::vector<TableToOpen> tables;
+  autovector<std::pair<ColumnFamilyData*, Version*>> versions;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped() || !cfd->initialized()) {
+        continue;
+      }
+      cfd->Ref();
+      Version* version = cfd->current();
+      version->Ref();
+      versions.emplace_back(cfd, version);
+      auto prefix_extractor =
+          cfd->GetLatestMutableCFOptions()->prefix_extractor;
+      auto vstorage = version->storage_info();
+      std::unordered_set<uint64_t> seen;
+      auto add_file = [&](const FileMetaData* f, int level) {
+        if (f->table_reader_handle != nullptr ||
+            !seen.emplace(f->fd.GetNumber()).second) {
+          return;
+        }
+        auto find = recorded_reads.find(f->fd.GetNumber());
+        tables.emplace_back(TableToOpen{
+            cfd, f, level, find == recorded_reads.end() ? 0 : find->second,
+            prefix_extractor});
+      };
+      for (int level = 0; level < vstorage->num_levels(); ++level) {
+        for (auto f : vstorage->LevelFiles(level)) {
+          add_file(f, level);
+        }
+      }
+      for (auto& pair : vstorage->dependence_map()) {
+        add_file(pair.second, -1);
+      }
+    }
+  }
+  std::stable_sort(tables.begin(), tables.end(),
+                   [](const TableToOpen& a, const TableToOpen& b) {
+                     return a.reads > b.reads;
+                   });
+
+  uint64_t start_micros = env_->NowMicros();
+  size_t opened = 0;
+  for (auto& t : tables) {
+    if (shutting_down_.load(std::memory_order_acquire)) {
+      break;
+    }
+    Cache::Handle* handle = nullptr;
+    // The table cache is unlimited, so the reader stays cached after the
+    // handle is released
+    Status s = t.cfd->table_cache()->FindTable(
+        env_options_, t.cfd->internal_comparator(), t.f->fd, &handle,
+        t.prefix_extractor.get(), false /* no_io */,
+        true /* record_read_stats */,
+        t.level >= 0 ? t.cfd->internal_stats()->GetFileReadHist(t.level)
+                     : nullptr,
+        false /* skip_filters */, t.level,
+        false /* prefetch_index_and_filter_in_cache */);
+    if (s.ok()) {
+      t.cfd->table_cache()->ReleaseHandle(handle);
+      ++opened;
+    } else {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "[%s] Table warm up failed to open #%" PRIu64 ": %s",
+                     t.cfd->GetName().c_str(), t.f->fd.GetNumber(),
+                     s.ToString().c_str());
+    }
+  }
+  ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                 "Table warm up opened %" ROCKSDB_PRIszt " of %" ROCKSDB_PRIszt
+                 " tables (%" ROCKSDB_PRIszt
+                 " with recorded reads) in %" PRIu64 " us",
+                 opened, tables.size(), recorded_reads.size(),
+                 env_->NowMicros() - start_micros);
+
+  tables.clear();
+  InstrumentedMutexLock l(&mutex_);
+  for (auto& pair : versions) {
+    pair.second->Unref();
+    if (pair.first->Unref()) {
+      delete pair.first;
+    }
+  }
+}
+
 Status DB::Open(const Options& options, const std::string& dbname, DB** dbptr) {
   DBOptions db_options(options);
   ColumnFamilyOptions cf_options(options);
@@ -1338,6 +1615,11 @@ Status DBImpl::Open(const DBOptions& db_options, const std::string& dbname,
     *dbptr = impl;
     impl->opened_successfully_ = true;
     impl->MaybeScheduleFlushOrCompaction();
+    if (impl->immutable_db_options_.persist_table_warm_state &&
+        impl->table_cache_->GetCapacity() == TableCache::kInfiniteCapacity) {
+      impl->table_warm_up_thread_ =
+          port::Thread([impl] { impl->WarmUpTables(); });
+    }
   }
   impl->FillLogWriterPool();
   impl->mutex_.Unlock();
@@ -134,6 +134,7 @@ class DBIter final : public Iterator {
         iterate_upper_bound_(read_options.iterate_upper_bound),
         prefix_same_as_start_(read_options.prefix_same_as_start),
         total_order_seek_(read_options.total_order_seek),
+        key_only_(read_options.key_only),
         range_del_agg_(&cf_options.internal_comparator, s),
         read_callback_(read_callback),
         db_impl_(db_impl),
@@ -252,7 +253,9 @@ class DBIter final : public Iterator {
   bool ParseKey(ParsedInternalKey* key);
   bool MergeValuesNewToOld();
   LazyBuffer GetValue(const ParsedInternalKey& ikey, ValueType index_type) {
-    if (separate_helper_ == nullptr || ikey.type != index_type) {
+    if (key_only_) {
+      return LazyBuffer();
+    } else if (separate_helper_ == nullptr || ikey.type != index_type) {
       return iter_->value();
     } else {
       return separate_helper_->TransToCombined(saved_key_.GetUserKey(),
@@ -320,6 +323,8 @@ class DBIter final : public Iterator {
   Slice prefix_start_key_;
   const bool prefix_same_as_start_;
   const bool total_order_seek_;
+  // Never fetch, resolve or merge values, see ReadOptions::key_only
+  const bool key_only_;
   // List of operands for merge operator.
   MergeContext merge_context_;
   ReadRangeDelAggregator range_del_agg_;
@@ -521,6 +526,12 @@ bool DBIter::FindNextUserEntryInternal(bool skipping, bool prefix_check) {
               skipping = true;
               num_skipped = 0;
               PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
+            } else if (key_only_) {
+              // The key is present, no need to look at the operands. iter_
+              // stays on this entry like for a plain value
+              value_.clear();
+              valid_ = true;
+              return true;
             } else {
               // By now, we are sure the current ikey is going to yield a
               // value
@@ -895,7 +906,7 @@ bool DBIter::FindValueForCurrentKey() {
           last_key_entry_type = kTypeRangeDeletion;
           last_not_merge_type = last_key_entry_type;
           PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
-        } else {
+        } else if (!key_only_) {
           assert(merge_operator_ != nullptr);
           merge_context_.PushOperandBack(GetValue(ikey, kTypeMergeIndex));
           PERF_COUNTER_ADD(internal_merge_count, 1);
@@ -925,7 +936,9 @@ bool DBIter::FindValueForCurrentKey() {
     case kTypeMerge:
     case kTypeMergeIndex:
       current_entry_is_merged_ = true;
-      if (last_not_merge_type == kTypeDeletion ||
+      if (key_only_) {
+        value_.clear();
+      } else if (last_not_merge_type == kTypeDeletion ||
           last_not_merge_type == kTypeSingleDeletion ||
           last_not_merge_type == kTypeRangeDeletion) {
         value_.reset(&value_buffer_);
@@ -1016,6 +1029,11 @@ bool DBIter::FindValueForCurrentKeyUsingSeek() {
   // kTypeMerge. We need to collect all kTypeMerge values and save them
   // in operands
   assert(ikey.type == kTypeMerge || ikey.type == kTypeMergeIndex);
+  if (key_only_) {
+    value_.clear();
+    valid_ = true;
+    return true;
+  }
   current_entry_is_merged_ = true;
   merge_context_.Clear();
   merge_context_.PushOperand(GetValue(ikey, kTypeMergeIndex));
@@ -1097,6 +1097,64 @@ TEST_P(DBIteratorTest, PrevAfterAndNextAfterMerge) {
   ASSERT_EQ("2", it->key().ToString());
 }
 
+TEST_P(DBIteratorTest, KeyOnly) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.max_sequential_skip_in_iterations = 2;
+  DestroyAndReopen(options);
+
+  WriteOptions wopts;
+  ASSERT_OK(Put("a", "va"));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_OK(db_->Merge(wopts, "b", "vb"));
+  }
+  ASSERT_OK(Put("c", "vc"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Delete("c"));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_OK(Put("d", "vd"));
+  }
+  // Merging would fail without a merge operator, key only iterators never
+  // merge
+  options.merge_operator = nullptr;
+  Reopen(options);
+
+  ReadOptions ro;
+  ro.key_only = true;
+  std::unique_ptr<Iterator> it(NewIterator(ro));
+  std::string keys;
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    ASSERT_EQ("", it->value().ToString());
+    keys += it->key().ToString();
+  }
+  ASSERT_OK(it->status());
+  ASSERT_EQ("abd", keys);
+  keys.clear();
+  for (it->SeekToLast(); it->Valid(); it->Prev()) {
+    ASSERT_EQ("", it->value().ToString());
+    keys += it->key().ToString();
+  }
+  ASSERT_OK(it->status());
+  ASSERT_EQ("dba", keys);
+
+  it->Seek("b");
+  ASSERT_TRUE(it->Valid());
+  ASSERT_EQ("b", it->key().ToString());
+  it->Prev();
+  ASSERT_TRUE(it->Valid());
+  ASSERT_EQ("a", it->key().ToString());
+  it->Next();
+  it->Next();
+  ASSERT_TRUE(it->Valid());
+  ASSERT_EQ("d", it->key().ToString());
+
+  it.reset(NewIterator(ReadOptions()));
+  it->Seek("b");
+  ASSERT_FALSE(it->Valid());
+  ASSERT_TRUE(it->status().IsInvalidArgument());
+}
+
 class SliceTransformLimitedDomainGeneric : public SliceTransform {
   const char* Name() const override {
     return "SliceTransformLimitedDomainGeneric";
@@ -193,6 +193,162 @@ TEST_F(DBMergeOperatorTest, MergeErrorOnIteration) {
   VerifyDBInternal({{"k1", "v1"}, {"k2", "corrupted"}, {"k2", "v2"}});
 }
 
+TEST_F(DBMergeOperatorTest, FoldMergeOperands) {
+  Options options;
+  options.create_if_missing = true;
+  options.merge_operator = MergeOperators::CreateUInt64AddOperator();
+  options.fold_merge_operands = true;
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.env = env_;
+  DestroyAndReopen(options);
+
+  auto fixed = [](uint64_t v) {
+    std::string s;
+    PutFixed64(&s, v);
+    return s;
+  };
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(Merge("k1", fixed(1)));
+  }
+  ASSERT_EQ(99, TestGetTickerCount(options, NUMBER_MERGE_OPERANDS_FOLDED));
+  ASSERT_EQ(fixed(100), Get("k1"));
+  VerifyDBInternal({{"k1", fixed(100)}});
+
+  // An operand visible to a snapshot is left alone
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Merge("k1", fixed(1)));
+  ASSERT_EQ(99, TestGetTickerCount(options, NUMBER_MERGE_OPERANDS_FOLDED));
+  ASSERT_EQ(fixed(100), Get("k1", snapshot));
+  ASSERT_EQ(fixed(101), Get("k1"));
+  db_->ReleaseSnapshot(snapshot);
+  ASSERT_OK(Merge("k1", fixed(1)));
+  ASSERT_EQ(100, TestGetTickerCount(options, NUMBER_MERGE_OPERANDS_FOLDED));
+  ASSERT_EQ(fixed(102), Get("k1"));
+  VerifyDBInternal({{"k1", fixed(2)}, {"k1", fixed(100)}});
+
+  // Flush collapses what is left into a single operand
+  ASSERT_OK(Flush());
+  VerifyDBInternal({{"k1", fixed(102)}});
+  ASSERT_EQ(fixed(102), Get("k1"));
+}
+
+TEST_F(DBMergeOperatorTest, FoldMergeOperandsConcurrentSnapshots) {
+  Options options;
+  options.create_if_missing = true;
+  options.merge_operator = MergeOperators::CreateUInt64AddOperator();
+  options.fold_merge_operands = true;
+  options.env = env_;
+  DestroyAndReopen(options);
+
+  std::string one;
+  PutFixed64(&one, 1);
+  const int kNumMerges = 20000;
+  std::atomic<bool> done(false);
+  port::Thread writer([&]() {
+    for (int i = 0; i < kNumMerges; ++i) {
+      ASSERT_OK(db_->Merge(WriteOptions(), "k", one));
+    }
+    done.store(true);
+  });
+
+  // Every write is a single merge of 1 into "k", so a snapshot must read
+  // exactly its own sequence number, no matter what was folded meanwhile
+  int checked = 0;
+  while (!done.load() || checked == 0) {
+    const Snapshot* snapshot = db_->GetSnapshot();
+    ReadOptions read_options;
+    read_options.snapshot = snapshot;
+    std::string value;
+    Status s = db_->Get(read_options, "k", &value);
+    uint64_t count = 0;
+    if (s.ok()) {
+      Slice input(value);
+      ASSERT_TRUE(GetFixed64(&input, &count));
+    } else {
+      ASSERT_TRUE(s.IsNotFound());
+    }
+    ASSERT_EQ(snapshot->GetSequenceNumber(), count);
+    db_->ReleaseSnapshot(snapshot);
+    ++checked;
+  }
+  writer.join();
+  std::string expected;
+  PutFixed64(&expected, kNumMerges);
+  ASSERT_EQ(expected, Get("k"));
+}
+
+TEST_F(DBMergeOperatorTest, MergeResultCache) {
+  class CountingStringAppendOp : public StringAppendTESTOperator {
+   public:
+    CountingStringAppendOp() : StringAppendTESTOperator(',') {}
+
+    bool FullMergeV2(const MergeOperationInput& merge_in,
+                     MergeOperationOutput* merge_out) const override {
+      ++num_full_merges;
+      return StringAppendTESTOperator::FullMergeV2(merge_in, merge_out);
+    }
+
+    mutable int num_full_merges = 0;
+  };
+
+  auto merge_op = std::make_shared<CountingStringAppendOp>();
+  Options options;
+  options.create_if_missing = true;
+  options.merge_operator = merge_op;
+  options.merge_result_cache = NewLRUCache(1 << 20);
+  options.env = env_;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Merge("k1", "a"));
+  ASSERT_OK(Merge("k1", "b"));
+  ASSERT_OK(Merge("k1", "c"));
+  ASSERT_OK(Flush());
+  merge_op->num_full_merges = 0;
+
+  ASSERT_EQ("a,b,c", Get("k1"));
+  ASSERT_EQ(1, merge_op->num_full_merges);
+  ASSERT_EQ("a,b,c", Get("k1"));
+  ASSERT_EQ(1, merge_op->num_full_merges);
+
+  // A newer operand in the memtable gets its own entry
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Merge("k1", "d"));
+  ASSERT_EQ("a,b,c,d", Get("k1"));
+  ASSERT_EQ(2, merge_op->num_full_merges);
+  ASSERT_EQ("a,b,c,d", Get("k1"));
+  ASSERT_EQ("a,b,c", Get("k1", snapshot));
+  ASSERT_EQ(2, merge_op->num_full_merges);
+  db_->ReleaseSnapshot(snapshot);
+
+  std::vector<std::string> values;
+  ASSERT_OK(db_->MultiGet(ReadOptions(), {"k1"}, &values)[0]);
+  ASSERT_EQ("a,b,c,d", values[0]);
+  ASSERT_EQ(2, merge_op->num_full_merges);
+
+  // A Put hides the cached results
+  ASSERT_OK(Put("k1", "x"));
+  ASSERT_OK(Merge("k1", "y"));
+  ASSERT_EQ("x,y", Get("k1"));
+  ASSERT_EQ(3, merge_op->num_full_merges);
+
+  // A compaction filter may drop older operands, so no results are cached
+  class KeepAllFilter : public CompactionFilter {
+   public:
+    bool Filter(int /*level*/, const Slice& /*key*/, const Slice& /*value*/,
+                std::string* /*new_value*/,
+                bool* /*value_changed*/) const override {
+      return false;
+    }
+    const char* Name() const override { return "KeepAllFilter"; }
+  };
+  KeepAllFilter filter;
+  options.compaction_filter = &filter;
+  Reopen(options);
+  merge_op->num_full_merges = 0;
+  ASSERT_EQ("x,y", Get("k1"));
+  ASSERT_EQ("x,y", Get("k1"));
+  ASSERT_EQ(2, merge_op->num_full_merges);
+}
 
 class MergeOperatorPinningTest : public DBMergeOperatorTest,
                                  public testing::WithParamInterface<bool> {
@@ -564,6 +564,78 @@ TEST_F(DBOptionsTest, RunStatsDumpPeriodSec) {
   Close();
 }
 
+TEST_F(DBOptionsTest, CompactionThrottleByReadLatency) {
+  Options options;
+  options.create_if_missing = true;
+  options.compaction_throttle_read_p99_micros = 200;
+  options.compaction_throttle_min_ratio = 0.25;
+  options.max_background_jobs = 16;
+  options.rate_limiter.reset(NewGenericRateLimiter(8 << 20));
+  // Freeze the clock of the tuning thread, the test tunes explicitly
+  std::unique_ptr<rocksdb::MockTimeEnv> mock_env;
+  mock_env.reset(new rocksdb::MockTimeEnv(env_));
+  mock_env->set_current_time(0);
+  options.env = mock_env.get();
+  std::atomic<bool> slow_reads(true);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::GetImpl:1", [&](void* /*arg*/) {
+        if (slow_reads.load()) {
+          env_->SleepForMicroseconds(1000);
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  Reopen(options);
+  ASSERT_OK(Put("foo", "bar"));
+  auto read_window = [&]() {
+    for (uint64_t i = 0; i < CompactionThrottler::kMinSamples; ++i) {
+      ASSERT_EQ("bar", Get("foo"));
+    }
+  };
+
+  read_window();
+  ASSERT_EQ(0.5, dbfull()->TEST_TuneCompactionThrottle());
+  ASSERT_EQ(4 << 20, dbfull()->TEST_ThrottledCompactionBytesPerSecond());
+  ASSERT_EQ(3, dbfull()->TEST_GetSubCompactionSlots(8));
+  read_window();
+  ASSERT_EQ(0.25, dbfull()->TEST_TuneCompactionThrottle());
+  read_window();
+  ASSERT_EQ(0.25, dbfull()->TEST_TuneCompactionThrottle());
+  ASSERT_EQ(2 << 20, dbfull()->TEST_ThrottledCompactionBytesPerSecond());
+  ASSERT_EQ(1, dbfull()->TEST_GetSubCompactionSlots(8));
+  // The user's rate limiter, which flushes also go through, is untouched
+  ASSERT_EQ(8 << 20, options.rate_limiter->GetBytesPerSecond());
+
+  // Recovers gradually once reads are fast again
+  slow_reads.store(false);
+  read_window();
+  ASSERT_NEAR(0.325, dbfull()->TEST_TuneCompactionThrottle(), 1e-9);
+  for (int i = 0; i < 10; ++i) {
+    read_window();
+    dbfull()->TEST_TuneCompactionThrottle();
+  }
+  ASSERT_EQ(1.0, dbfull()->TEST_TuneCompactionThrottle());
+  ASSERT_EQ(8 << 20, dbfull()->TEST_ThrottledCompactionBytesPerSecond());
+  ASSERT_EQ(7, dbfull()->TEST_GetSubCompactionSlots(8));
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
+TEST_F(DBOptionsTest, CompactionThrottleOnlyChargesLowPriority) {
+  std::unique_ptr<RateLimiter> base(NewGenericRateLimiter(8 << 20));
+  CompactionThrottler::ThrottledRateLimiter limiter(base.get(), 1 << 20);
+  limiter.Request(1000, Env::IO_HIGH, nullptr, RateLimiter::OpType::kWrite);
+  ASSERT_EQ(1000, base->GetTotalBytesThrough());
+  ASSERT_EQ(0, limiter.throttle()->GetTotalBytesThrough());
+  limiter.Request(1000, Env::IO_LOW, nullptr, RateLimiter::OpType::kWrite);
+  ASSERT_EQ(2000, base->GetTotalBytesThrough());
+  ASSERT_EQ(1000, limiter.throttle()->GetTotalBytesThrough());
+  ASSERT_EQ(std::min(base->GetSingleBurstBytes(),
+                     limiter.throttle()->GetSingleBurstBytes()),
+            limiter.GetSingleBurstBytes());
+}
+
 static void assert_candidate_files_empty(DBImpl* dbfull, const bool empty) {
   dbfull->TEST_LockMutex();
   JobContext job_context(0);
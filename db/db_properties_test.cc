@@ -1535,6 +1535,77 @@ TEST_F(DBPropertiesTest, SstFilesSize) {
   ASSERT_TRUE(listener->callback_triggered);
 }
 
+TEST_F(DBPropertiesTest, BlobFilesProperties) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.blob_size = 128;
+  Reopen(options);
+
+  uint64_t value = 0;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kBlobFilesSize, &value));
+  ASSERT_EQ(0, value);
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put("key" + ToString(i), std::string(1000, 'v')));
+  }
+  // Small values stay inline.
+  ASSERT_OK(Put("small", "v"));
+  ASSERT_OK(Flush());
+
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kBlobFilesSize, &value));
+  ASSERT_GT(value, 10 * 1000);
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kBlobNumEntries, &value));
+  ASSERT_EQ(10, value);
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kBlobNumAntiquation, &value));
+  ASSERT_EQ(0, value);
+
+  std::string read_amp;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kReadAmplification, &read_amp));
+  ASSERT_GT(std::stod(read_amp), 0);
+}
+
+TEST_F(DBPropertiesTest, IOHeatmap) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  std::string heatmap;
+  ASSERT_FALSE(db_->GetProperty(DB::Properties::kIOHeatmap, &heatmap));
+
+  options.io_heatmap_sample_period = 1;
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put("key" + ToString(i), std::string(1000, 'v')));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ(std::string(1000, 'v'), Get("key" + ToString(i)));
+  }
+
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1, files.size());
+  uint64_t number = 0;
+  FileType type;
+  ASSERT_TRUE(ParseFileName(files[0].name.substr(1), &number, &type));
+  char file_number[32];
+  snprintf(file_number, sizeof(file_number), "%06" PRIu64, number);
+
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kIOHeatmap, &heatmap));
+  ASSERT_NE(std::string::npos, heatmap.find(file_number));
+  ASSERT_NE(std::string::npos, heatmap.find("Hot blocks"));
+
+  std::string samples;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kIOHeatmapSamples, &samples));
+  ASSERT_EQ(0, samples.find(ToString(number) + ",0,"));
+  ASSERT_NE(std::string::npos, samples.find(",read\n"));
+  ASSERT_NE(std::string::npos, samples.find(",write\n"));
+}
+
 TEST_F(DBPropertiesTest, MinObsoleteSstNumberToKeep) {
   class TestListener : public EventListener {
    public:
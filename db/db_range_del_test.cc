@@ -633,6 +633,34 @@ TEST_F(DBRangeDelTest, GetCoveredKeyFromMutableMemtable) {
   } while (ChangeOptions(kRangeDelSkipConfigs));
 }
 
+TEST_F(DBRangeDelTest, GetWithSnapshotAfterNewerMemtableRangeDel) {
+  do {
+    DestroyAndReopen(CurrentOptions());
+    ASSERT_OK(db_->Put(WriteOptions(), "key", "val"));
+    ASSERT_OK(
+        db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "x", "z"));
+
+    // Fragments the memtable tombstones for the current sequence
+    std::string value;
+    ASSERT_OK(db_->Get(ReadOptions(), "key", &value));
+    const Snapshot* snapshot = db_->GetSnapshot();
+
+    ASSERT_OK(
+        db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a", "m"));
+
+    // An older snapshot may reuse the cached fragments, a newer read must
+    // see the new tombstone
+    ReadOptions snapshot_read_opts;
+    snapshot_read_opts.snapshot = snapshot;
+    ASSERT_OK(db_->Get(snapshot_read_opts, "key", &value));
+    ASSERT_EQ("val", value);
+    ASSERT_TRUE(db_->Get(ReadOptions(), "key", &value).IsNotFound());
+    ASSERT_OK(db_->Get(snapshot_read_opts, "key", &value));
+    ASSERT_EQ("val", value);
+    db_->ReleaseSnapshot(snapshot);
+  } while (ChangeOptions(kRangeDelSkipConfigs));
+}
+
 TEST_F(DBRangeDelTest, GetCoveredKeyFromImmutableMemtable) {
   do {
     Options opts = CurrentOptions();
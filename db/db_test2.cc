@@ -12,6 +12,7 @@
 
 #include "db/db_test_util.h"
 #include "db/read_callback.h"
+#include "monitoring/histogram.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/persistent_cache.h"
@@ -2760,6 +2761,93 @@ TEST_F(DBTest2, TraceWithLimit) {
   ASSERT_OK(DestroyDB(dbname2, options));
 }
 
+TEST_F(DBTest2, MultiThreadReplay) {
+  Options options = CurrentOptions();
+  ReadOptions ro;
+  EnvOptions env_opts;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, env_opts, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([this, t] {
+      for (int i = 0; i < 50; ++i) {
+        std::string key = "key" + ToString(t) + "_" + ToString(i);
+        ASSERT_OK(Put(t % 2, key, ToString(i)));
+        Get(t % 2, key);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::vector<std::string> values;
+  db_->MultiGet(ro, {handles_[0], handles_[1]}, {"key0_0", "key1_0"}, &values);
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ro, handles_[1]));
+  iter->Seek("key1");
+  iter->SeekForPrev("key3");
+  iter.reset();
+  ASSERT_OK(db_->EndTrace());
+
+  std::string dbname2 = test::TmpDir(env_) + "/db_multi_thread_replay";
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2_init = nullptr;
+  options.create_if_missing = true;
+  ASSERT_OK(DB::Open(options, dbname2, &db2_init));
+  ColumnFamilyHandle* cf;
+  ASSERT_OK(
+      db2_init->CreateColumnFamily(ColumnFamilyOptions(), "pikachu", &cf));
+  delete cf;
+  delete db2_init;
+
+  DB* db2 = nullptr;
+  std::vector<ColumnFamilyDescriptor> column_families;
+  column_families.push_back(ColumnFamilyDescriptor("default", options));
+  column_families.push_back(
+      ColumnFamilyDescriptor("pikachu", ColumnFamilyOptions()));
+  std::vector<ColumnFamilyHandle*> handles;
+  ASSERT_OK(DB::Open(DBOptions(), dbname2, column_families, &handles, &db2));
+
+  for (auto sharding : {TraceReplayOptions::kShardByKey,
+                        TraceReplayOptions::kShardByThread}) {
+    std::unique_ptr<TraceReader> trace_reader;
+    ASSERT_OK(
+        NewFileTraceReader(env_, env_opts, trace_filename, &trace_reader));
+    Replayer replayer(db2, handles, std::move(trace_reader));
+    TraceReplayOptions replay_options;
+    replay_options.num_threads = 3;
+    replay_options.sharding = sharding;
+    replay_options.fast_forward = 4;
+    std::map<TraceType, std::shared_ptr<HistogramImpl>> latencies;
+    ASSERT_OK(replayer.MultiThreadReplay(replay_options, &latencies));
+
+    ASSERT_EQ(200, latencies[kTraceWrite]->num());
+    ASSERT_EQ(200, latencies[kTraceGet]->num());
+    ASSERT_EQ(1, latencies[kTraceMultiGet]->num());
+    ASSERT_EQ(1, latencies[kTraceIteratorSeek]->num());
+    ASSERT_EQ(1, latencies[kTraceIteratorSeekForPrev]->num());
+  }
+
+  std::string value;
+  for (int t = 0; t < 4; ++t) {
+    for (int i = 0; i < 50; ++i) {
+      std::string key = "key" + ToString(t) + "_" + ToString(i);
+      ASSERT_OK(db2->Get(ro, handles[t % 2], key, &value));
+      ASSERT_EQ(ToString(i), value);
+    }
+  }
+
+  for (auto handle : handles) {
+    delete handle;
+  }
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+}
+
 #endif  // ROCKSDB_LITE
 
 TEST_F(DBTest2, LazyBufferAndMmapReads) {
@@ -237,6 +237,12 @@ static const std::string min_obsolete_sst_number_to_keep_str =
 static const std::string base_level_str = "base-level";
 static const std::string total_sst_files_size = "total-sst-files-size";
 static const std::string live_sst_files_size = "live-sst-files-size";
+static const std::string blob_files_size = "blob-files-size";
+static const std::string blob_num_entries = "blob-num-entries";
+static const std::string blob_num_antiquation = "blob-num-antiquation";
+static const std::string read_amplification = "read-amplification";
+static const std::string io_heatmap = "io-heatmap";
+static const std::string io_heatmap_samples = "io-heatmap-samples";
 static const std::string estimate_pending_comp_bytes =
     "estimate-pending-compaction-bytes";
 static const std::string aggregated_table_properties =
@@ -319,6 +325,17 @@ const std::string DB::Properties::kTotalSstFilesSize =
     rocksdb_prefix + total_sst_files_size;
 const std::string DB::Properties::kLiveSstFilesSize =
     rocksdb_prefix + live_sst_files_size;
+const std::string DB::Properties::kBlobFilesSize =
+    rocksdb_prefix + blob_files_size;
+const std::string DB::Properties::kBlobNumEntries =
+    rocksdb_prefix + blob_num_entries;
+const std::string DB::Properties::kBlobNumAntiquation =
+    rocksdb_prefix + blob_num_antiquation;
+const std::string DB::Properties::kReadAmplification =
+    rocksdb_prefix + read_amplification;
+const std::string DB::Properties::kIOHeatmap = rocksdb_prefix + io_heatmap;
+const std::string DB::Properties::kIOHeatmapSamples =
+    rocksdb_prefix + io_heatmap_samples;
 const std::string DB::Properties::kBaseLevel = rocksdb_prefix + base_level_str;
 const std::string DB::Properties::kEstimatePendingCompactionBytes =
     rocksdb_prefix + estimate_pending_comp_bytes;
@@ -446,6 +463,18 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kLiveSstFilesSize,
          {false, nullptr, &InternalStats::HandleLiveSstFilesSize, nullptr,
           nullptr}},
+        {DB::Properties::kBlobFilesSize,
+         {false, nullptr, &InternalStats::HandleBlobFilesSize, nullptr,
+          nullptr}},
+        {DB::Properties::kBlobNumEntries,
+         {false, nullptr, &InternalStats::HandleBlobNumEntries, nullptr,
+          nullptr}},
+        {DB::Properties::kBlobNumAntiquation,
+         {false, nullptr, &InternalStats::HandleBlobNumAntiquation, nullptr,
+          nullptr}},
+        {DB::Properties::kReadAmplification,
+         {false, &InternalStats::HandleReadAmplification, nullptr, nullptr,
+          nullptr}},
         {DB::Properties::kEstimatePendingCompactionBytes,
          {false, nullptr, &InternalStats::HandleEstimatePendingCompactionBytes,
           nullptr, nullptr}},
@@ -476,6 +505,12 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kOptionsStatistics,
          {false, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
+        {DB::Properties::kIOHeatmap,
+         {false, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleIOHeatmap}},
+        {DB::Properties::kIOHeatmapSamples,
+         {false, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleIOHeatmapSamples}},
 };
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
@@ -808,6 +843,57 @@ bool InternalStats::HandleLiveSstFilesSize(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleBlobFilesSize(uint64_t* value, DBImpl* /*db*/,
+                                        Version* /*version*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  uint64_t size = 0;
+  for (auto f : vstorage->LevelFiles(-1)) {
+    if (f->is_gc_forbidden()) {
+      continue;  // a dependency of map SSTs, not a blob SST
+    }
+    size += f->fd.GetFileSize();
+  }
+  *value = size;
+  return true;
+}
+
+bool InternalStats::HandleBlobNumEntries(uint64_t* value, DBImpl* /*db*/,
+                                         Version* /*version*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  uint64_t num_entries = 0;
+  for (auto f : vstorage->LevelFiles(-1)) {
+    if (f->is_gc_forbidden()) {
+      continue;  // a dependency of map SSTs, not a blob SST
+    }
+    num_entries += f->prop.num_entries;
+  }
+  *value = num_entries;
+  return true;
+}
+
+bool InternalStats::HandleBlobNumAntiquation(uint64_t* value, DBImpl* /*db*/,
+                                             Version* /*version*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  uint64_t num_antiquation = 0;
+  for (auto f : vstorage->LevelFiles(-1)) {
+    if (f->is_gc_forbidden()) {
+      continue;  // a dependency of map SSTs, not a blob SST
+    }
+    num_antiquation += f->num_antiquation;
+  }
+  *value = num_antiquation;
+  return true;
+}
+
+bool InternalStats::HandleReadAmplification(std::string* value,
+                                            Slice /*suffix*/) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.2f",
+           cfd_->current()->storage_info()->read_amplification());
+  *value = buf;
+  return true;
+}
+
 bool InternalStats::HandleEstimatePendingCompactionBytes(uint64_t* value,
                                                          DBImpl* /*db*/,
                                                          Version* /*version*/) {
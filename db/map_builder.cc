@@ -937,6 +937,136 @@ Status LoadDeleteRangeIter(
   return Status::OK();
 };
 
+// A range tombstone with sequence `tombstone_seq` hides data with seqnos in
+// [`smallest_seq`, `largest_seq`] from every reader iff it is newer than all
+// of the data and no snapshot can see some of the data but not the tombstone,
+// i.e. no snapshot lies in [`smallest_seq`, `tombstone_seq`).
+bool TombstoneHidesFromAllSnapshots(
+    SequenceNumber smallest_seq, SequenceNumber largest_seq,
+    SequenceNumber tombstone_seq,
+    const std::vector<SequenceNumber>& snapshots) {
+  if (tombstone_seq <= largest_seq) {
+    return false;
+  }
+  // snapshots are sorted ascending
+  auto it = std::lower_bound(snapshots.begin(), snapshots.end(), smallest_seq);
+  return it == snapshots.end() || *it >= tombstone_seq;
+}
+
+// Checks whether user keys [start, end] are covered by contiguous fragments
+// that hide data with seqnos in [`smallest_seq`, `largest_seq`] from every
+// snapshot. `end_exclusive` means the range stops right before user key `end`.
+bool IsCoveredByTombstones(const FragmentedRangeTombstoneList* list,
+                           const Slice& start, const Slice& end,
+                           bool end_exclusive, SequenceNumber smallest_seq,
+                           SequenceNumber largest_seq,
+                           const std::vector<SequenceNumber>& snapshots,
+                           const Comparator* uc) {
+  auto it = std::upper_bound(
+      list->begin(), list->end(), start,
+      [uc](const Slice& a,
+           const FragmentedRangeTombstoneList::RangeTombstoneStack& b) {
+        return uc->Compare(a, b.end_key) < 0;
+      });
+  if (it == list->end() || uc->Compare(it->start_key, start) > 0) {
+    return false;
+  }
+  while (true) {
+    // seqnums of a stack are sorted descending
+    SequenceNumber top_seq = *list->seq_iter(it->seq_start_idx);
+    if (!TombstoneHidesFromAllSnapshots(smallest_seq, largest_seq, top_seq,
+                                        snapshots)) {
+      return false;
+    }
+    int c = uc->Compare(end, it->end_key);
+    if (c < 0 || (c == 0 && end_exclusive)) {
+      return true;
+    }
+    auto next = std::next(it);
+    if (next == list->end() || uc->Compare(next->start_key, it->end_key) != 0) {
+      return false;
+    }
+    it = next;
+  }
+}
+
+// Removes the ranges whose keys are all deleted by range tombstones newer than
+// every file they depend on. Files only referenced by such ranges become
+// obsolete, so the space is reclaimed by the VersionEdit alone, without
+// reading or rewriting any data. The caller must keep the tombstones, they may
+// still cover older data in lower levels. Never drops every range, returns the
+// number of ranges dropped.
+size_t DropRangesCoveredByTombstones(
+    std::vector<RangeWithDepend>& ranges,
+    const std::vector<MapBuilderRangesItem::TombstonsItem>& tombstones,
+    const std::vector<SequenceNumber>& snapshots,
+    IteratorCache& iterator_cache, const InternalKeyComparator& icomp) {
+  if (tombstones.empty() || ranges.size() < 2) {
+    return 0;
+  }
+  auto uc = icomp.user_comparator();
+  auto is_covered = [&](const RangeWithDepend& r) {
+    if (r.dependence.empty()) {
+      return false;
+    }
+    SequenceNumber smallest_seq = kMaxSequenceNumber;
+    SequenceNumber largest_seq = 0;
+    for (auto& dependence : r.dependence) {
+      auto f = iterator_cache.GetFileMetaData(dependence.file_number);
+      if (f == nullptr) {
+        return false;
+      }
+      if (f->prop.has_range_deletions() && !f->prop.is_map_sst()) {
+        // A file holding nothing but range tombstones, such as the flush of a
+        // bulk DeleteRange, has no data to keep here, and its largest seqno
+        // is the seqno of the very tombstones we check against
+        TableReader* reader = nullptr;
+        auto iter = iterator_cache.GetIterator(f, &reader);
+        if (iter->status().ok() && reader != nullptr) {
+          auto props = reader->GetTableProperties();
+          if (props && props->num_entries == 0) {
+            continue;
+          }
+        }
+      }
+      smallest_seq = std::min(smallest_seq, f->fd.smallest_seqno);
+      largest_seq = std::max(largest_seq, f->fd.largest_seqno);
+    }
+    Slice start = ExtractUserKey(r.point[0]);
+    Slice end = ExtractUserKey(r.point[1]);
+    // A range ending at a range tombstone sentinel excludes its end user key
+    bool end_exclusive = GetInternalKeySeqno(r.point[1]) == kMaxSequenceNumber;
+    for (auto& item : tombstones) {
+      if (IsCoveredByTombstones(item.tombstones.get(), start, end,
+                                end_exclusive, smallest_seq, largest_seq,
+                                snapshots, uc)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  std::vector<bool> covered(ranges.size());
+  size_t drop_count = 0;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    covered[i] = is_covered(ranges[i]);
+    drop_count += covered[i];
+  }
+  if (drop_count == 0 || drop_count == ranges.size()) {
+    return 0;
+  }
+  size_t c = 0;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (!covered[i]) {
+      if (c != i) {
+        ranges[c] = std::move(ranges[i]);
+      }
+      ++c;
+    }
+  }
+  ranges.resize(c);
+  return drop_count;
+}
+
 }  // namespace
 
 MapBuilder::MapBuilder(int job_id, const ImmutableDBOptions& db_options,
@@ -957,7 +1087,8 @@ Status MapBuilder::Build(const std::vector<CompactionInputFiles>& inputs,
                          ColumnFamilyData* cfd, Version* version,
                          VersionEdit* edit, FileMetaData* file_meta_ptr,
                          std::unique_ptr<TableProperties>* prop_ptr,
-                         std::set<FileMetaData*>* deleted_files) {
+                         std::set<FileMetaData*>* deleted_files,
+                         const std::vector<SequenceNumber>* snapshots) {
   assert(output_level != 0 || inputs.front().level == 0);
   assert(!inputs.front().files.empty());
   auto vstorage = version->storage_info();
@@ -1186,6 +1317,17 @@ Status MapBuilder::Build(const std::vector<CompactionInputFiles>& inputs,
     ranges = std::move(level_ranges.front());
     level_ranges.clear();
   }
+  size_t dropped_range_count = 0;
+  if (snapshots != nullptr) {
+    dropped_range_count = DropRangesCoveredByTombstones(
+        ranges, tombstones, *snapshots, iterator_cache, icomp);
+    if (dropped_range_count > 0) {
+      ROCKS_LOG_INFO(db_options_.info_log,
+                     "[%s] [JOB %d] Dropped %" ROCKSDB_PRIszt
+                     " map ranges covered by range deletions",
+                     cfd->GetName().c_str(), job_id_, dropped_range_count);
+    }
+  }
   auto edit_add_file = [edit](int level, const FileMetaData* f) {
     // don't call edit->AddFile(level, *f)
     // assert(!file_meta->table_reader_handle);
@@ -1212,7 +1354,8 @@ Status MapBuilder::Build(const std::vector<CompactionInputFiles>& inputs,
   // make sure level 0 files seqno no overlap
   if (output_level != 0 || ranges.size() == 1) {
     std::unordered_map<uint64_t, const FileMetaData*> sst_live;
-    bool build_map_sst = false;
+    // dropped ranges need a map sst to keep their tombstones
+    bool build_map_sst = dropped_range_count > 0;
     // check is need build map
     for (auto& range : ranges) {
       if (range.dependence.size() > 1) {
@@ -1301,7 +1444,8 @@ Status MapBuilder::Build(const std::vector<CompactionInputFiles>& inputs,
                          const std::vector<Range>& push_range, int output_level,
                          uint32_t output_path_id, ColumnFamilyData* cfd,
                          Version* version, VersionEdit* edit,
-                         std::vector<MapBuilderOutput>* output) {
+                         std::vector<MapBuilderOutput>* output,
+                         const std::vector<SequenceNumber>* snapshots) {
   assert(output_level > 0);
   auto vstorage = version->storage_info();
   auto& icomp = cfd->internal_comparator();
@@ -1478,10 +1622,25 @@ Status MapBuilder::Build(const std::vector<CompactionInputFiles>& inputs,
       level_ranges.tombstones[level_ranges.self_tombstone_index].SetRanges(
           level_ranges.ranges);
     }
+    // tombstones pushed down into the output level may hide whole ranges of
+    // it, their ranges are set above so they are kept for the lower levels
+    size_t dropped_range_count = 0;
+    if (snapshots != nullptr && level_ranges.level == output_level) {
+      dropped_range_count = DropRangesCoveredByTombstones(
+          level_ranges.ranges, level_ranges.tombstones, *snapshots,
+          iterator_cache, icomp);
+      if (dropped_range_count > 0) {
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Dropped %" ROCKSDB_PRIszt
+                       " map ranges covered by range deletions",
+                       cfd->GetName().c_str(), job_id_, dropped_range_count);
+      }
+    }
     // make sure level 0 files seqno no overlap
     if (level_ranges.level != 0 || level_ranges.ranges.size() == 1) {
       std::unordered_map<uint64_t, const FileMetaData*> sst_live;
-      bool build_map_sst = false;
+      // dropped ranges need a map sst to keep their tombstones
+      bool build_map_sst = dropped_range_count > 0;
       // check is need build map
       for (auto& range : level_ranges.ranges) {
         if (range.dependence.size() > 1) {
@@ -57,21 +57,26 @@ class MapBuilder {
   // added_files is sorted
   // file_meta::fd::file_size == 0 if don't need create map files
   // file_meta , porp , deleted_files nullptr if ignore
+  // snapshots is sorted ascending, if not nullptr, ranges hidden from all of
+  // them by newer range tombstones are dropped from the output map sst
   Status Build(const std::vector<CompactionInputFiles>& inputs,
                const std::vector<Range>& deleted_range,
                const std::vector<FileMetaData*>& added_files, int output_level,
                uint32_t output_path_id, ColumnFamilyData* cfd, Version* version,
                VersionEdit* edit, FileMetaData* file_meta = nullptr,
                std::unique_ptr<TableProperties>* porp = nullptr,
-               std::set<FileMetaData*>* deleted_files = nullptr);
+               std::set<FileMetaData*>* deleted_files = nullptr,
+               const std::vector<SequenceNumber>* snapshots = nullptr);
 
   // All params are references or pointers
   // push_range use user key
+  // snapshots same as above, only the output level ranges are dropped
   Status Build(const std::vector<CompactionInputFiles>& inputs,
                const std::vector<Range>& push_range, int output_level,
                uint32_t output_path_id, ColumnFamilyData* cfd, Version* version,
                VersionEdit* edit,
-               std::vector<MapBuilderOutput>* output = nullptr);
+               std::vector<MapBuilderOutput>* output = nullptr,
+               const std::vector<SequenceNumber>* snapshots = nullptr);
 
  private:
   Status WriteOutputFile(const FileMetaDataBoundBuilder& bound_builder,
@@ -147,6 +147,9 @@ class MapBuilderTest : public testing::Test {
     mock::MockTableFileSystem::FileData file_data;
     file_data.table = kv_contents;
     file_data.tombstone = del_contents;
+    auto prop = std::make_shared<TableProperties>();
+    prop->num_entries = kv_contents.size();
+    file_data.prop = prop;
     assert(file_number <= std::numeric_limits<uint32_t>::max());
     auto ib = mock_table_system_.files.emplace(uint32_t(file_number),
                                                std::move(file_data));
@@ -182,6 +185,53 @@ class MapBuilderTest : public testing::Test {
     return contents;
   }
 
+  enum CoveredRangeSnapshot {
+    kNoSnapshot,
+    // Sees all of the covered file but not the range deletion
+    kSnapshotAfterFile,
+    // Sees the older half of the covered file
+    kSnapshotInsideFile,
+  };
+
+  // Builds a map sst where the L1 file holding [5, 6] is hidden by a newer
+  // L0 range deletion, returns whether the map still depends on that file
+  bool BuildWithCoveredRange(CoveredRangeSnapshot snapshot_type) {
+    MapBuilder map_builder(0, db_options_, env_options_, versions_.get(),
+                           stats_, dbname_);
+    input_files_.resize(2);
+    stl_wrappers::KVMap kv_contents1, kv_contents2, empty_contents;
+    kv_contents1 = CreateFile(0, 3, false /*is_range_delete*/);
+    SequenceNumber inside_snapshot = sequence_number + 1;
+    kv_contents2 = CreateFile(5, 6, false);
+    SequenceNumber after_snapshot = sequence_number;
+    stl_wrappers::KVMap del_contents = CreateFile(4, 8, true);
+    AddMockFile(empty_contents, 0 /*level*/, true, del_contents);
+    AddMockFile(kv_contents1, 1, false, empty_contents);
+    AddMockFile(kv_contents2, 1, false, empty_contents);
+    uint64_t covered_file_number = files_.back()->fd.GetNumber();
+    UpdateVersionStorageInfo();
+    std::vector<Range> deleted_range;
+    std::vector<FileMetaData*> added_files;
+    std::vector<SequenceNumber> snapshots;
+    if (snapshot_type == kSnapshotAfterFile) {
+      snapshots.push_back(after_snapshot);
+    } else if (snapshot_type == kSnapshotInsideFile) {
+      snapshots.push_back(inside_snapshot);
+    }
+    std::unique_ptr<FileMetaData> output_file(new FileMetaData);
+    std::set<FileMetaData*> deleted_files;
+    Status s = map_builder.Build(
+        input_files_, deleted_range, added_files, 1, 0, cfd_, cfd_->current(),
+        &edit, output_file.get(), nullptr, &deleted_files, &snapshots);
+    EXPECT_OK(s);
+    EXPECT_GT(output_file->fd.file_size, 0U);
+    bool depend_on_covered = false;
+    for (auto& dependence : output_file->prop.dependence) {
+      depend_on_covered |= dependence.file_number == covered_file_number;
+    }
+    return depend_on_covered;
+  }
+
   Slice FindInternalKey(const Slice& user_key_,
                         const stl_wrappers::KVMap& content_) {
     auto ucmp = cfd_->user_comparator();
@@ -288,6 +338,23 @@ TEST_F(MapBuilderTest, RangeDel) {
   ASSERT_OK(s);
 }
 
+TEST_F(MapBuilderTest, DropRangesCoveredByRangeDel) {
+  Init();
+  ASSERT_FALSE(BuildWithCoveredRange(kNoSnapshot));
+}
+
+TEST_F(MapBuilderTest, KeepRangesVisibleToSnapshot) {
+  Init();
+  // The snapshot still sees [5, 6], the range must survive
+  ASSERT_TRUE(BuildWithCoveredRange(kSnapshotAfterFile));
+}
+
+TEST_F(MapBuilderTest, KeepRangesPartlyVisibleToSnapshot) {
+  Init();
+  // The snapshot falls between the seqnos of the file, it still sees key 5
+  ASSERT_TRUE(BuildWithCoveredRange(kSnapshotInsideFile));
+}
+
 TEST_F(MapBuilderTest, DeletedRange) {
   Init();
   MapBuilder map_builder(0, db_options_, env_options_, versions_.get(), stats_,
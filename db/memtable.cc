@@ -54,6 +54,7 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       inplace_callback(ioptions.inplace_callback),
       max_successive_merges(mutable_cf_options.max_successive_merges),
+      fold_merge_operands(ioptions.fold_merge_operands),
       statistics(ioptions.statistics),
       merge_operator(ioptions.merge_operator),
       info_log(ioptions.info_log) {}
@@ -75,7 +76,8 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                write_buffer_manager->cost_to_cache()))
                  ? &mem_tracker_
                  : nullptr,
-             mutable_cf_options.memtable_huge_page_size),
+             mutable_cf_options.memtable_huge_page_size,
+             ioptions.numa_aware),
       table_(mutable_cf_options.memtable_factory->CreateMemTableRep(
           comparator_, needs_dup_key_check, &arena_,
           mutable_cf_options.prefix_extractor.get(), ioptions.info_log,
@@ -98,7 +100,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       creation_seq_(latest_seq),
       mem_next_logfile_number_(0),
       min_prep_log_referenced_(0),
-      locks_(moptions_.inplace_update_support
+      locks_(moptions_.inplace_update_support || moptions_.fold_merge_operands
                  ? moptions_.inplace_update_num_locks
                  : 0),
       prefix_extractor_(mutable_cf_options.prefix_extractor.get()),
@@ -275,7 +277,9 @@ class MemTableIteratorBase : public InternalIteratorBase<TValue> {
         arena_mode_(arena != nullptr),
         value_pinned_(
             !mem.GetImmutableMemTableOptions()->inplace_update_support ||
-            mem.IsImmutable()) {
+            mem.IsImmutable()),
+        merge_pinned_(!mem.GetImmutableMemTableOptions()->fold_merge_operands ||
+                      mem.IsImmutable()) {
     if (use_range_del_table) {
       iter_ = mem.range_del_table_->GetIterator(arena);
     } else if (mem_.prefix_extractor_ != nullptr &&
@@ -374,6 +378,7 @@ class MemTableIteratorBase : public InternalIteratorBase<TValue> {
   bool valid_;
   bool arena_mode_;
   bool value_pinned_;
+  bool merge_pinned_;
   bool is_seek_for_prev_supported_;
 
   // No copying allowed
@@ -402,6 +407,7 @@ class MemTableIterator : public MemTableIteratorBase<LazyBuffer>,
   using Base::iter_;
   using Base::mem_;
   using Base::valid_;
+  using Base::merge_pinned_;
   using Base::value_pinned_;
 
  public:
@@ -411,7 +417,7 @@ class MemTableIterator : public MemTableIteratorBase<LazyBuffer>,
 
   Status pin_buffer(LazyBuffer* buffer) const override {
     if (buffer->valid()) {
-      // value_pinned_ || (type != kTypeValue && type != kTypeValueIndex)
+      // IsPinned(type)
       return Status::OK();
     } else {
       return MemTableIterator::fetch_buffer(buffer);
@@ -437,12 +443,27 @@ class MemTableIterator : public MemTableIteratorBase<LazyBuffer>,
   virtual LazyBuffer value() const override {
     assert(valid_);
     ValueType type = GetInternalKeyType(iter_->key());
-    if (value_pinned_ || (type != kTypeValue && type != kTypeValueIndex)) {
+    if (IsPinned(type)) {
       return LazyBuffer(GetLengthPrefixedSlice(iter_->value()), Cleanable());
     } else {
       return LazyBuffer(this, {});
     }
   }
+
+ private:
+  // Values which may still be rewritten in place are copied under the key
+  // lock instead of referenced
+  bool IsPinned(ValueType type) const {
+    switch (type) {
+      case kTypeValue:
+      case kTypeValueIndex:
+        return value_pinned_;
+      case kTypeMerge:
+        return merge_pinned_;
+      default:
+        return true;
+    }
+  }
 };
 
 InternalIterator* MemTable::NewIterator(const ReadOptions& read_options,
@@ -459,36 +480,46 @@ FragmentedRangeTombstoneIterator* MemTable::NewRangeTombstoneIterator(
     return nullptr;
   }
 
-  std::shared_ptr<FragmentedRangeTombstoneList> fragmented_tombstone_list;
-  {
+  auto usable = [&](const CachedRangeTombstones* cached) {
+    return cached != nullptr &&
+           (cached->list->user_tag() == num_range_del ||
+            read_seq <= cached->visible_seq);
+  };
+  auto cached = std::atomic_load(&fragmented_range_dels_);
+  if (!usable(cached.get())) {
     MutexLock lock(&tombstone_locks_);
-    fragmented_tombstone_list = fragmented_range_dels_;
-  }
-
-  if (!fragmented_tombstone_list ||
-      fragmented_tombstone_list->user_tag() != num_range_del) {
-    auto* unfragmented_iter =
-        new MemTableTombstoneIterator(*this, read_options, nullptr /* arena */,
-                                      true /* use_range_del_table */);
-    if (unfragmented_iter == nullptr) {
-      return nullptr;
-    }
-    StopWatchNano timer(env_, true);
-    fragmented_tombstone_list = std::make_shared<FragmentedRangeTombstoneList>(
-        std::unique_ptr<InternalIteratorBase<Slice>>(unfragmented_iter),
-        comparator_.comparator, false /* for_compaction */,
-        std::vector<SequenceNumber>() /* snapshots */, num_range_del);
-    if (timer.ElapsedNanos() > 1000000ULL) {
-      is_range_del_slow_ = true;
-    }
-    if (num_range_del == num_range_del_.load(std::memory_order_relaxed)) {
-      MutexLock lock(&tombstone_locks_);
-      fragmented_range_dels_ = fragmented_tombstone_list;
+    // Another reader may have rebuilt the list while we were waiting
+    cached = std::atomic_load(&fragmented_range_dels_);
+    num_range_del = num_range_del_.load(std::memory_order_relaxed);
+    if (!usable(cached.get())) {
+      auto* unfragmented_iter = new MemTableTombstoneIterator(
+          *this, read_options, nullptr /* arena */,
+          true /* use_range_del_table */);
+      StopWatchNano timer(env_, true);
+      auto fragmented_tombstone_list =
+          std::make_shared<FragmentedRangeTombstoneList>(
+              std::unique_ptr<InternalIteratorBase<Slice>>(unfragmented_iter),
+              comparator_.comparator, false /* for_compaction */,
+              std::vector<SequenceNumber>() /* snapshots */, num_range_del);
+      if (timer.ElapsedNanos() > 1000000ULL) {
+        is_range_del_slow_ = true;
+      }
+      // Every tombstone visible at read_seq was inserted before read_seq was
+      // published, so the new list holds all of them. kMaxSequenceNumber is
+      // not a published sequence and proves nothing.
+      SequenceNumber visible_seq = cached ? cached->visible_seq : 0;
+      if (read_seq != kMaxSequenceNumber) {
+        visible_seq = std::max(visible_seq, read_seq);
+      }
+      cached = std::make_shared<const CachedRangeTombstones>(
+          CachedRangeTombstones{std::move(fragmented_tombstone_list),
+                                visible_seq});
+      std::atomic_store(&fragmented_range_dels_, cached);
     }
   }
 
   auto* fragmented_iter = new FragmentedRangeTombstoneIterator(
-      fragmented_tombstone_list, comparator_.comparator, read_seq);
+      cached->list, comparator_.comparator, read_seq);
   return fragmented_iter;
 }
 
@@ -631,6 +662,7 @@ struct Saver {
   Logger* logger;
   Statistics* statistics;
   bool inplace_update_support;
+  bool fold_merge_operands;
   Env* env_;
   ReadCallback* callback_;
 
@@ -737,9 +769,24 @@ static bool SaveValue(void* arg, const Slice& internal_key, const char* value) {
           *s->found_final_value = true;
           return false;
         }
+        if (s->fold_merge_operands) {
+          // The operand may still be folded under the same sequence number
+          merge_context->DisableResultCache();
+        } else if (merge_context->LookupResult(s->key->user_key(), seq,
+                                               s->value)) {
+          *s->status = Status::OK();
+          *s->found_final_value = true;
+          return false;
+        }
         *s->merge_in_progress = true;
-        merge_context->PushOperand(
-            LazyBuffer(GetLengthPrefixedSlice(value), Cleanable()));
+        if (s->fold_merge_operands) {
+          ReadLock rl(s->mem->GetLock(s->key->user_key()));
+          merge_context->PushOperand(
+              LazyBuffer(GetLengthPrefixedSlice(value), true));
+        } else {
+          merge_context->PushOperand(
+              LazyBuffer(GetLengthPrefixedSlice(value), Cleanable()));
+        }
         if (merge_operator->ShouldMerge(
                 merge_context->GetOperandsDirectionBackward())) {
           *s->status = MergeHelper::TimedFullMerge(
@@ -813,12 +860,18 @@ bool MemTable::Get(const LookupKey& key, LazyBuffer* value, Status* s,
     saver.merge_operator = moptions_.merge_operator;
     saver.logger = moptions_.info_log;
     saver.inplace_update_support = moptions_.inplace_update_support;
+    saver.fold_merge_operands =
+        moptions_.fold_merge_operands && !is_immutable_;
     saver.statistics = moptions_.statistics;
     saver.env_ = env_;
     saver.callback_ = callback;
     table_->Get(key, &saver, SaveValue);
 
     *seq = saver.seq;
+    if (found_final_value && merge_in_progress && s->ok() &&
+        value != nullptr) {
+      merge_context->InsertResult(*value);
+    }
   }
 
   // No change to value, since we have not yet found a Put/Delete
@@ -939,6 +992,61 @@ bool MemTable::UpdateCallback(SequenceNumber seq, const Slice& key,
   return false;
 }
 
+bool MemTable::FoldMerge(SequenceNumber seq, const Slice& key,
+                         const Slice& operand, SequenceNumber pinned_seq) {
+  assert(moptions_.fold_merge_operands);
+  // A range tombstone between the two operands would cover only the older one
+  if (moptions_.merge_operator == nullptr ||
+      num_range_del_.load(std::memory_order_relaxed) != 0) {
+    return false;
+  }
+  LookupKey lkey(key, seq);
+  Slice memkey = lkey.memtable_key();
+
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), memkey.data());
+
+  if (!iter->Valid() ||
+      !comparator_.comparator.user_comparator()->Equal(
+          ExtractUserKey(iter->key()), lkey.user_key())) {
+    return false;
+  }
+  const uint64_t tag = ExtractInternalKeyFooter(iter->key());
+  ValueType type;
+  SequenceNumber prev_seq;
+  UnPackSequenceAndType(tag, &prev_seq, &type);
+  if (type != kTypeMerge || prev_seq <= pinned_seq) {
+    return false;
+  }
+  const char* old_value_ptr = iter->value();
+  Slice old_value = GetLengthPrefixedSlice(old_value_ptr);
+
+  LazyBuffer merge_result;
+  bool merge_success;
+  {
+    StopWatchNano timer(env_, moptions_.statistics != nullptr);
+    PERF_TIMER_GUARD(merge_operator_time_nanos);
+    merge_success = moptions_.merge_operator->PartialMerge(
+        key, LazyBuffer(old_value), LazyBuffer(operand), &merge_result,
+        moptions_.info_log);
+    RecordTick(moptions_.statistics, MERGE_OPERATION_TOTAL_TIME,
+               moptions_.statistics ? timer.ElapsedNanosSafe() : 0);
+  }
+  if (!merge_success || !merge_result.fetch().ok() ||
+      merge_result.size() > old_value.size()) {
+    return false;
+  }
+  {
+    char* p = const_cast<char*>(old_value_ptr);
+    WriteLock wl(GetLock(lkey.user_key()));
+    p = EncodeVarint32(p, static_cast<uint32_t>(merge_result.size()));
+    memmove(p, merge_result.data(), merge_result.size());
+  }
+  RecordTick(moptions_.statistics, NUMBER_MERGE_OPERANDS_FOLDED);
+  return true;
+}
+
 size_t MemTable::CountSuccessiveMergeEntries(const LookupKey& key) {
   Slice memkey = key.memtable_key();
 
@@ -50,6 +50,7 @@ struct ImmutableMemTableOptions {
                                    Slice delta_value,
                                    std::string* merged_value);
   size_t max_successive_merges;
+  bool fold_merge_operands;
   Statistics* statistics;
   MergeOperator* merge_operator;
   Logger* info_log;
@@ -231,6 +232,21 @@ class MemTable {
   // operations on the same MemTable.
   bool UpdateCallback(SequenceNumber seq, const Slice& key, const Slice& delta);
 
+  // If the newest entry for key is a merge operand with a sequence number
+  // greater than pinned_seq, attempts to fold operand into it inplace.
+  // Pseudocode
+  //   if key exists in current memtable && prev_value is of type kTypeMerge
+  //      && no range deletion in memtable && prev_seq > pinned_seq
+  //     new_value = PartialMerge(prev_value, operand)
+  //     if sizeof(new_value) <= sizeof(prev_value)
+  //       update inplace, return true
+  //   return false
+  //
+  // REQUIRES: external synchronization to prevent simultaneous
+  // operations on the same MemTable.
+  bool FoldMerge(SequenceNumber seq, const Slice& key, const Slice& operand,
+                 SequenceNumber pinned_seq);
+
   // Returns the number of successive merge entries starting from the newest
   // entry for the key up to the last non-merge entry or last entry for the
   // key in the memtable.
@@ -410,7 +426,17 @@ class MemTable {
   ConcurrentArena arena_;
   std::unique_ptr<MemTableRep> table_;
   std::unique_ptr<MemTableRep> range_del_table_;
-  std::shared_ptr<FragmentedRangeTombstoneList> fragmented_range_dels_;
+
+  // Fragmented view of range_del_table_, shared by all readers. The list
+  // holds every tombstone inserted before it was built, so it stays usable
+  // for readers whose read sequence is not newer than `visible_seq` even
+  // after more range deletions arrive. Always accessed through
+  // std::atomic_load/std::atomic_store so readers never take a lock.
+  struct CachedRangeTombstones {
+    std::shared_ptr<FragmentedRangeTombstoneList> list;
+    SequenceNumber visible_seq;
+  };
+  std::shared_ptr<const CachedRangeTombstones> fragmented_range_dels_;
 
   // Total data size of all data inserted
   std::atomic<uint64_t> data_size_;
@@ -451,7 +477,9 @@ class MemTable {
   // rw locks for inplace updates
   std::vector<port::RWMutex> locks_;
 
-  // FragmentedRangeTombstoneList lock
+  // Serializes rebuilds of fragmented_range_dels_, so a burst of readers
+  // after a DeleteRange fragments the tombstones once instead of each reader
+  // doing it
   port::Mutex tombstone_locks_;
 
   const SliceTransform* const prefix_extractor_;
@@ -8,8 +8,10 @@
 #include <vector>
 
 #include "db/dbformat.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/slice.h"
 #include "table/internal_iterator.h"
+#include "util/coding.h"
 
 namespace rocksdb {
 
@@ -76,7 +78,67 @@ class MergeContext {
     return operand_list_;
   }
 
+  // Look up and keep full merge results in cache, under key_prefix + user key
+  // + sequence number of the newest operand. Outside an active memtable that
+  // folds merge operands, an operand is never rewritten under the same
+  // sequence number, so without a compaction filter, which may drop older
+  // operands, the result stays valid until evicted.
+  void SetResultCache(Cache* cache, const Slice& key_prefix) {
+    result_cache_ = cache;
+    result_cache_key_.assign(key_prefix.data(), key_prefix.size());
+    result_keyed_ = false;
+  }
+
+  // Operands seen from now on may still change in place
+  void DisableResultCache() { result_cache_ = nullptr; }
+
+  // Called with the newest visible merge operand of user_key, before any
+  // operand is pushed. Returns true if the full merge result is cached, and
+  // copies it into *value
+  bool LookupResult(const Slice& user_key, SequenceNumber seq,
+                    LazyBuffer* value) {
+    if (result_cache_ == nullptr || result_keyed_ || !operand_list_.empty()) {
+      return false;
+    }
+    if (seq == 0) {
+      // Zeroed by compaction, does not identify the operand any more
+      result_cache_ = nullptr;
+      return false;
+    }
+    result_cache_key_.append(user_key.data(), user_key.size());
+    PutFixed64(&result_cache_key_, seq);
+    result_keyed_ = true;
+    Cache::Handle* handle = result_cache_->Lookup(result_cache_key_);
+    if (handle == nullptr) {
+      return false;
+    }
+    if (value != nullptr) {
+      value->reset(
+          *reinterpret_cast<std::string*>(result_cache_->Value(handle)), true);
+    }
+    result_cache_->Release(handle);
+    result_cache_ = nullptr;
+    return true;
+  }
+
+  // Caches value as the full merge result of the operands pushed after
+  // LookupResult missed
+  void InsertResult(const LazyBuffer& value) {
+    if (result_cache_ == nullptr || !result_keyed_ || !value.fetch().ok()) {
+      return;
+    }
+    auto result = new std::string(value.data(), value.size());
+    result_cache_->Insert(result_cache_key_, result,
+                          result_cache_key_.size() + result->size(),
+                          &DeleteResult);
+    result_cache_ = nullptr;
+  }
+
  private:
+  static void DeleteResult(const Slice& /*key*/, void* value) {
+    delete reinterpret_cast<std::string*>(value);
+  }
+
   void SetDirectionForward() {
     if (operands_reversed_) {
       std::reverse(operand_list_.begin(), operand_list_.end());
@@ -94,6 +156,9 @@ class MergeContext {
   // List of operands
   std::vector<LazyBuffer> operand_list_;
   bool operands_reversed_ = true;
+  Cache* result_cache_ = nullptr;
+  std::string result_cache_key_;
+  bool result_keyed_ = false;
 };
 
 }  // namespace rocksdb
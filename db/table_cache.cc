@@ -196,6 +196,9 @@ Status TableCache::GetTableReaderImpl(
             record_read_stats ? ioptions_.statistics : nullptr, SST_READ_MICROS,
             file_read_hist, ioptions_.rate_limiter, for_compaction,
             ioptions_.listeners));
+    if (ioptions_.io_heatmap != nullptr) {
+      file_reader->SetIOHeatmap(ioptions_.io_heatmap, fd.GetNumber());
+    }
     s = ioptions_.table_factory->NewTableReader(
         TableReaderOptions(ioptions_, prefix_extractor, env_options,
                            internal_comparator, skip_filters, immortal_tables_,
@@ -1240,6 +1240,9 @@ Status Version::fetch_buffer(LazyBuffer* buffer) const {
                          cfd_->ioptions()->info_log, db_statistics_,
                          GetContext::kNotFound, user_key, buffer, &value_found,
                          nullptr, nullptr, nullptr, env_, &context_seq);
+  if (get_context.sample()) {
+    sample_file_read_inc(pair.second);
+  }
   IterKey iter_key;
   iter_key.SetInternalKey(user_key, sequence, kValueTypeForSeek);
   auto s = table_cache_->Get(
@@ -1366,6 +1369,10 @@ void Version::Get(const ReadOptions& read_options, const Slice& user_key,
         }
         PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
                                   fp.GetHitFileLevel());
+        if (merge_context != nullptr && value != nullptr &&
+            (value_found == nullptr || *value_found)) {
+          merge_context->InsertResult(*value);
+        }
         return;
       case GetContext::kDeleted:
         // Use empty error message for speed
@@ -1394,6 +1401,7 @@ void Version::Get(const ReadOptions& read_options, const Slice& user_key,
         info_log_, db_statistics_, env_, true);
     if (status->ok()) {
       value->pin(LazyBufferPinLevel::Internal);
+      merge_context->InsertResult(*value);
     }
   } else {
     if (key_exists != nullptr) {
@@ -1779,6 +1787,7 @@ void VersionStorageInfo::ComputeCompactionScore(
   is_pick_compaction_fail = false;
   ComputeFilesMarkedForCompaction();
   ComputeBottommostFilesMarkedForCompaction();
+  ComputeTemperaturePlacement(immutable_cf_options);
   if (mutable_cf_options.ttl > 0) {
     ComputeExpiredTtlFiles(immutable_cf_options, mutable_cf_options.ttl);
   }
@@ -1808,6 +1817,124 @@ void VersionStorageInfo::ComputeFilesMarkedForCompaction() {
   }
 }
 
+void VersionStorageInfo::ComputeTemperaturePlacement(
+    const ImmutableCFOptions& ioptions) {
+  files_marked_for_migration_.clear();
+  path_min_read_density_.clear();
+  path_used_bytes_.clear();
+  const auto& cf_paths = ioptions.cf_paths;
+  if (!ioptions.temperature_aware_placement || cf_paths.size() < 2) {
+    return;
+  }
+  const size_t last_path = cf_paths.size() - 1;
+  struct FileTemperature {
+    int level;
+    FileMetaData* f;
+    uint32_t path_id;
+    double read_density;
+  };
+  std::vector<FileTemperature> files;
+  path_used_bytes_.resize(cf_paths.size());
+  for (int level = -1; level < num_levels(); ++level) {
+    for (auto f : files_[level]) {
+      uint32_t path_id = static_cast<uint32_t>(
+          std::min<size_t>(f->fd.GetPathId(), last_path));
+      path_used_bytes_[path_id] += f->fd.GetFileSize();
+      files.emplace_back(FileTemperature{
+          level, f, path_id,
+          f->stats.num_reads_sampled.load(std::memory_order_relaxed) /
+              std::max<double>(1, f->fd.GetFileSize())});
+    }
+  }
+  std::sort(files.begin(), files.end(),
+            [](const FileTemperature& a, const FileTemperature& b) {
+              return a.read_density != b.read_density
+                         ? a.read_density > b.read_density
+                         : a.f->fd.GetNumber() > b.f->fd.GetNumber();
+            });
+
+  // Fill the paths hottest first to find where each file belongs.
+  std::vector<TemperatureMigration> promotions;
+  std::vector<TemperatureMigration> demotions;
+  path_min_read_density_.resize(last_path);
+  uint64_t path_filled = 0;
+  size_t path = 0;
+  for (auto& file : files) {
+    uint64_t file_size = file.f->fd.GetFileSize();
+    while (path < last_path &&
+           path_filled + file_size > cf_paths[path].target_size) {
+      ++path;
+      path_filled = 0;
+    }
+    path_filled += file_size;
+    if (path < last_path) {
+      path_min_read_density_[path] = file.read_density;
+    }
+    // L0 files are short lived, leave them where the flush put them.
+    if (file.level == 0 || file.f->being_compacted || file.path_id == path) {
+      continue;
+    }
+    uint32_t target = static_cast<uint32_t>(path);
+    if (target < file.path_id) {
+      if (file.read_density > 0) {
+        promotions.emplace_back(TemperatureMigration{file.level, file.f, target});
+      }
+    } else {
+      demotions.emplace_back(TemperatureMigration{file.level, file.f, target});
+    }
+  }
+
+  auto has_room = [&](uint32_t path_id, uint64_t file_size) {
+    return path_id == last_path ||
+           path_used_bytes_[path_id] + file_size <= cf_paths[path_id].target_size;
+  };
+  auto mark = [&](const TemperatureMigration& migration) {
+    uint32_t from = static_cast<uint32_t>(
+        std::min<size_t>(migration.file->fd.GetPathId(), last_path));
+    uint64_t file_size = migration.file->fd.GetFileSize();
+    path_used_bytes_[from] -= file_size;
+    path_used_bytes_[migration.path_id] += file_size;
+    files_marked_for_migration_.emplace_back(migration);
+  };
+  // Make room first: the coldest files leave a path that is over its target
+  // size, or that hotter files are waiting to move into.
+  std::vector<uint64_t> wanted_bytes(cf_paths.size());
+  for (auto& migration : promotions) {
+    wanted_bytes[migration.path_id] += migration.file->fd.GetFileSize();
+  }
+  for (auto it = demotions.rbegin(); it != demotions.rend(); ++it) {
+    uint32_t from = static_cast<uint32_t>(
+        std::min<size_t>(it->file->fd.GetPathId(), last_path));
+    if (path_used_bytes_[from] + wanted_bytes[from] >
+            cf_paths[from].target_size &&
+        has_room(it->path_id, it->file->fd.GetFileSize())) {
+      mark(*it);
+    }
+  }
+  for (auto& migration : promotions) {
+    if (has_room(migration.path_id, migration.file->fd.GetFileSize())) {
+      mark(migration);
+    }
+  }
+}
+
+uint32_t VersionStorageInfo::TemperaturePathId(
+    const ImmutableCFOptions& ioptions, double read_density, uint64_t bytes,
+    uint32_t default_path_id) const {
+  if (!ioptions.temperature_aware_placement ||
+      path_min_read_density_.empty() ||
+      path_used_bytes_.size() != ioptions.cf_paths.size()) {
+    return default_path_id;
+  }
+  for (size_t path = 0; path < path_min_read_density_.size(); ++path) {
+    if (read_density >= path_min_read_density_[path] &&
+        path_used_bytes_[path] + bytes <= ioptions.cf_paths[path].target_size) {
+      return static_cast<uint32_t>(path);
+    }
+  }
+  return static_cast<uint32_t>(path_min_read_density_.size());
+}
+
 void VersionStorageInfo::ComputeExpiredTtlFiles(
     const ImmutableCFOptions& ioptions, const uint64_t ttl) {
   assert(ttl > 0);
@@ -2904,6 +3031,7 @@ VersionSet::VersionSet(const std::string& dbname,
       current_version_number_(0),
       manifest_file_size_(0),
       manifest_edit_count_(0),
+      manifest_snapshot_size_(0),
       seq_per_batch_(seq_per_batch),
       env_options_(storage_options) {}
 
@@ -3097,12 +3225,20 @@ Status VersionSet::ProcessManifestWrites(
 #endif  // NDEBUG
 
   uint64_t new_manifest_file_size = 0;
+  uint64_t new_manifest_snapshot_size = 0;
   Status s;
 
   assert(pending_manifest_file_number_ == 0);
+  // Replaying the edits after the checkpoint costs more than loading a new
+  // checkpoint would
+  bool manifest_tail_too_large =
+      db_options_->max_manifest_tail_ratio > 0 &&
+      manifest_file_size_ - manifest_snapshot_size_ >
+          db_options_->max_manifest_tail_ratio * manifest_snapshot_size_;
   if (!descriptor_log_ ||
       manifest_file_size_ > db_options_->max_manifest_file_size ||
-      manifest_edit_count_ > db_options_->max_manifest_edit_count) {
+      manifest_edit_count_ > db_options_->max_manifest_edit_count ||
+      manifest_tail_too_large) {
     pending_manifest_file_number_ = NewFileNumber();
     batch_edits.back()->SetNextFile(next_file_number_.load());
     new_descriptor_log = true;
@@ -3171,6 +3307,7 @@ Status VersionSet::ProcessManifestWrites(
         descriptor_log_.reset(
             new log::Writer(std::move(file_writer), 0, false));
         s = WriteSnapshot(descriptor_log_.get());
+        new_manifest_snapshot_size = descriptor_log_->file()->GetFileSize();
       }
     }
 
@@ -3288,6 +3425,7 @@ Status VersionSet::ProcessManifestWrites(
     manifest_file_size_ = new_manifest_file_size;
     if (new_descriptor_log) {
       manifest_edit_count_ = 0;
+      manifest_snapshot_size_ = new_manifest_snapshot_size;
     } else {
       manifest_edit_count_ += batch_edits.size();
     }
@@ -3818,9 +3956,11 @@ Status VersionSet::Recover(
 
       bool load_essence_sst =
           GetColumnFamilySet()->get_table_cache()->GetCapacity() ==
-          TableCache::kInfiniteCapacity;
+              TableCache::kInfiniteCapacity &&
+          !db_options_->persist_table_warm_state;
       // if unlimited table cache, pre-load all table handle. otherwise only
-      // pre-load map sst.
+      // pre-load map sst. persist_table_warm_state leaves the others to
+      // DBImpl::WarmUpTables.
       // Need to do it out of the mutex.
       builder->LoadTableHandlers(
           cfd->internal_stats(), false /* prefetch_index_and_filter_in_cache */,
@@ -4477,6 +4617,67 @@ uint64_t VersionSet::ApproximateSize(Version* v, const FdWithKeyRange& f,
                                  f.file_metadata->prop.num_entries);
 }
 
+void VersionSet::GetKeyAnchors(Version* v, const FileMetaData* f,
+                               size_t num_anchors,
+                               std::vector<std::string>* anchors) {
+  if (num_anchors == 0) {
+    return;
+  }
+  auto vstorage = v->storage_info();
+  if (f->prop.is_map_sst()) {
+    auto& dependence_map = vstorage->dependence_map();
+    auto ucmp = v->cfd_->user_comparator();
+    Slice smallest = f->smallest.user_key();
+    Slice largest = f->largest.user_key();
+    uint64_t total_size = vstorage->FileSizeWithBlob(f, false, 1);
+    std::vector<std::string> dependence_anchors;
+    for (auto& dependence : f->prop.dependence) {
+      auto find = dependence_map.find(dependence.file_number);
+      if (find == dependence_map.end() || find->second->prop.is_map_sst()) {
+        continue;
+      }
+      const FileMetaData* dependence_f = find->second;
+      // total_size only counts the part of the file this map SST uses, but
+      // anchors outside of that part are dropped below, so ask for the whole
+      // file's worth
+      size_t n = static_cast<size_t>(
+          double(num_anchors) *
+          vstorage->FileSizeWithBlob(dependence_f, false, 1) /
+          std::max<uint64_t>(1, total_size));
+      dependence_anchors.clear();
+      GetKeyAnchors(v, dependence_f, n, &dependence_anchors);
+      for (auto& anchor : dependence_anchors) {
+        Slice user_key = ExtractUserKey(anchor);
+        if (ucmp->Compare(user_key, smallest) > 0 &&
+            ucmp->Compare(user_key, largest) <= 0) {
+          anchors->emplace_back(std::move(anchor));
+        }
+      }
+    }
+    return;
+  }
+  std::vector<std::string> user_keys;
+  TableReader* table_reader_ptr = f->fd.table_reader;
+  if (table_reader_ptr != nullptr) {
+    table_reader_ptr->GetKeyAnchors(num_anchors, &user_keys);
+  } else {
+    TableCache* table_cache = v->cfd_->table_cache();
+    Cache::Handle* handle = nullptr;
+    auto s = table_cache->FindTable(
+        v->env_options_, v->cfd_->internal_comparator(), f->fd, &handle,
+        v->GetMutableCFOptions().prefix_extractor.get());
+    if (s.ok()) {
+      table_reader_ptr = table_cache->GetTableReaderFromHandle(handle);
+      table_reader_ptr->GetKeyAnchors(num_anchors, &user_keys);
+      table_cache->ReleaseHandle(handle);
+    }
+  }
+  for (auto& user_key : user_keys) {
+    InternalKey ikey(user_key, kMaxSequenceNumber, kValueTypeForSeek);
+    anchors->emplace_back(ikey.Encode().ToString());
+  }
+}
+
 void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
   // pre-calculate space requirement
   int64_t total_files = 0;
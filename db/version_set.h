@@ -144,6 +144,17 @@ class VersionStorageInfo {
   void ComputeExpiredTtlFiles(const ImmutableCFOptions& ioptions,
                               const uint64_t ttl);
 
+  // This computes files_marked_for_migration_ and the read densities used to
+  // place compaction outputs when temperature_aware_placement is set. Called
+  // by ComputeCompactionScore().
+  //
+  // Files are ranked by sampled reads per byte and assigned to cf_paths
+  // hottest first, each path up to its target size. A file is marked for
+  // migration to a faster path only while that path has room, and to a slower
+  // one only while its own path is over its target size, so the placement
+  // converges instead of moving files back and forth.
+  void ComputeTemperaturePlacement(const ImmutableCFOptions& ioptions);
+
   // This computes bottommost_files_marked_for_compaction_ and is called by
   // ComputeCompactionScore() or UpdateOldestSnapshot().
   //
@@ -368,6 +379,27 @@ class VersionStorageInfo {
     return bottommost_files_marked_for_compaction_;
   }
 
+  struct TemperatureMigration {
+    int level;
+    FileMetaData* file;
+    uint32_t path_id;
+  };
+
+  // REQUIRES: This version has been saved (see VersionSet::SaveTo)
+  // REQUIRES: DB mutex held during access
+  const std::vector<TemperatureMigration>& FilesMarkedForMigration() const {
+    assert(finalized_);
+    return files_marked_for_migration_;
+  }
+
+  // Returns the first path whose files are no hotter than `read_density`
+  // (sampled reads per byte) and which still has room for `bytes`, or
+  // `default_path_id` if temperature_aware_placement is off.
+  // REQUIRES: DB mutex held during access
+  uint32_t TemperaturePathId(const ImmutableCFOptions& ioptions,
+                             double read_density, uint64_t bytes,
+                             uint32_t default_path_id) const;
+
   int base_level() const { return base_level_; }
   double level_multiplier() const { return level_multiplier_; }
 
@@ -543,6 +575,12 @@ class VersionStorageInfo {
 
   autovector<std::pair<int, FileMetaData*>> expired_ttl_files_;
 
+  // Calculated in ComputeTemperaturePlacement(), protected by DB mutex.
+  std::vector<TemperatureMigration> files_marked_for_migration_;
+  // Lowest read density assigned to each path but the last one.
+  std::vector<double> path_min_read_density_;
+  std::vector<uint64_t> path_used_bytes_;
+
   // These files are considered bottommost because none of their keys can exist
   // at lower levels. They are not necessarily all in the same level. The marked
   // ones are eligible for compaction because they contain duplicate key
@@ -1046,6 +1084,13 @@ class VersionSet {
   uint64_t ApproximateSize(Version* v, const Slice& start, const Slice& end,
                            int start_level = 0, int end_level = -1);
 
+  // Appends up to `num_anchors` keys that split the data of `f` into pieces
+  // of about the same size, as internal keys, see TableReader::GetKeyAnchors.
+  // A map SST takes them from the files it depends on, within its own range.
+  // Files whose table can't tell add none.
+  void GetKeyAnchors(Version* v, const FileMetaData* f, size_t num_anchors,
+                     std::vector<std::string>* anchors);
+
   // Return the size of the current manifest file
   uint64_t manifest_file_size() const { return manifest_file_size_; }
 
@@ -1171,6 +1216,9 @@ class VersionSet {
   // VersionEdit count of manifest file
   uint64_t manifest_edit_count_;
 
+  // Size of the checkpoint written at the head of the manifest file
+  uint64_t manifest_snapshot_size_;
+
   std::vector<ObsoleteFileInfo> obsolete_files_;
   std::vector<std::string> obsolete_manifests_;
 
@@ -1463,11 +1463,19 @@ class MemTableInserter : public WriteBatch::Handler {
     auto* moptions = mem->GetImmutableMemTableOptions();
     bool perform_merge = false;
 
+    // Folding rewrites an operand that is already visible, so it needs the
+    // DB to tell which operands are pinned by snapshots. With seq_per_batch_
+    // visibility is decided by the commit cache instead.
+    bool folded = moptions->fold_merge_operands && db_ != nullptr &&
+                  !seq_per_batch_ &&
+                  mem->FoldMerge(sequence_, key, value,
+                                 db_->BeginFoldMerge(sequence_));
+
     // If we pass DB through and options.max_successive_merges is hit
     // during recovery, Get() will be issued which will try to acquire
     // DB mutex and cause deadlock, as DB mutex is already held.
     // So we disable merge in recovery
-    if (moptions->max_successive_merges > 0 && db_ != nullptr &&
+    if (!folded && moptions->max_successive_merges > 0 && db_ != nullptr &&
         recovering_log_number_ == 0) {
       LookupKey lkey(key, sequence_);
 
@@ -1531,7 +1539,7 @@ class MemTableInserter : public WriteBatch::Handler {
       }
     }
 
-    if (!perform_merge) {
+    if (!folded && !perform_merge) {
       // Add merge operator to memtable
       bool mem_res = mem->Add(sequence_, kTypeMerge, key, value);
       if (UNLIKELY(!mem_res)) {
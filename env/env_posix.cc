@@ -945,6 +945,11 @@ class PosixEnv : public Env {
 #endif
   }
 
+  virtual void BindThreadPoolToNumaNodes(Priority pool = LOW) override {
+    assert(pool >= Priority::BOTTOM && pool <= Priority::HIGH);
+    thread_pools_[pool].BindToNumaNodes();
+  }
+
   virtual std::string TimeToString(uint64_t secondsSince1970) override {
     const time_t seconds = (time_t)secondsSince1970;
     struct tm t;
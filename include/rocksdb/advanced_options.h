@@ -231,7 +231,8 @@ struct AdvancedColumnFamilyOptions {
   bool inplace_update_support = false;
 
   // Number of locks used for inplace update
-  // Default: 10000, if inplace_update_support = true, else 0.
+  // Default: 10000, if inplace_update_support or fold_merge_operands = true,
+  // else 0.
   //
   // Dynamically changeable through SetOptions() API
   size_t inplace_update_num_locks = 10000;
@@ -602,6 +603,26 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t max_successive_merges = 0;
 
+  // Fold a merge operand into the newest entry of its key in the active
+  // memtable with MergeOperator::PartialMerge, instead of appending it, when
+  //   * that entry is a merge operand (kTypeMerge)
+  //   * no snapshot was taken at or after that entry's sequence number
+  //   * the memtable holds no range deletion
+  //   * the folded operand is not larger than the one it replaces
+  // This keeps hot keys updated through an associative merge operator (e.g.
+  // counters) at a single operand in the memtable, so reads no longer merge
+  // the whole stack. Flush collapses what is left the same way.
+  // GetSnapshot waits until the writes that may have folded are published,
+  // and no write folds while a snapshot is being taken, so a snapshot never
+  // sees an operand folded from a write newer than itself.
+  // Like inplace_update_support, the folded operand keeps the sequence number
+  // of the entry it replaces, so reads without a snapshot that race with the
+  // write, and optimistic transactions validated without a snapshot, may not
+  // observe the fold as a separate update. Not used with two-phase write
+  // policies that publish sequence numbers per batch (WritePrepared).
+  // Default: false
+  bool fold_merge_operands = false;
+
   // This flag specifies that the implementation should optimize the filters
   // mainly for cases where keys are found rather than also optimize for keys
   // missed. This would be used in cases where the application knows that
@@ -631,6 +652,17 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool force_consistency_checks = false;
 
+  // If true and more than one cf_paths (or db_paths) is configured, files are
+  // placed by read temperature instead of by level size. The read counters
+  // sampled on each file rank them hottest first and fill the paths in order
+  // up to their target sizes, so the first paths should be the fast ones.
+  // Compaction and garbage collection outputs go to the path their inputs'
+  // read density qualifies for, and files that end up in the wrong path are
+  // moved in the background without being rewritten.
+  //
+  // Default: false
+  bool temperature_aware_placement = false;
+
   // Measure IO stats in compactions and flushes, if true.
   //
   // Default: false
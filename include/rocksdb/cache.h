@@ -70,6 +70,13 @@ struct LRUCacheOptions {
   // internally (currently only XPRESS).
   std::shared_ptr<MemoryAllocator> memory_allocator;
 
+  // If true and the process runs on several NUMA nodes, every node gets its
+  // own 2^num_shard_bits shards and the capacity is split evenly between the
+  // nodes. Threads insert into and look up the shards of the node they run
+  // on, so blocks are allocated and read node locally. A block read from
+  // several nodes is cached once per node. No-op without NUMA support.
+  bool numa_aware = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -186,6 +186,22 @@ class CompactionFilter
     return Decision::kKeep;
   }
 
+  // Batched fetching of separated values (see blob_size). If this returns
+  // n > 0, compaction reads up to n input records ahead, calls NeedValue() for
+  // the separated values FilterV2() is going to see, and fetches the values it
+  // asked for in blob file order before FilterV2() is invoked on them, so a
+  // filter that inspects only a few values doesn't stall on one random read
+  // per key. Values NeedValue() declined are still fetched on demand if
+  // FilterV2() touches them, so a wrong answer only costs I/O.
+  virtual size_t ValuePrefetchWindow() const { return 0; }
+
+  // Decides from the key and value meta alone whether FilterV2() needs the
+  // value of `key`. Only called when ValuePrefetchWindow() > 0.
+  virtual bool NeedValue(int /*level*/, const Slice& /*key*/,
+                         const Slice& /*existing_value_meta*/) const {
+    return true;
+  }
+
   // By default, compaction will only call Filter() on keys written after the
   // most recent call to GetSnapshot(). However, if the compaction filter
   // overrides IgnoreSnapshots to make it return true, the compaction filter
@@ -654,6 +654,39 @@ class DB {
     //      files belong to the latest LSM tree.
     static const std::string kLiveSstFilesSize;
 
+    //  "rocksdb.blob-files-size" - returns total size (bytes) of the blob SSTs
+    //      holding separated values in the latest version.
+    static const std::string kBlobFilesSize;
+
+    //  "rocksdb.blob-num-entries" - returns total number of entries in the
+    //      blob SSTs of the latest version.
+    static const std::string kBlobNumEntries;
+
+    //  "rocksdb.blob-num-antiquation" - returns total number of entries in the
+    //      blob SSTs of the latest version that are no longer referenced and
+    //      wait for garbage collection.
+    static const std::string kBlobNumAntiquation;
+
+    //  "rocksdb.read-amplification" - returns the estimated number of sorted
+    //      runs a point lookup has to visit in the latest version, as a
+    //      decimal string. Not supported by GetIntProperty().
+    static const std::string kReadAmplification;
+
+    //  "rocksdb.io-heatmap" - returns a multi-line string with the sampled
+    //      reads and writes of each SST and blob SST in the latest versions
+    //      of all column families, and the most read blocks. Reads of
+    //      TerarkZip tables are not sampled, see io_heatmap_sample_period.
+    //      Needs io_heatmap_sample_period.
+    static const std::string kIOHeatmap;
+
+    //  "rocksdb.io-heatmap-samples" - returns the raw I/O samples held by the
+    //      heatmap as CSV lines "file,level,offset,size,micros,op", level is
+    //      -1 for blob SSTs, -2 for the other level -1 SSTs, which garbage
+    //      collection must keep because other SSTs depend on them, and empty
+    //      for files no longer in any latest version. Needs
+    //      io_heatmap_sample_period.
+    static const std::string kIOHeatmapSamples;
+
     //  "rocksdb.base-level" - returns number of level to which L0 data will be
     //      compacted.
     static const std::string kBaseLevel;
@@ -746,6 +779,9 @@ class DB {
   //  "rocksdb.min-obsolete-sst-number-to-keep"
   //  "rocksdb.total-sst-files-size"
   //  "rocksdb.live-sst-files-size"
+  //  "rocksdb.blob-files-size"
+  //  "rocksdb.blob-num-entries"
+  //  "rocksdb.blob-num-antiquation"
   //  "rocksdb.base-level"
   //  "rocksdb.estimate-pending-compaction-bytes"
   //  "rocksdb.num-running-compactions"
@@ -756,6 +792,7 @@ class DB {
   //  "rocksdb.block-cache-capacity"
   //  "rocksdb.block-cache-usage"
   //  "rocksdb.block-cache-pinned-usage"
+  // "rocksdb.read-amplification" is fractional, read it with GetProperty().
   virtual bool GetIntProperty(ColumnFamilyHandle* column_family,
                               const Slice& property, uint64_t* value) = 0;
   virtual bool GetIntProperty(const Slice& property, uint64_t* value) {
@@ -418,6 +418,10 @@ class Env {
   // Lower CPU priority for threads from the specified pool.
   virtual void LowerThreadPoolCPUPriority(Priority /*pool*/ = LOW) {}
 
+  // Bind threads from the specified pool round robin to the NUMA nodes.
+  // Only has effect when built with NUMA support.
+  virtual void BindThreadPoolToNumaNodes(Priority /*pool*/ = LOW) {}
+
   // Converts seconds-since-Jan-01-1970 to a printable string
   virtual std::string TimeToString(uint64_t time) = 0;
 
@@ -1355,6 +1359,10 @@ class EnvWrapper : public Env {
     target_->LowerThreadPoolCPUPriority(pool);
   }
 
+  void BindThreadPoolToNumaNodes(Priority pool = LOW) override {
+    target_->BindThreadPoolToNumaNodes(pool);
+  }
+
   std::string TimeToString(uint64_t time) override {
     return target_->TimeToString(time);
   }
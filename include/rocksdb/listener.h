@@ -98,6 +98,8 @@ enum class CompactionReason : int {
   kGarbageCollection,
   // Found RangeDeletion
   kRangeDeletion,
+  // Move files between cf_paths by read temperature
+  kTemperatureMigration,
   // total number of compaction reasons, new reasons must be added above this.
   kNumOfReasons,
 };
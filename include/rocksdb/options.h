@@ -465,6 +465,50 @@ struct DBOptions {
   // Default: 16
   int max_file_opening_threads = 16;
 
+  // Only used when max_open_files is -1. If true, DB::Open only waits for the
+  // table readers of map SSTs, the other SSTs are opened and warmed up by a
+  // background thread once the DB is serving. Reads that come first open
+  // their files on demand. A clean shutdown records the files that served
+  // reads into the TABLE_WARM_STATE file, the next open warms them up first,
+  // hottest first.
+  // Default: false
+  bool persist_table_warm_state = false;
+
+  // If not zero, one of every io_heatmap_sample_period reads and writes of
+  // SSTs (blob SSTs included) is recorded with its file, offset, size and
+  // latency into an in-memory ring of recent samples. The samples are
+  // exposed through the "rocksdb.io-heatmap" and "rocksdb.io-heatmap-samples"
+  // properties.
+  // Reads of TerarkZip tables are not sampled: they map the whole file and
+  // read their index and records straight from the mapping.
+  // Default: 0
+  uint32_t io_heatmap_sample_period = 0;
+
+  // If true, DB::Open binds the threads of env's background pools round
+  // robin to the NUMA nodes, and memtables allocate the memory a writer
+  // fills on the node the writer runs on. See LRUCacheOptions::numa_aware
+  // for per-node block cache shards. No-op unless built with NUMA support.
+  // Default: false
+  bool numa_aware = false;
+
+  // Targets for the p99 latency of reads (Get/MultiGet) and writes, in
+  // microseconds. If either is not zero, the p99 of the last second is
+  // checked every second: while a target is missed compaction and garbage
+  // collection are throttled down, and they are restored gradually once
+  // latency has headroom. The number of subcompactions is scaled down and,
+  // if rate_limiter is set, compaction and GC output writes are charged to
+  // an internal limiter as well, whose rate is scaled down from the rate of
+  // rate_limiter at open. rate_limiter itself is not changed and flushes are
+  // not throttled. Without rate_limiter only subcompactions are throttled.
+  // Default: 0
+  uint64_t compaction_throttle_read_p99_micros = 0;
+  uint64_t compaction_throttle_write_p99_micros = 0;
+
+  // The lowest fraction of the compaction I/O rate and subcompactions the
+  // latency feedback may throttle down to, in [0, 1].
+  // Default: 0.1
+  double compaction_throttle_min_ratio = 0.1;
+
   //
   // Default: 0
   //
@@ -640,6 +684,15 @@ struct DBOptions {
   uint64_t max_manifest_file_size = 1024 * 1024 * 1024;
   uint64_t max_manifest_edit_count = 4096;
 
+  // The manifest file starts with a checkpoint of every column family,
+  // recovery loads it and then replays the edits appended since. When those
+  // edits grow beyond this many times the size of the checkpoint, the
+  // manifest is rolled over to a new checkpoint, which bounds recovery time
+  // even when large map SST edits keep the file below max_manifest_file_size.
+  // 0 disables the check.
+  // Default: 0
+  double max_manifest_tail_ratio = 0;
+
   // Number of shards used for table cache.
   int table_cache_numshardbits = 6;
 
@@ -944,6 +997,18 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   std::shared_ptr<Cache> row_cache = nullptr;
 
+  // If non-null, Get() and MultiGet() keep the results of full merges here,
+  // keyed by column family, user key and the sequence number of the newest
+  // merge operand, and reuse them until a newer entry is written for the key.
+  // Saves rebuilding values of keys with long merge chains on every read.
+  // Not used by reads through a ReadCallback (WritePrepared transactions),
+  // with read_tier other than kReadAllTier, or in column families with a
+  // compaction_filter or compaction_filter_factory, since a filter (e.g.
+  // TTL) may drop older operands and leave the cached result stale. May be
+  // the same cache as row_cache.
+  // Default: nullptr (disabled)
+  std::shared_ptr<Cache> merge_result_cache = nullptr;
+
   std::shared_ptr<MetricsReporterFactory> metrics_reporter_factory = nullptr;
 
 #ifndef ROCKSDB_LITE
@@ -1196,6 +1261,15 @@ struct ReadOptions {
   // Default: false
   bool ignore_range_deletions;
 
+  // If true, iterators only enumerate keys, Iterator::value() returns an empty
+  // slice. Values are never fetched, separated values are never resolved and
+  // merge operands are never merged, a key holding merge operands is returned
+  // as long as it is not deleted. TerarkZip tables skip unzipping the records
+  // of keys whose sequence number is zeroed out. Has no impact on Get and
+  // MultiGet.
+  // Default: false
+  bool key_only;
+
   // now only used by MultiGet
   int aio_concurrency;
 
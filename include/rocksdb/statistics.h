@@ -251,6 +251,14 @@ enum Tickers : uint32_t {
 
   NO_ITERATOR_CREATED,  // number of iterators created
   NO_ITERATOR_DELETED,  // number of iterators deleted
+
+  // # of compactions put back in the queue because the table factory had no
+  // working memory to build their outputs
+  COMPACTION_BUILD_DEFERRED,
+
+  // # of merge operands folded into an existing memtable operand instead of
+  // being inserted, see fold_merge_operands.
+  NUMBER_MERGE_OPERANDS_FOLDED,
   TICKER_ENUM_MAX
 };
 
@@ -313,6 +321,11 @@ enum Histograms : uint32_t {
   PICK_GARBAGE_COLLECTION_TIME,
   INSTALL_SUPER_VERSION_TIME,
 
+  // Time table builders wait for working memory, and the number of builders
+  // already waiting when one starts to
+  TABLE_BUILD_MEMORY_WAIT_MICROS,
+  TABLE_BUILD_MEMORY_QUEUE_DEPTH,
+
   HISTOGRAM_ENUM_MAX,
 };
 
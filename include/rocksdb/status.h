@@ -76,6 +76,7 @@ class Status {
     kSpaceLimit = 8,
     kBadAlloc = 9,
     kRequireMmap = 10,
+    kBuildDeferred = 11,
     kMaxSubCode
   };
 
@@ -532,6 +532,16 @@ class TableFactory
 
   // Return if table builder need second pass iter
   virtual bool IsBuilderNeedSecondPass() const { return false; }
+
+  // Return if a compaction writing tables of about `table_size` bytes to
+  // `output_level` should start now. Factories whose builders wait for
+  // working memory return false while that memory is taken, so the
+  // compaction is retried later instead of holding a background thread.
+  // `urgent` compactions, such as those out of L0, go ahead of the others.
+  virtual bool AdmitBuild(uint64_t /*table_size*/, int /*output_level*/,
+                          bool /*urgent*/) const {
+    return true;
+  }
 };
 
 #ifndef ROCKSDB_LITE
@@ -33,6 +33,14 @@ struct OptimisticTransactionOptions {
 
   // Set index factory for WriteBatchWithIndex
   const rocksdb::WriteBatchEntryIndexFactory* index_type = nullptr;
+
+  // If true, Commit() joins the transactions of this DB that commit at the
+  // same time with group_commit set. Their conflicts are checked together
+  // against one SuperVersion and their writes go to the DB as one batch, so
+  // the group pays for a single write group and WAL sync. Otherwise each
+  // commit is written alone, since its conflict check must see the writes of
+  // the commits before it.
+  bool group_commit = false;
 };
 
 class OptimisticTransactionDB : public StackableDB {
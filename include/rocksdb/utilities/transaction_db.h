@@ -51,6 +51,15 @@ struct TransactionDBOptions {
   // mutex.
   size_t num_stripes = 16;
 
+  // Number of lock words per stripe. An exclusive lock on a key of a stripe
+  // that has no keys locked through its mutex is taken with a single
+  // compare-and-swap on the key's lock word, without the stripe mutex, as
+  // long as the transaction has no expiration and max_num_locks is not
+  // positive. Keys whose lock word is taken by another key, and all
+  // contended keys, use the stripe mutex as before.
+  // If 0, every lock goes through the stripe mutex.
+  size_t lock_words_per_stripe = 64;
+
   // If positive, specifies the default wait timeout in milliseconds when
   // a transaction attempts to lock a key if not specified by
   // TransactionOptions::lock_timeout.
@@ -45,6 +45,10 @@ enum WriteType {
 // Singleton factory instance, DO NOT delete the returned pointer
 const WriteBatchEntryIndexFactory* skip_list_WriteBatchEntryIndexFactory();
 
+// Singleton factory instance, DO NOT delete the returned pointer
+// B+tree index keeping prefix-compressed key bytes inline in its nodes
+const WriteBatchEntryIndexFactory* btree_WriteBatchEntryIndexFactory();
+
 // Singleton factory instance, DO NOT delete the returned pointer
 const WriteBatchEntryIndexFactory* patricia_WriteBatchEntryIndexFactory(
     const WriteBatchEntryIndexFactory* fallback = nullptr);
@@ -134,6 +134,8 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {NUMBER_MULTIGET_KEYS_FOUND, "rocksdb.number.multiget.keys.found"},
     {NO_ITERATOR_CREATED, "rocksdb.num.iterator.created"},
     {NO_ITERATOR_DELETED, "rocksdb.num.iterator.deleted"},
+    {COMPACTION_BUILD_DEFERRED, "rocksdb.compaction.build.deferred"},
+    {NUMBER_MERGE_OPERANDS_FOLDED, "rocksdb.number.merge.operands.folded"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -172,6 +174,8 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {PICK_COMPACTION_TIME, "rocksdb.pick.compaction.micros"},
     {PICK_GARBAGE_COLLECTION_TIME, "rocksdb.pick.gc.micros"},
     {INSTALL_SUPER_VERSION_TIME, "rocksdb.install.super.version.micros"},
+    {TABLE_BUILD_MEMORY_WAIT_MICROS, "rocksdb.table.build.memory.wait.micros"},
+    {TABLE_BUILD_MEMORY_QUEUE_DEPTH, "rocksdb.table.build.memory.queue.depth"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
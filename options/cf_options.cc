@@ -42,8 +42,10 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       pin_table_properties_in_reader(cf_options.pin_table_properties_in_reader),
       inplace_update_support(cf_options.inplace_update_support),
       inplace_callback(cf_options.inplace_callback),
+      fold_merge_operands(cf_options.fold_merge_operands),
       info_log(db_options.info_log.get()),
       statistics(db_options.statistics.get()),
+      io_heatmap(db_options.io_heatmap.get()),
       rate_limiter(db_options.rate_limiter.get()),
       info_log_level(db_options.info_log_level),
       env(db_options.env),
@@ -56,6 +58,7 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
           cf_options.table_properties_collector_factories),
       advise_random_on_open(db_options.advise_random_on_open),
       allow_mmap_populate(db_options.allow_mmap_populate),
+      numa_aware(db_options.numa_aware),
       bloom_locality(cf_options.bloom_locality),
       purge_redundant_kvs_while_flush(
           cf_options.purge_redundant_kvs_while_flush),
@@ -73,10 +76,12 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       num_levels(cf_options.num_levels),
       optimize_filters_for_hits(cf_options.optimize_filters_for_hits),
       force_consistency_checks(cf_options.force_consistency_checks),
+      temperature_aware_placement(cf_options.temperature_aware_placement),
       allow_ingest_behind(db_options.allow_ingest_behind),
       preserve_deletes(db_options.preserve_deletes),
       listeners(db_options.listeners),
       row_cache(db_options.row_cache),
+      merge_result_cache(db_options.merge_result_cache),
       memtable_insert_with_hint_prefix_extractor(
           cf_options.memtable_insert_with_hint_prefix_extractor.get()),
       cf_paths(cf_options.cf_paths) {}
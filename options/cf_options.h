@@ -58,10 +58,14 @@ struct ImmutableCFOptions {
                                    Slice delta_value,
                                    std::string* merged_value);
 
+  bool fold_merge_operands;
+
   Logger* info_log;
 
   Statistics* statistics;
 
+  IOHeatmap* io_heatmap;
+
   RateLimiter* rate_limiter;
 
   InfoLogLevel info_log_level;
@@ -87,6 +91,8 @@ struct ImmutableCFOptions {
 
   bool allow_mmap_populate;
 
+  bool numa_aware;
+
   // This options is required by PlainTableReader. May need to move it
   // to PlainTableOptions just like bloom_bits_per_key
   uint32_t bloom_locality;
@@ -115,6 +121,8 @@ struct ImmutableCFOptions {
 
   bool force_consistency_checks;
 
+  bool temperature_aware_placement;
+
   bool allow_ingest_behind;
 
   bool preserve_deletes;
@@ -125,6 +133,8 @@ struct ImmutableCFOptions {
 
   std::shared_ptr<Cache> row_cache;
 
+  std::shared_ptr<Cache> merge_result_cache;
+
   const SliceTransform* memtable_insert_with_hint_prefix_extractor;
 
   std::vector<DbPath> cf_paths;
@@ -17,6 +17,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/sst_file_manager.h"
 #include "rocksdb/wal_filter.h"
+#include "util/io_heatmap.h"
 #include "util/logging.h"
 
 namespace rocksdb {
@@ -34,6 +35,18 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       info_log(options.info_log),
       info_log_level(options.info_log_level),
       max_file_opening_threads(options.max_file_opening_threads),
+      persist_table_warm_state(options.persist_table_warm_state),
+      io_heatmap_sample_period(options.io_heatmap_sample_period),
+      numa_aware(options.numa_aware),
+      io_heatmap(options.io_heatmap_sample_period == 0
+                     ? nullptr
+                     : std::make_shared<IOHeatmap>(
+                           options.io_heatmap_sample_period)),
+      compaction_throttle_read_p99_micros(
+          options.compaction_throttle_read_p99_micros),
+      compaction_throttle_write_p99_micros(
+          options.compaction_throttle_write_p99_micros),
+      compaction_throttle_min_ratio(options.compaction_throttle_min_ratio),
       statistics(options.statistics),
       use_fsync(options.use_fsync),
       db_paths(options.db_paths),
@@ -47,6 +60,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       prepare_log_writer_num(options.prepare_log_writer_num),
       max_manifest_file_size(options.max_manifest_file_size),
       max_manifest_edit_count(options.max_manifest_edit_count),
+      max_manifest_tail_ratio(options.max_manifest_tail_ratio),
       table_cache_numshardbits(options.table_cache_numshardbits),
       wal_ttl_seconds(options.WAL_ttl_seconds),
       wal_size_limit_mb(options.WAL_size_limit_MB),
@@ -81,6 +95,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       wal_recovery_mode(options.wal_recovery_mode),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      merge_result_cache(options.merge_result_cache),
 #ifndef ROCKSDB_LITE
       wal_filter(options.wal_filter),
 #endif  // ROCKSDB_LITE
@@ -108,6 +123,20 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    info_log.get());
   ROCKS_LOG_HEADER(log, "               Options.max_file_opening_threads: %d",
                    max_file_opening_threads);
+  ROCKS_LOG_HEADER(log, "               Options.persist_table_warm_state: %d",
+                   persist_table_warm_state);
+  ROCKS_LOG_HEADER(log, "               Options.io_heatmap_sample_period: %" PRIu32,
+                   io_heatmap_sample_period);
+  ROCKS_LOG_HEADER(log, "                             Options.numa_aware: %d",
+                   numa_aware);
+  ROCKS_LOG_HEADER(log,
+                   "    Options.compaction_throttle_read_p99_micros: %" PRIu64,
+                   compaction_throttle_read_p99_micros);
+  ROCKS_LOG_HEADER(log,
+                   "   Options.compaction_throttle_write_p99_micros: %" PRIu64,
+                   compaction_throttle_write_p99_micros);
+  ROCKS_LOG_HEADER(log, "          Options.compaction_throttle_min_ratio: %f",
+                   compaction_throttle_min_ratio);
   ROCKS_LOG_HEADER(log, "                             Options.statistics: %p",
                    statistics.get());
   ROCKS_LOG_HEADER(log, "                              Options.use_fsync: %d",
@@ -121,6 +150,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "                Options.max_manifest_edit_count: %" PRIu64,
                    max_manifest_edit_count);
+  ROCKS_LOG_HEADER(log, "                Options.max_manifest_tail_ratio: %f",
+                   max_manifest_tail_ratio);
   ROCKS_LOG_HEADER(
       log, "                  Options.log_file_time_to_roll: %" ROCKSDB_PRIszt,
       log_file_time_to_roll);
@@ -227,6 +258,14 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  if (merge_result_cache) {
+    ROCKS_LOG_HEADER(
+        log, "                     Options.merge_result_cache: %" PRIu64,
+        merge_result_cache->GetCapacity());
+  } else {
+    ROCKS_LOG_HEADER(log,
+                     "                     Options.merge_result_cache: None");
+  }
 #ifndef ROCKSDB_LITE
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
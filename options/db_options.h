@@ -13,6 +13,8 @@
 
 namespace rocksdb {
 
+class IOHeatmap;
+
 struct ImmutableDBOptions {
   ImmutableDBOptions();
   explicit ImmutableDBOptions(const DBOptions& options);
@@ -29,6 +31,14 @@ struct ImmutableDBOptions {
   std::shared_ptr<Logger> info_log;
   InfoLogLevel info_log_level;
   int max_file_opening_threads;
+  bool persist_table_warm_state;
+  uint32_t io_heatmap_sample_period;
+  bool numa_aware;
+  // Shared by all column families, null if io_heatmap_sample_period is 0
+  std::shared_ptr<IOHeatmap> io_heatmap;
+  uint64_t compaction_throttle_read_p99_micros;
+  uint64_t compaction_throttle_write_p99_micros;
+  double compaction_throttle_min_ratio;
   std::shared_ptr<Statistics> statistics;
   bool use_fsync;
   std::vector<DbPath> db_paths;
@@ -43,6 +53,7 @@ struct ImmutableDBOptions {
   size_t prepare_log_writer_num;
   uint64_t max_manifest_file_size;
   uint64_t max_manifest_edit_count;
+  double max_manifest_tail_ratio;
   int table_cache_numshardbits;
   uint64_t wal_ttl_seconds;
   uint64_t wal_size_limit_mb;
@@ -74,6 +85,7 @@ struct ImmutableDBOptions {
   WALRecoveryMode wal_recovery_mode;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  std::shared_ptr<Cache> merge_result_cache;
 #ifndef ROCKSDB_LITE
   WalFilter* wal_filter;
 #endif  // ROCKSDB_LITE
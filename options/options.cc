@@ -85,9 +85,11 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       table_properties_collector_factories(
           options.table_properties_collector_factories),
       max_successive_merges(options.max_successive_merges),
+      fold_merge_operands(options.fold_merge_operands),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
       paranoid_file_checks(options.paranoid_file_checks),
       force_consistency_checks(options.force_consistency_checks),
+      temperature_aware_placement(options.temperature_aware_placement),
       report_bg_io_stats(options.report_bg_io_stats),
       ttl(options.ttl) {
   assert(memtable_factory.get() != nullptr);
@@ -343,12 +345,16 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, "                  Options.max_successive_merges: %" ROCKSDB_PRIszt,
       max_successive_merges);
+  ROCKS_LOG_HEADER(log, "                    Options.fold_merge_operands: %d",
+                   fold_merge_operands);
   ROCKS_LOG_HEADER(log, "              Options.optimize_filters_for_hits: %d",
                    optimize_filters_for_hits);
   ROCKS_LOG_HEADER(log, "                   Options.paranoid_file_checks: %d",
                    paranoid_file_checks);
   ROCKS_LOG_HEADER(log, "               Options.force_consistency_checks: %d",
                    force_consistency_checks);
+  ROCKS_LOG_HEADER(log, "            Options.temperature_aware_placement: %d",
+                   temperature_aware_placement);
   ROCKS_LOG_HEADER(log, "                     Options.report_bg_io_stats: %d",
                    report_bg_io_stats);
   ROCKS_LOG_HEADER(log, "                                    Options.ttl: %d",
@@ -564,6 +570,7 @@ ReadOptions::ReadOptions()
       prefix_same_as_start(false),
       background_purge_on_iterator_cleanup(false),
       ignore_range_deletions(false),
+      key_only(false),
       aio_concurrency(32),
       iter_start_seqnum(0) {}
 
@@ -582,6 +589,7 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       prefix_same_as_start(false),
       background_purge_on_iterator_cleanup(false),
       ignore_range_deletions(false),
+      key_only(false),
       aio_concurrency(32),
       iter_start_seqnum(0) {}
 
@@ -45,6 +45,17 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.max_open_files = mutable_db_options.max_open_files;
   options.max_file_opening_threads =
       immutable_db_options.max_file_opening_threads;
+  options.persist_table_warm_state =
+      immutable_db_options.persist_table_warm_state;
+  options.io_heatmap_sample_period =
+      immutable_db_options.io_heatmap_sample_period;
+  options.numa_aware = immutable_db_options.numa_aware;
+  options.compaction_throttle_read_p99_micros =
+      immutable_db_options.compaction_throttle_read_p99_micros;
+  options.compaction_throttle_write_p99_micros =
+      immutable_db_options.compaction_throttle_write_p99_micros;
+  options.compaction_throttle_min_ratio =
+      immutable_db_options.compaction_throttle_min_ratio;
   options.max_wal_size = mutable_db_options.max_wal_size;
   options.max_total_wal_size = mutable_db_options.max_total_wal_size;
   options.statistics = immutable_db_options.statistics;
@@ -72,6 +83,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.max_manifest_file_size = immutable_db_options.max_manifest_file_size;
   options.max_manifest_edit_count =
       immutable_db_options.max_manifest_edit_count;
+  options.max_manifest_tail_ratio =
+      immutable_db_options.max_manifest_tail_ratio;
   options.table_cache_numshardbits =
       immutable_db_options.table_cache_numshardbits;
   options.WAL_ttl_seconds = immutable_db_options.wal_ttl_seconds;
@@ -120,6 +133,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.merge_result_cache = immutable_db_options.merge_result_cache;
 #ifndef ROCKSDB_LITE
   options.wal_filter = immutable_db_options.wal_filter;
 #endif  // ROCKSDB_LITE
@@ -1515,6 +1529,24 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"max_background_flushes",
          {offsetof(struct DBOptions, max_background_flushes), OptionType::kInt,
           OptionVerificationType::kNormal, false, 0}},
+        {"persist_table_warm_state",
+         {offsetof(struct DBOptions, persist_table_warm_state),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"io_heatmap_sample_period",
+         {offsetof(struct DBOptions, io_heatmap_sample_period),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
+        {"numa_aware",
+         {offsetof(struct DBOptions, numa_aware), OptionType::kBoolean,
+          OptionVerificationType::kNormal, false, 0}},
+        {"compaction_throttle_read_p99_micros",
+         {offsetof(struct DBOptions, compaction_throttle_read_p99_micros),
+          OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
+        {"compaction_throttle_write_p99_micros",
+         {offsetof(struct DBOptions, compaction_throttle_write_p99_micros),
+          OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
+        {"compaction_throttle_min_ratio",
+         {offsetof(struct DBOptions, compaction_throttle_min_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal, false, 0}},
         {"max_file_opening_threads",
          {offsetof(struct DBOptions, max_file_opening_threads),
           OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
@@ -1581,6 +1613,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"max_manifest_edit_count",
          {offsetof(struct DBOptions, max_manifest_edit_count),
           OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
+        {"max_manifest_tail_ratio",
+         {offsetof(struct DBOptions, max_manifest_tail_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal, false, 0}},
         {"max_wal_size",
          {offsetof(struct DBOptions, max_wal_size), OptionType::kUInt64T,
           OptionVerificationType::kNormal, true,
@@ -1823,6 +1858,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"inplace_update_support",
          {offset_of(&ColumnFamilyOptions::inplace_update_support),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"fold_merge_operands",
+         {offset_of(&ColumnFamilyOptions::fold_merge_operands),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"level_compaction_dynamic_level_bytes",
          {offset_of(&ColumnFamilyOptions::level_compaction_dynamic_level_bytes),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -1836,6 +1874,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"force_consistency_checks",
          {offset_of(&ColumnFamilyOptions::force_consistency_checks),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"temperature_aware_placement",
+         {offset_of(&ColumnFamilyOptions::temperature_aware_placement),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"purge_redundant_kvs_while_flush",
          {offset_of(&ColumnFamilyOptions::purge_redundant_kvs_while_flush),
           OptionType::kBoolean, OptionVerificationType::kDeprecated, false, 0}},
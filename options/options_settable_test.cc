@@ -199,6 +199,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
       {offsetof(struct DBOptions, listeners),
        sizeof(std::vector<std::shared_ptr<EventListener>>)},
       {offsetof(struct DBOptions, row_cache), sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, merge_result_cache),
+       sizeof(std::shared_ptr<Cache>)},
       {offsetof(struct DBOptions, metrics_reporter_factory), sizeof(std::shared_ptr<MetricsReporterFactory>)},
       {offsetof(struct DBOptions, wal_filter), sizeof(const WalFilter*)},
   };
@@ -239,6 +241,12 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "table_cache_numshardbits=28;"
                              "max_open_files=72;"
                              "max_file_opening_threads=35;"
+                             "persist_table_warm_state=false;"
+                             "io_heatmap_sample_period=4;"
+                             "numa_aware=false;"
+                             "compaction_throttle_read_p99_micros=1000;"
+                             "compaction_throttle_write_p99_micros=2000;"
+                             "compaction_throttle_min_ratio=0.25;"
                              "max_background_jobs=8;"
                              "base_background_compactions=3;"
                              "max_background_compactions=33;"
@@ -253,6 +261,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "skip_stats_update_on_db_open=false;"
                              "max_manifest_file_size=4295009941;"
                              "max_manifest_edit_count=429500994;"
+                             "max_manifest_tail_ratio=4.5;"
                              "db_log_dir=path/to/db_log_dir;"
                              "skip_log_error_on_recovery=true;"
                              "use_aio_reads=true;"
@@ -448,12 +457,14 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "memtable_insert_with_hint_prefix_extractor=rocksdb.CappedPrefix.13;"
       "paranoid_file_checks=true;"
       "force_consistency_checks=true;"
+      "temperature_aware_placement=true;"
       "inplace_update_num_locks=7429;"
       "optimize_filters_for_hits=false;"
       "level_compaction_dynamic_level_bytes=false;"
       "enable_lazy_compaction=true;"
       "pin_table_properties_in_reader=false;"
       "inplace_update_support=true;"
+      "fold_merge_operands=true;"
       "compaction_style=kCompactionStyleFIFO;"
       "compaction_pri=kMinOverlappingRatio;"
       "hard_pending_compaction_bytes_limit=0;"
@@ -14,6 +14,7 @@ LIB_SOURCES =                                                   \
   db/compaction_picker.cc                                       \
   db/compaction_picker_fifo.cc                                  \
   db/compaction_picker_universal.cc                             \
+  db/compaction_throttler.cc                                    \
   db/compaction_dispatcher.cc                                   \
   db/convenience.cc                                             \
   db/db_filesnapshot.cc                                         \
@@ -158,11 +159,13 @@ LIB_SOURCES =                                                   \
   util/filename.cc                                              \
   util/filter_policy.cc                                         \
   util/hash.cc                                                  \
+  util/io_heatmap.cc                                            \
   util/iterator_cache.cc                                        \
   util/jemalloc_nodump_allocator.cc                             \
   util/lazy_buffer.cc                                           \
   util/log_buffer.cc                                            \
   util/murmurhash.cc                                            \
+  util/numa_util.cc                                             \
   util/random.cc                                                \
   util/rate_limiter.cc                                          \
   util/slice.cc                                                 \
@@ -234,6 +237,7 @@ LIB_SOURCES =                                                   \
   utilities/transactions/write_unprepared_txn.cc                \
   utilities/transactions/write_unprepared_txn_db.cc             \
   utilities/ttl/db_ttl_impl.cc                                  \
+  utilities/write_batch_with_index/write_batch_entry_btree_index.cc    \
   utilities/write_batch_with_index/write_batch_with_index.cc    \
   utilities/write_batch_with_index/write_batch_with_index_internal.cc    \
 
@@ -377,6 +381,7 @@ MAIN_SOURCES =                                                          \
   table/data_block_hash_index_test.cc                                   \
   table/full_filter_block_test.cc                                       \
   table/merger_test.cc                                                  \
+  table/merging_iterator_bench.cc                                       \
   table/sst_file_reader_test.cc                                         \
   table/table_reader_bench.cc                                           \
   table/table_test.cc                                                   \
@@ -434,8 +439,10 @@ MAIN_SOURCES =                                                          \
   utilities/transactions/optimistic_transaction_test.cc                 \
   utilities/transactions/transaction_test.cc                            \
   utilities/transactions/write_prepared_transaction_test.cc             \
+  utilities/transactions/write_prepared_txn_db_bench.cc                 \
   utilities/transactions/write_unprepared_transaction_test.cc           \
   utilities/ttl/ttl_test.cc                                             \
+  utilities/write_batch_with_index/write_batch_with_index_bench.cc      \
   utilities/write_batch_with_index/write_batch_with_index_test.cc       \
 
 JNI_NATIVE_SOURCES =                                          \
@@ -2855,6 +2855,36 @@ uint64_t BlockBasedTable::ApproximateOffsetOf(const Slice& key) {
   return result;
 }
 
+Status BlockBasedTable::GetKeyAnchors(size_t num_anchors,
+                                      std::vector<std::string>* anchors) {
+  uint64_t num_blocks = rep_->table_properties_base.num_data_blocks;
+  // The index key of the last block ends the table, it is no anchor
+  num_anchors = static_cast<size_t>(
+      std::min<uint64_t>(num_anchors, num_blocks > 0 ? num_blocks - 1 : 0));
+  if (num_anchors == 0) {
+    return Status::OK();
+  }
+  std::unique_ptr<InternalIteratorBase<BlockHandle>> index_iter(
+      NewIndexIterator(ReadOptions(), true /* disable prefix seek */));
+  bool is_user_key = rep_->table_properties_base.index_key_is_user_key > 0;
+  // Not below 1, so every anchor ends a different block
+  double stride = double(num_blocks) / (num_anchors + 1);
+  size_t k = 1;
+  uint64_t i = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid() && k <= num_anchors;
+       index_iter->Next(), ++i) {
+    if (i + 1 == static_cast<uint64_t>(k * stride)) {
+      Slice key = index_iter->key();
+      if (!is_user_key) {
+        key = ExtractUserKey(key);
+      }
+      anchors->emplace_back(key.data(), key.size());
+      ++k;
+    }
+  }
+  return index_iter->status();
+}
+
 bool BlockBasedTable::TEST_filter_block_preloaded() const {
   return rep_->filter != nullptr;
 }
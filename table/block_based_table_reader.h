@@ -135,6 +135,10 @@ class BlockBasedTable : public TableReader {
   // be close to the file length.
   uint64_t ApproximateOffsetOf(const Slice& key) override;
 
+  // Picks index keys at evenly spaced data blocks
+  Status GetKeyAnchors(size_t num_anchors,
+                       std::vector<std::string>* anchors) override;
+
   // Returns true if the block for the specified key is in cache.
   // REQUIRES: key is in this table && block cache enabled
   bool TEST_KeyInCache(const ReadOptions& options, const Slice& key);
@@ -277,6 +277,11 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
           }
           return Finish();
         }
+        if (merge_context_->LookupResult(user_key_, parsed_key.sequence,
+                                         lazy_val_)) {
+          state_ = kFound;
+          return Finish();
+        }
         state_ = kMerge;
         merge_context_->PushOperand(std::move(value));
         if (merge_operator_ != nullptr &&
@@ -6,11 +6,91 @@
 
 #pragma once
 
+#include <string.h>
+#include <string>
+
 #include "db/dbformat.h"
+#include "port/port.h"
 #include "table/iterator_wrapper.h"
 
 namespace rocksdb {
 
+// Heap element used by MergingIterator. `prefix` caches the 8 bytes of the
+// child's current user key that follow the prefix shared by all children,
+// encoded so that unsigned integer order agrees with the user comparator.
+// Two cached entries with different prefixes are ordered without calling
+// into the comparator; equal prefixes, or a key that does not start with the
+// shared prefix, fall back to a full InternalKeyComparator::Compare. The
+// merging iterator shrinks the shared prefix when a key leaves it, so in
+// practice all entries of its heap are cached.
+struct IteratorHeapItem {
+  uint64_t prefix;
+  IteratorWrapper* iter;
+  bool cached;
+};
+
+// Computes IteratorHeapItem::prefix. Only bytewise and reverse bytewise user
+// comparators have a usable prefix order, all other comparators get no
+// cached prefix so every comparison goes through the comparator.
+class IteratorKeyPrefixEncoder {
+ public:
+  explicit IteratorKeyPrefixEncoder(const InternalKeyComparator* comparator)
+      : mode_(kNone) {
+    const Comparator* ucmp = comparator->user_comparator();
+    if (ucmp == BytewiseComparator()) {
+      mode_ = kBytewise;
+    } else if (ucmp == ReverseBytewiseComparator()) {
+      mode_ = kReverseBytewise;
+    }
+  }
+
+  bool enabled() const { return mode_ != kNone; }
+
+  // Bytes skipped before the cached 8 bytes. Keys sharing a long prefix,
+  // such as table or row prefixes, would otherwise all tie on their first
+  // 8 bytes.
+  void SetSharedPrefix(const Slice& user_key_prefix) {
+    shared_.assign(user_key_prefix.data(), user_key_prefix.size());
+  }
+
+  // 8 bytes of the user key after the shared prefix as a big endian integer,
+  // zero padded when the user key is shorter. Zero padding keeps the order
+  // correct: a shorter key never gets a larger prefix than a key it is a
+  // prefix of.
+  IteratorHeapItem Make(IteratorWrapper* iter) const {
+    if (mode_ == kNone) {
+      return IteratorHeapItem{0, iter, false};
+    }
+    Slice internal_key = iter->key();
+    assert(internal_key.size() >= 8);
+    size_t n = internal_key.size() - 8;
+    if (n < shared_.size() ||
+        memcmp(internal_key.data(), shared_.data(), shared_.size()) != 0) {
+      return IteratorHeapItem{0, iter, false};
+    }
+    n -= shared_.size();
+    uint64_t v = 0;
+    memcpy(&v, internal_key.data() + shared_.size(), n < 8 ? n : 8);
+    if (port::kLittleEndian) {
+      v = ByteSwap(v);
+    }
+    return IteratorHeapItem{mode_ == kBytewise ? v : ~v, iter, true};
+  }
+
+ private:
+  static uint64_t ByteSwap(uint64_t v) {
+#if defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    return __builtin_bswap64(v);
+#endif
+  }
+
+  enum Mode { kNone, kBytewise, kReverseBytewise };
+  Mode mode_;
+  std::string shared_;
+};
+
 // When used with std::priority_queue, this comparison functor puts the
 // iterator with the max/largest key on top.
 class MaxIteratorComparator {
@@ -21,6 +101,14 @@ class MaxIteratorComparator {
   bool operator()(IteratorWrapper* a, IteratorWrapper* b) const {
     return comparator_->Compare(a->key(), b->key()) < 0;
   }
+
+  bool operator()(const IteratorHeapItem& a, const IteratorHeapItem& b) const {
+    if (a.cached && b.cached && a.prefix != b.prefix) {
+      return a.prefix < b.prefix;
+    }
+    return comparator_->Compare(a.iter->key(), b.iter->key()) < 0;
+  }
+
  private:
   const InternalKeyComparator* comparator_;
 };
@@ -35,6 +123,14 @@ class MinIteratorComparator {
   bool operator()(IteratorWrapper* a, IteratorWrapper* b) const {
     return comparator_->Compare(a->key(), b->key()) > 0;
   }
+
+  bool operator()(const IteratorHeapItem& a, const IteratorHeapItem& b) const {
+    if (a.cached && b.cached && a.prefix != b.prefix) {
+      return a.prefix > b.prefix;
+    }
+    return comparator_->Compare(a.iter->key(), b.iter->key()) > 0;
+  }
+
  private:
   const InternalKeyComparator* comparator_;
 };
@@ -3,9 +3,12 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 
+#include <algorithm>
 #include <vector>
 #include <string>
 
+#include "rocksdb/perf_context.h"
+#include "rocksdb/perf_level.h"
 #include "table/merging_iterator.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
@@ -172,6 +175,190 @@ TEST_F(MergerTest, SeekToLastTest) {
   }
 }
 
+// Keys of varying length sharing leading bytes, so the cached key prefixes in
+// the merge heap tie, pad short keys with zeros, or differ in byte order.
+TEST_F(MergerTest, CachedKeyPrefixOrder) {
+  for (auto ucmp : {BytewiseComparator(), ReverseBytewiseComparator()}) {
+    InternalKeyComparator icmp(ucmp);
+    auto cmp = [&icmp](const std::string& a, const std::string& b) {
+      return icmp.Compare(a, b) < 0;
+    };
+    std::vector<std::string> all;
+    std::vector<InternalIterator*> children;
+    SequenceNumber seq = 1;
+    for (int i = 0; i < 20; ++i) {
+      std::vector<std::string> keys;
+      for (int j = 0; j < 100; ++j) {
+        std::string user_key = "prefix";
+        int len = rnd_.Uniform(12);
+        for (int k = 0; k < len; ++k) {
+          user_key.push_back(static_cast<char>(rnd_.Uniform(3)));
+        }
+        InternalKey ik(user_key, seq++, ValueType::kTypeValue);
+        keys.push_back(ik.Encode().ToString());
+      }
+      std::sort(keys.begin(), keys.end(), cmp);
+      all.insert(all.end(), keys.begin(), keys.end());
+      children.push_back(new test::VectorIterator(
+          keys, std::vector<std::string>(keys.size())));
+    }
+    std::sort(all.begin(), all.end(), cmp);
+
+    std::unique_ptr<InternalIterator> iter(NewMergingIterator(
+        &icmp, children.data(), static_cast<int>(children.size())));
+    size_t pos = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_LT(pos, all.size());
+      ASSERT_EQ(all[pos++], iter->key().ToString());
+    }
+    ASSERT_EQ(all.size(), pos);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      ASSERT_GT(pos, 0U);
+      ASSERT_EQ(all[--pos], iter->key().ToString());
+    }
+    ASSERT_EQ(0U, pos);
+  }
+}
+
+// test::VectorIterator seeks by comparing the encoded internal keys bytewise,
+// which doesn't match the internal key order when user keys differ in
+// length or the user comparator isn't bytewise.
+class InternalKeyVectorIterator : public InternalIterator {
+ public:
+  InternalKeyVectorIterator(const InternalKeyComparator* icmp,
+                            const std::vector<std::string>& keys)
+      : cmp_{icmp}, keys_(keys), current_(keys.size()) {
+    std::sort(keys_.begin(), keys_.end(), cmp_);
+  }
+
+  bool Valid() const override { return current_ < keys_.size(); }
+  void SeekToFirst() override { current_ = 0; }
+  void SeekToLast() override { current_ = keys_.size() - 1; }
+  void Seek(const Slice& target) override {
+    current_ = std::lower_bound(keys_.begin(), keys_.end(),
+                                target.ToString(), cmp_) -
+               keys_.begin();
+  }
+  void SeekForPrev(const Slice& target) override {
+    current_ = std::upper_bound(keys_.begin(), keys_.end(),
+                                target.ToString(), cmp_) -
+               keys_.begin() - 1;
+  }
+  void Next() override { current_++; }
+  void Prev() override { current_--; }
+  Slice key() const override { return keys_[current_]; }
+  LazyBuffer value() const override { return LazyBuffer(); }
+  Status status() const override { return Status::OK(); }
+
+ private:
+  struct Compare {
+    const InternalKeyComparator* icmp;
+    bool operator()(const std::string& a, const std::string& b) const {
+      return icmp->Compare(a, b) < 0;
+    }
+  };
+  Compare cmp_;
+  std::vector<std::string> keys_;
+  size_t current_;
+};
+
+// Children whose keys share a long prefix, so the cached key prefixes skip
+// it, mixed with keys that diverge inside that prefix and can not use the
+// cache. Seeks in the middle learn the shared prefix from fewer keys.
+TEST_F(MergerTest, CachedKeyPrefixAfterSharedPrefix) {
+  for (auto ucmp : {BytewiseComparator(), ReverseBytewiseComparator()}) {
+    InternalKeyComparator icmp(ucmp);
+    auto cmp = [&icmp](const std::string& a, const std::string& b) {
+      return icmp.Compare(a, b) < 0;
+    };
+    std::vector<std::string> all;
+    std::vector<InternalIterator*> children;
+    SequenceNumber seq = 1;
+    for (int i = 0; i < 10; ++i) {
+      std::vector<std::string> keys;
+      for (int j = 0; j < 100; ++j) {
+        std::string user_key =
+            rnd_.OneIn(10) ? "table/row" : "table/row/col/";
+        int len = rnd_.Uniform(12);
+        for (int k = 0; k < len; ++k) {
+          user_key.push_back(static_cast<char>(rnd_.Uniform(3)));
+        }
+        InternalKey ik(user_key, seq++, ValueType::kTypeValue);
+        keys.push_back(ik.Encode().ToString());
+      }
+      all.insert(all.end(), keys.begin(), keys.end());
+      children.push_back(new InternalKeyVectorIterator(&icmp, keys));
+    }
+    std::sort(all.begin(), all.end(), cmp);
+
+    std::unique_ptr<InternalIterator> iter(NewMergingIterator(
+        &icmp, children.data(), static_cast<int>(children.size())));
+    for (size_t start : {size_t(0), all.size() / 3, all.size() / 2}) {
+      size_t pos = start;
+      for (iter->Seek(all[start]); iter->Valid(); iter->Next()) {
+        ASSERT_LT(pos, all.size());
+        ASSERT_EQ(all[pos++], iter->key().ToString());
+      }
+      ASSERT_EQ(all.size(), pos);
+      pos = start + 1;
+      for (iter->SeekForPrev(all[start]); iter->Valid(); iter->Prev()) {
+        ASSERT_GT(pos, 0U);
+        ASSERT_EQ(all[--pos], iter->key().ToString());
+      }
+      ASSERT_EQ(0U, pos);
+    }
+  }
+}
+
+// A long scan leaves the prefix its children shared when it started. The
+// shared prefix shrinks with it, so the heap keeps ordering children by
+// their cached key prefixes instead of calling the comparator.
+TEST_F(MergerTest, CachedKeyPrefixStaysCachedOnLongScan) {
+  const int kNumChildren = 10;
+  const int kNumKeys = 20000;
+  for (auto ucmp : {BytewiseComparator(), ReverseBytewiseComparator()}) {
+    InternalKeyComparator icmp(ucmp);
+    std::vector<std::string> all;
+    std::vector<std::vector<std::string>> keys(kNumChildren);
+    for (int i = 0; i < kNumKeys; ++i) {
+      char user_key[32];
+      snprintf(user_key, sizeof(user_key), "table/row/%012d", i);
+      InternalKey ik(user_key, 1, ValueType::kTypeValue);
+      all.push_back(ik.Encode().ToString());
+      keys[i % kNumChildren].push_back(all.back());
+    }
+    auto cmp = [&icmp](const std::string& a, const std::string& b) {
+      return icmp.Compare(a, b) < 0;
+    };
+    std::sort(all.begin(), all.end(), cmp);
+    std::vector<InternalIterator*> children;
+    for (auto& child_keys : keys) {
+      children.push_back(new InternalKeyVectorIterator(&icmp, child_keys));
+    }
+    std::unique_ptr<InternalIterator> iter(
+        NewMergingIterator(&icmp, children.data(), kNumChildren));
+
+    SetPerfLevel(kEnableCount);
+    iter->SeekToFirst();
+    get_perf_context()->Reset();
+    size_t pos = 0;
+    for (; iter->Valid(); iter->Next()) {
+      ASSERT_EQ(all[pos++], iter->key().ToString());
+    }
+    ASSERT_EQ(all.size(), pos);
+    ASSERT_LT(get_perf_context()->user_key_comparison_count, kNumKeys / 10);
+
+    iter->SeekToLast();
+    get_perf_context()->Reset();
+    for (; iter->Valid(); iter->Prev()) {
+      ASSERT_EQ(all[--pos], iter->key().ToString());
+    }
+    ASSERT_EQ(0U, pos);
+    ASSERT_LT(get_perf_context()->user_key_comparison_count, kNumKeys / 10);
+    SetPerfLevel(kDisable);
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -29,8 +29,8 @@
 namespace rocksdb {
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
-typedef BinaryHeap<IteratorWrapper*, MaxIteratorComparator> MergerMaxIterHeap;
-typedef BinaryHeap<IteratorWrapper*, MinIteratorComparator> MergerMinIterHeap;
+typedef BinaryHeap<IteratorHeapItem, MaxIteratorComparator> MergerMaxIterHeap;
+typedef BinaryHeap<IteratorHeapItem, MinIteratorComparator> MergerMinIterHeap;
 }  // namespace
 
 const size_t kNumIterReserve = 4;
@@ -44,6 +44,7 @@ class MergingIterator : public InternalIterator {
         comparator_(comparator),
         current_(nullptr),
         direction_(kForward),
+        prefix_encoder_(comparator_),
         minHeap_(comparator_),
         prefix_seek_mode_(prefix_seek_mode) {
     children_.resize(n);
@@ -51,13 +52,11 @@ class MergingIterator : public InternalIterator {
       children_[i].Set(children[i]);
     }
     for (auto& child : children_) {
-      if (child.Valid()) {
-        assert(child.status().ok());
-        minHeap_.push(&child);
-      } else {
+      if (!child.Valid()) {
         considerStatus(child.status());
       }
     }
+    PushChildren(&minHeap_);
     current_ = CurrentForward();
   }
 
@@ -73,7 +72,7 @@ class MergingIterator : public InternalIterator {
     auto new_wrapper = children_.back();
     if (new_wrapper.Valid()) {
       assert(new_wrapper.status().ok());
-      minHeap_.push(&new_wrapper);
+      minHeap_.push(prefix_encoder_.Make(&new_wrapper));
       current_ = CurrentForward();
     } else {
       considerStatus(new_wrapper.status());
@@ -97,13 +96,11 @@ class MergingIterator : public InternalIterator {
     status_ = Status::OK();
     for (auto& child : children_) {
       child.SeekToFirst();
-      if (child.Valid()) {
-        assert(child.status().ok());
-        minHeap_.push(&child);
-      } else {
+      if (!child.Valid()) {
         considerStatus(child.status());
       }
     }
+    PushChildren(&minHeap_);
     direction_ = kForward;
     current_ = CurrentForward();
   }
@@ -114,13 +111,11 @@ class MergingIterator : public InternalIterator {
     status_ = Status::OK();
     for (auto& child : children_) {
       child.SeekToLast();
-      if (child.Valid()) {
-        assert(child.status().ok());
-        maxHeap_->push(&child);
-      } else {
+      if (!child.Valid()) {
         considerStatus(child.status());
       }
     }
+    PushChildren(maxHeap_.get());
     direction_ = kReverse;
     current_ = CurrentReverse();
   }
@@ -135,17 +130,14 @@ class MergingIterator : public InternalIterator {
       }
       PERF_COUNTER_ADD(seek_child_seek_count, 1);
 
-      if (child.Valid()) {
-        assert(child.status().ok());
-        PERF_TIMER_GUARD(seek_min_heap_time);
-        minHeap_.push(&child);
-      } else {
+      if (!child.Valid()) {
         considerStatus(child.status());
       }
     }
     direction_ = kForward;
     {
       PERF_TIMER_GUARD(seek_min_heap_time);
+      PushChildren(&minHeap_);
       current_ = CurrentForward();
     }
   }
@@ -162,17 +154,14 @@ class MergingIterator : public InternalIterator {
       }
       PERF_COUNTER_ADD(seek_child_seek_count, 1);
 
-      if (child.Valid()) {
-        assert(child.status().ok());
-        PERF_TIMER_GUARD(seek_max_heap_time);
-        maxHeap_->push(&child);
-      } else {
+      if (!child.Valid()) {
         considerStatus(child.status());
       }
     }
     direction_ = kReverse;
     {
       PERF_TIMER_GUARD(seek_max_heap_time);
+      PushChildren(maxHeap_.get());
       current_ = CurrentReverse();
     }
   }
@@ -200,9 +189,12 @@ class MergingIterator : public InternalIterator {
     if (current_->Valid()) {
       // current is still valid after the Next() call above.  Call
       // replace_top() to restore the heap property.  When the same child
-      // iterator yields a sequence of keys, this is cheap.
+      // iterator yields a sequence of keys, this is cheap: the heap caches
+      // the smaller child of the root, so it takes a single comparison,
+      // which the cached key prefix usually settles without calling into
+      // the comparator.
       assert(current_->status().ok());
-      minHeap_.replace_top(current_);
+      ReplaceTop(&minHeap_);
     } else {
       // current stopped being valid, remove it from the heap.
       considerStatus(current_->status());
@@ -233,11 +225,8 @@ class MergingIterator : public InternalIterator {
             considerStatus(child.status());
           }
         }
-        if (child.Valid()) {
-          assert(child.status().ok());
-          maxHeap_->push(&child);
-        }
       }
+      PushChildren(maxHeap_.get());
       direction_ = kReverse;
       if (!prefix_seek_mode_) {
         // Note that we don't do assert(current_ == CurrentReverse()) here
@@ -261,7 +250,7 @@ class MergingIterator : public InternalIterator {
       // replace_top() to restore the heap property.  When the same child
       // iterator yields a sequence of keys, this is cheap.
       assert(current_->status().ok());
-      maxHeap_->replace_top(current_);
+      ReplaceTop(maxHeap_.get());
     } else {
       // current stopped being valid, remove it from the heap.
       considerStatus(current_->status());
@@ -286,6 +275,15 @@ class MergingIterator : public InternalIterator {
   // Ensures that maxHeap_ is initialized when starting to go in the reverse
   // direction
   void InitMaxHeap();
+  // Pushes the valid children into the heap, after taking the prefix shared
+  // by their keys as the bytes the cached key prefixes skip
+  template <class Heap>
+  void PushChildren(Heap* heap);
+  // Replaces the top of the heap with current_. Once current_ leaves the
+  // shared prefix the heap is rebuilt around a shorter one, so that a long
+  // scan keeps every entry cached
+  template <class Heap>
+  void ReplaceTop(Heap* heap);
 
   bool is_arena_mode_;
   const InternalKeyComparator* comparator_;
@@ -300,6 +298,7 @@ class MergingIterator : public InternalIterator {
   // Which direction is the iterator moving?
   enum Direction { kForward, kReverse };
   Direction direction_;
+  IteratorKeyPrefixEncoder prefix_encoder_;
   MergerMinIterHeap minHeap_;
   bool prefix_seek_mode_;
 
@@ -311,13 +310,13 @@ class MergingIterator : public InternalIterator {
 
   IteratorWrapper* CurrentForward() const {
     assert(direction_ == kForward);
-    return !minHeap_.empty() ? minHeap_.top() : nullptr;
+    return !minHeap_.empty() ? minHeap_.top().iter : nullptr;
   }
 
   IteratorWrapper* CurrentReverse() const {
     assert(direction_ == kReverse);
     assert(maxHeap_);
-    return !maxHeap_->empty() ? maxHeap_->top() : nullptr;
+    return !maxHeap_->empty() ? maxHeap_->top().iter : nullptr;
   }
 };
 
@@ -335,11 +334,49 @@ void MergingIterator::SwitchToForward() {
         considerStatus(child.status());
       }
     }
+  }
+  PushChildren(&minHeap_);
+  direction_ = kForward;
+}
+
+template <class Heap>
+void MergingIterator::ReplaceTop(Heap* heap) {
+  IteratorHeapItem item = prefix_encoder_.Make(current_);
+  if (item.cached || !prefix_encoder_.enabled()) {
+    heap->replace_top(item);
+  } else {
+    // Every valid child is in the heap. The prefix only shrinks here, at
+    // most once per byte of it between two seeks
+    heap->clear();
+    PushChildren(heap);
+  }
+}
+
+template <class Heap>
+void MergingIterator::PushChildren(Heap* heap) {
+  if (prefix_encoder_.enabled()) {
+    Slice shared;
+    bool first = true;
+    for (auto& child : children_) {
+      if (child.Valid()) {
+        Slice user_key = ExtractUserKey(child.key());
+        if (first) {
+          shared = user_key;
+          first = false;
+        } else {
+          shared.remove_suffix(shared.size() -
+                               shared.difference_offset(user_key));
+        }
+      }
+    }
+    prefix_encoder_.SetSharedPrefix(shared);
+  }
+  for (auto& child : children_) {
     if (child.Valid()) {
-      minHeap_.push(&child);
+      assert(child.status().ok());
+      heap->push(prefix_encoder_.Make(&child));
     }
   }
-  direction_ = kForward;
 }
 
 void MergingIterator::ClearHeaps() {
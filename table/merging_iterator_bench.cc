@@ -0,0 +1,153 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/env.h"
+#include "rocksdb/perf_context.h"
+#include "rocksdb/perf_level.h"
+#include "table/merging_iterator.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testutil.h"
+
+#include "util/gflags_compat.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+
+DEFINE_int32(num_runs, 20, "number of sorted runs (children) to merge");
+
+DEFINE_int64(keys_per_run, 100000, "number of keys in each sorted run");
+
+DEFINE_string(key_prefix_lens, "0,32",
+              "comma separated lengths of the prefix shared by all keys, each "
+              "is benchmarked. Short ones compare like random keys, long ones "
+              "simulate table/row prefixes");
+
+DEFINE_int32(run_length, 1,
+             "number of consecutive keys taken from the same run, larger "
+             "values exercise the path where the top child stays the minimum");
+
+DEFINE_int32(iterations, 5, "number of full scans to time");
+
+DEFINE_bool(reverse, false, "scan backward instead of forward");
+
+DEFINE_bool(reverse_comparator, false,
+            "use ReverseBytewiseComparator as the user comparator");
+
+DEFINE_int32(seed, 301, "random number generator seed");
+
+namespace rocksdb {
+
+namespace {
+
+// Builds `FLAGS_num_runs` runs of fixed length user keys sharing a prefix of
+// `prefix_len` bytes. Keys are assigned to
+// runs in groups of `FLAGS_run_length` so runs interleave like overlapping L0
+// files or sorted runs of a universal compaction.
+std::vector<std::vector<std::string>> GenerateRuns(
+    const InternalKeyComparator& icmp, size_t prefix_len) {
+  Random64 rnd(FLAGS_seed);
+  std::vector<std::vector<std::string>> runs(FLAGS_num_runs);
+  std::string prefix(prefix_len, 'k');
+  uint64_t total = uint64_t(FLAGS_num_runs) * FLAGS_keys_per_run;
+  size_t run = 0;
+  for (uint64_t i = 0; i < total; ++i) {
+    if (i % FLAGS_run_length == 0) {
+      run = rnd.Uniform(FLAGS_num_runs);
+    }
+    char buf[32];
+    snprintf(buf, sizeof buf, "%016" PRIu64, i);
+    InternalKey ik(prefix + buf, rnd.Uniform(1000) + 1, kTypeValue);
+    runs[run].push_back(ik.Encode().ToString());
+  }
+  for (auto& keys : runs) {
+    std::sort(keys.begin(), keys.end(),
+              [&icmp](const std::string& a, const std::string& b) {
+                return icmp.Compare(a, b) < 0;
+              });
+  }
+  return runs;
+}
+
+}  // anonymous namespace
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_num_runs <= 0 || FLAGS_keys_per_run <= 0 || FLAGS_run_length <= 0) {
+    fprintf(stderr, "num_runs, keys_per_run and run_length must be positive\n");
+    return 1;
+  }
+
+  rocksdb::InternalKeyComparator icmp(
+      FLAGS_reverse_comparator ? rocksdb::ReverseBytewiseComparator()
+                               : rocksdb::BytewiseComparator());
+  rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableCount);
+  rocksdb::Env* env = rocksdb::Env::Default();
+  for (auto& len : rocksdb::StringSplit(FLAGS_key_prefix_lens, ',')) {
+    size_t prefix_len = rocksdb::ParseSizeT(len);
+    auto runs = rocksdb::GenerateRuns(icmp, prefix_len);
+    std::vector<rocksdb::InternalIterator*> children;
+    for (auto& keys : runs) {
+      // The two-argument constructor keeps the internal key order computed
+      // above instead of re-sorting by bytes.
+      children.push_back(new rocksdb::test::VectorIterator(
+          keys, std::vector<std::string>(keys.size())));
+    }
+    std::unique_ptr<rocksdb::InternalIterator> iter(
+        rocksdb::NewMergingIterator(&icmp, children.data(),
+                                    static_cast<int>(children.size())));
+
+    fprintf(stdout, "key_prefix_len %zd:\n", prefix_len);
+    uint64_t total_keys = 0;
+    uint64_t total_nanos = 0;
+    for (int i = 0; i < FLAGS_iterations; ++i) {
+      rocksdb::get_perf_context()->Reset();
+      uint64_t start = env->NowNanos();
+      uint64_t count = 0;
+      if (FLAGS_reverse) {
+        for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+          ++count;
+        }
+      } else {
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+          ++count;
+        }
+      }
+      uint64_t elapsed = env->NowNanos() - start;
+      total_keys += count;
+      total_nanos += elapsed;
+      fprintf(stdout,
+              "  iteration %d: %" PRIu64 " keys, %.1f ns/key, %.2f user key "
+              "comparisons/key\n",
+              i, count, double(elapsed) / std::max<uint64_t>(count, 1),
+              double(rocksdb::get_perf_context()->user_key_comparison_count) /
+                  std::max<uint64_t>(count, 1));
+    }
+    fprintf(stdout, "  average: %.1f ns/key, %.2f Mkeys/s\n",
+            double(total_nanos) / std::max<uint64_t>(total_keys, 1),
+            total_nanos == 0 ? 0.0 : total_keys * 1e3 / total_nanos);
+  }
+  return 0;
+}
+
+#endif  // GFLAGS
@@ -119,6 +119,8 @@ struct TableBuilderOptions {
   const SstPurpose sst_purpose;
   Slice smallest_user_key;
   Slice largest_user_key;
+  // Flushes and compactions out of L0, which hold up writes
+  bool urgent = false;
 
   void PushIntTblPropCollectors(
       std::vector<std::unique_ptr<IntTblPropCollector>>* collectors,
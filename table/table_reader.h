@@ -9,6 +9,8 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
 #include "db/range_tombstone_fragmenter.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/slice_transform.h"
@@ -60,6 +62,15 @@ class TableReader {
   // be close to the file length.
   virtual uint64_t ApproximateOffsetOf(const Slice& key) = 0;
 
+  // Appends up to `num_anchors` user keys to *anchors, in ascending order,
+  // that split the table into pieces of about the same size. Used to spread
+  // subcompactions over large input files. Returns NotSupported if the table
+  // can't find them without reading its data.
+  virtual Status GetKeyAnchors(size_t /*num_anchors*/,
+                               std::vector<std::string>* /*anchors*/) {
+    return Status::NotSupported();
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -298,6 +298,9 @@ bool TerarkZipCFOptionsFromEnv(ColumnFamilyOptions& cfo,
   if (const char* env = getenv("TerarkZipTable_indexType")) {
     tzo.indexType = env;
   }
+  if (const char* env = getenv("TerarkZipTable_memTempDir")) {
+    tzo.memTempDir = env;
+  }
 
   MyOverrideInt(tzo, checksumLevel);
   MyOverrideInt(tzo, checksumSmallValSize);
@@ -333,6 +336,7 @@ bool TerarkZipCFOptionsFromEnv(ColumnFamilyOptions& cfo,
   MyOverrideBool(tzo, optimizeCpuL3Cache);
   MyOverrideBool(tzo, forceMetaInMemory);
   MyOverrideBool(tzo, enableEntropyStore);
+  MyOverrideBool(tzo, enableSharedDict);
 
 
   MyOverrideDouble(tzo, sampleRatio);
@@ -347,6 +351,7 @@ bool TerarkZipCFOptionsFromEnv(ColumnFamilyOptions& cfo,
   MyOverrideXiB(tzo, softZipWorkingMemLimit);
   MyOverrideXiB(tzo, hardZipWorkingMemLimit);
   MyOverrideXiB(tzo, smallTaskMemory);
+  MyOverrideXiB(tzo, streamingBuildMaxSize);
   MyOverrideXiB(tzo, singleIndexMinSize);
   MyOverrideXiB(tzo, singleIndexMaxSize);
   MyOverrideXiB(tzo, cacheCapacityBytes);
@@ -11,7 +11,9 @@
 #include "terark_zip_table.h"
 // std headers
 #include <atomic>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 // boost headers
 #include <boost/intrusive_ptr.hpp>
 #include <boost/noncopyable.hpp>
@@ -110,6 +112,46 @@ struct CollectInfo {
   float estimate() const;
 };
 
+// Value dict sample shared by all files built by a table factory, see
+// TerarkZipTableOptions::enableSharedDict. A factory may serve several column
+// families, their values are then sampled together. Builders with big
+// samples refresh it from time to time, builders with fewer samples train
+// from a part of it instead. A refresh puts the new samples in front and
+// keeps the newest older ones behind them up to kMaxSampleSize, so the
+// sample keeps following the data once it is full. The same sample gives the
+// same dict, so readers also keep one decompressed copy per distinct dict.
+struct SharedDictInfo {
+  static const size_t kMaxSampleSize;
+  static const uint64_t kRefreshIntervalMicros;
+
+  struct CachedDict {
+    size_t size;     // of the compressed dict
+    uint64_t check;  // xxhash of the compressed dict with another seed
+    std::weak_ptr<const valvec<byte_t>> dict;
+  };
+
+  std::shared_ptr<const std::string> sample;
+  uint64_t refresh_micros = 0;
+  bool loaded = false;
+  std::unordered_map<uint64_t, CachedDict> dicts;
+  mutable std::mutex mutex;
+
+  std::shared_ptr<const std::string> get_sample() const;
+  bool need_refresh(uint64_t now_micros) const;
+  // save to path if not empty, with a trailing xxhash of the sample
+  Status refresh(std::string&& new_sample, uint64_t now_micros, Env* env,
+                 const std::string& path);
+  // load the sample saved by refresh, only the first call reads the file.
+  // A missing file is not an error, the first compactions build the sample
+  Status load(Env* env, const std::string& path);
+
+  // keyed by the compressed dict, which is deterministic
+  std::shared_ptr<const valvec<byte_t>> get_dict(fstring zip_dict) const;
+  // returns the copy already cached by another reader if any
+  std::shared_ptr<const valvec<byte_t>> put_dict(
+      fstring zip_dict, std::shared_ptr<const valvec<byte_t>> dict);
+};
+
 enum class ZipValueType : unsigned char {
   kZeroSeq = 0,
   kDelete = 1,
@@ -194,6 +236,9 @@ class TerarkZipTableFactory : public TableFactory, boost::noncopyable {
 
   bool IsBuilderNeedSecondPass() const override { return true; }
 
+  bool AdmitBuild(uint64_t table_size, int output_level,
+                  bool urgent) const override;
+
   LruReadonlyCache* cache() const { return cache_.get(); }
 
   Status GetOptionString(std::string* opt_string,
@@ -211,9 +256,11 @@ class TerarkZipTableFactory : public TableFactory, boost::noncopyable {
 
  private:
   mutable CollectInfo collect_;
+  mutable SharedDictInfo shared_dict_;
 
  public:
   CollectInfo& GetCollect() const { return collect_; }
+  SharedDictInfo& GetSharedDict() const { return shared_dict_; }
   static std::unordered_map<std::string, OptionTypeInfo>
       terark_zip_table_type_info;
 };
@@ -37,6 +37,8 @@
 
 // rocksdb headers
 #include <table/meta_blocks.h>
+#include <util/coding.h>
+#include <util/xxhash.h>
 
 // terark headers
 #include <terark/lcast.hpp>
@@ -107,6 +109,119 @@ float CollectInfo::estimate() const {
   return ret ? ret : 1.0f;
 }
 
+const size_t SharedDictInfo::kMaxSampleSize = 32ull << 20;
+const uint64_t SharedDictInfo::kRefreshIntervalMicros = 600ull * 1000000;
+
+std::shared_ptr<const std::string> SharedDictInfo::get_sample() const {
+  std::unique_lock<std::mutex> l(mutex);
+  return sample;
+}
+
+bool SharedDictInfo::need_refresh(uint64_t now_micros) const {
+  std::unique_lock<std::mutex> l(mutex);
+  return sample == nullptr ||
+         now_micros >= refresh_micros + kRefreshIntervalMicros;
+}
+
+Status SharedDictInfo::refresh(std::string&& new_sample, uint64_t now_micros,
+                               Env* env, const std::string& path) {
+  std::unique_lock<std::mutex> l(mutex);
+  if (sample != nullptr &&
+      now_micros < refresh_micros + kRefreshIntervalMicros) {
+    // another builder has just refreshed it
+    return Status::OK();
+  }
+  if (sample != nullptr && new_sample.size() < kMaxSampleSize) {
+    // the oldest samples are at the end and dropped first
+    new_sample.append(sample->data(),
+                      std::min(sample->size(),
+                               kMaxSampleSize - new_sample.size()));
+  }
+  sample = std::make_shared<const std::string>(std::move(new_sample));
+  refresh_micros = now_micros;
+  if (path.empty()) {
+    return Status::OK();
+  }
+  // write and rename under the lock, refreshing is rare
+  std::string data;
+  data.reserve(sample->size() + sizeof(uint64_t));
+  data.append(*sample);
+  PutFixed64(&data, XXH64(sample->data(), sample->size(), 0));
+  std::string tmp = path + ".tmp";
+  Status s = WriteStringToFile(env, data, tmp, true);
+  if (s.ok()) {
+    s = env->RenameFile(tmp, path);
+  }
+  return s;
+}
+
+Status SharedDictInfo::load(Env* env, const std::string& path) {
+  std::unique_lock<std::mutex> l(mutex);
+  if (loaded) {
+    return Status::OK();
+  }
+  loaded = true;
+  if (env->FileExists(path).IsNotFound()) {
+    return Status::OK();
+  }
+  std::string data;
+  Status s = ReadFileToString(env, path, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  if (data.size() < sizeof(uint64_t)) {
+    return Status::Corruption("shared dict sample is truncated", path);
+  }
+  size_t size = data.size() - sizeof(uint64_t);
+  if (DecodeFixed64(data.data() + size) != XXH64(data.data(), size, 0)) {
+    return Status::Corruption("shared dict sample checksum mismatch", path);
+  }
+  data.resize(size);
+  if (sample == nullptr && !data.empty()) {
+    sample = std::make_shared<const std::string>(std::move(data));
+  }
+  return Status::OK();
+}
+
+std::shared_ptr<const valvec<byte_t>> SharedDictInfo::get_dict(
+    fstring zip_dict) const {
+  uint64_t hash = XXH64(zip_dict.data(), zip_dict.size(), 0);
+  uint64_t check = XXH64(zip_dict.data(), zip_dict.size(), hash);
+  std::unique_lock<std::mutex> l(mutex);
+  auto find = dicts.find(hash);
+  if (find == dicts.end() || find->second.size != zip_dict.size() ||
+      find->second.check != check) {
+    return nullptr;
+  }
+  return find->second.dict.lock();
+}
+
+std::shared_ptr<const valvec<byte_t>> SharedDictInfo::put_dict(
+    fstring zip_dict, std::shared_ptr<const valvec<byte_t>> dict) {
+  uint64_t hash = XXH64(zip_dict.data(), zip_dict.size(), 0);
+  uint64_t check = XXH64(zip_dict.data(), zip_dict.size(), hash);
+  std::unique_lock<std::mutex> l(mutex);
+  auto& slot = dicts[hash];
+  if (slot.size == zip_dict.size() && slot.check == check) {
+    if (auto exists = slot.dict.lock()) {
+      return exists;
+    }
+  } else if (!slot.dict.expired()) {
+    return dict;  // hash collision, keep the cached one and do not share
+  }
+  slot.size = zip_dict.size();
+  slot.check = check;
+  slot.dict = dict;
+  for (auto it = dicts.begin(); it != dicts.end();) {
+    if (it->second.dict.expired()) {
+      it = dicts.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return dict;
+}
+
 size_t TerarkZipMultiOffsetInfo::calc_size(size_t partCount) {
   return 8 + partCount * sizeof(KeyValueOffset);
 }
@@ -341,6 +456,8 @@ extern TableBuilder* createTerarkZipTableBuilder(
     const TerarkZipTableOptions& tzo, const TableBuilderOptions& tbo,
     uint32_t column_family_id, WritableFileWriter* file,
     uint32_t key_prefixLen);
+extern bool TerarkZipAdmitBuild(const TerarkZipTableOptions& tzo,
+                                uint64_t table_size, bool urgent);
 extern long long g_lastTime;
 
 TableBuilder* TerarkZipTableFactory::NewTableBuilder(
@@ -406,6 +523,15 @@ TableBuilder* TerarkZipTableFactory::NewTableBuilder(
                                      file, keyPrefixLen);
 }
 
+bool TerarkZipTableFactory::AdmitBuild(uint64_t table_size, int output_level,
+                                       bool urgent) const {
+  int minlevel = table_options_.terarkZipMinLevel;
+  if (fallback_factory_ && output_level >= 0 && output_level < minlevel) {
+    return fallback_factory_->AdmitBuild(table_size, output_level, urgent);
+  }
+  return TerarkZipAdmitBuild(table_options_, table_size, urgent);
+}
+
 #define PrintBuf(...) \
   ret.append(buffer, snprintf(buffer, kBufferSize, __VA_ARGS__))
 
@@ -553,6 +679,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"enableEntropyStore",
          {offsetof(struct TerarkZipTableOptions, enableEntropyStore),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"enableSharedDict",
+         {offsetof(struct TerarkZipTableOptions, enableSharedDict),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"cbtHashBits",
          {offsetof(struct TerarkZipTableOptions, cbtHashBits),
           OptionType::kUInt, OptionVerificationType::kNormal, false, 0}},
@@ -571,6 +700,12 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"indexType",
          {offsetof(struct TerarkZipTableOptions, indexType),
           OptionType::kString, OptionVerificationType::kNormal, false, 0}},
+        {"sharedDictFile",
+         {offsetof(struct TerarkZipTableOptions, sharedDictFile),
+          OptionType::kString, OptionVerificationType::kNormal, false, 0}},
+        {"memTempDir",
+         {offsetof(struct TerarkZipTableOptions, memTempDir),
+          OptionType::kString, OptionVerificationType::kNormal, false, 0}},
         {"softZipWorkingMemLimit",
          {offsetof(struct TerarkZipTableOptions, softZipWorkingMemLimit),
           OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
@@ -580,6 +715,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"smallTaskMemory",
          {offsetof(struct TerarkZipTableOptions, smallTaskMemory),
           OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
+        {"streamingBuildMaxSize",
+         {offsetof(struct TerarkZipTableOptions, streamingBuildMaxSize),
+          OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
         {"minDictZipValueSize",
          {offsetof(struct TerarkZipTableOptions, minDictZipValueSize),
           OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
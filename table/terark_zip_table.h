@@ -73,8 +73,13 @@ struct TerarkZipTableOptions {
   bool optimizeCpuL3Cache = true;
   bool forceMetaInMemory = false;
   bool enableEntropyStore = true;
+  /// dictZip of small files (flush, L0, L1 ...) trains the dictionary from a
+  /// sample shared by the files of this table factory, which is refreshed
+  /// from compaction outputs, instead of its own few samples. The part of it
+  /// used grows with the file's own sample, so a small file gets a small dict
+  bool enableSharedDict = false;
   uint8_t cbtHashBits = 0;
-  uint8_t reserveBytes0[5] = {};
+  uint8_t reserveBytes0[4] = {};
   uint16_t offsetArrayBlockUnits = 0;
 
   double sampleRatio = 0.03;
@@ -84,10 +89,22 @@ struct TerarkZipTableOptions {
   double indexCacheRatio = 0;  // 0.001;
   std::string localTempDir = "/tmp";
   std::string indexType = "Mixed_XL_256_32_FL";
+  /// if not empty, the shared dict sample is saved to this file and reloaded
+  /// by the first table build of the table factory, only for
+  /// enableSharedDict
+  std::string sharedDictFile;
+  /// a memory backed dir (tmpfs) for the temp files of streaming builds
+  std::string memTempDir = "/dev/shm";
 
   uint64_t softZipWorkingMemLimit = 16ull << 30;
   uint64_t hardZipWorkingMemLimit = 32ull << 30;
   uint64_t smallTaskMemory = 1200 << 20;  // 1.2G
+  /// builders keep their temp files in memTempDir and all values in the
+  /// first pass, so no second pass reads the input again, until their raw
+  /// key + value size exceeds this, then they spill to localTempDir.
+  /// memTempDir usage counts against softZipWorkingMemLimit, a builder also
+  /// spills when it would pass that limit. 0 disables streaming builds
+  uint64_t streamingBuildMaxSize = 0;
   // use dictZip for value when average value length >= minDictZipValueSize
   // otherwise do not use dictZip
   uint32_t minDictZipValueSize = 32;
@@ -6,15 +6,18 @@
 #include <cfloat>
 #include <exception>
 #include <future>
+#include <thread>
 // boost headers
 #include <boost/range/algorithm.hpp>
 // rocksdb headers
 #include <db/version_edit.h>
 #include <rocksdb/compaction_filter.h>
 #include <rocksdb/merge_operator.h>
+#include <monitoring/statistics.h>
 #include <table/meta_blocks.h>
 #include <util/async_task.h>
 #include <util/c_style_callback.h>
+#include <util/file_util.h>
 #include <util/xxhash.h>
 #include <util/string_util.h>
 // terark headers
@@ -55,6 +58,38 @@ static std::condition_variable zipCond;
 static valvec<PendingTask> waitQueue;
 static size_t sumWaitingMem = 0;
 static size_t sumWorkingMem = 0;
+// temp files of streaming builds in memTempDir, counted as working memory
+static size_t sumShmMem = 0;
+// build tasks waiting for memory, urgent ones of them, and tasks holding it
+static size_t numWaitingTasks = 0;
+static size_t numUrgentWaitingTasks = 0;
+static size_t numWorkingTasks = 0;
+// largest working memory of a finished builder per byte of its table, used
+// to project the memory of compactions before they start
+static double buildMemPerTableByte = 0.25;
+
+// memTempDir is usually another file system, so the file is copied. A file
+// not created yet has nothing to copy
+static Status CopyTempFile(Env* env, const AutoDeleteFile& file,
+                           const std::string& fpath, uint64_t* size) {
+  *size = 0;
+  Status s = env->FileExists(file.fpath);
+  if (s.IsNotFound()) {
+    return Status::OK();
+  }
+  if (s.ok()) {
+    s = env->GetFileSize(file.fpath, size);
+  }
+  if (s.ok()) {
+    s = CopyFile(env, file.fpath, fpath, *size, false);
+  }
+  if (!s.ok()) {
+    env->DeleteFile(fpath);
+    return Status::IOError("copy " + file.fpath + " to " + fpath,
+                           s.ToString());
+  }
+  return s;
+}
 
 template <class ByteArray>
 static Status WriteBlock(const ByteArray& blockData, WritableFileWriter* file,
@@ -163,6 +198,7 @@ TerarkZipTableBuilder::TerarkZipTableBuilder(
       range_del_block_(1),
       prefixLen_(key_prefixLen),
       compaction_load_(0) {
+  urgent_ = tbo.urgent;
   tiopt_.debugLevel = table_options_.debugLevel;
   tiopt_.indexNestLevel = table_options_.indexNestLevel;
   tiopt_.indexNestScale = table_options_.indexNestScale;
@@ -237,11 +273,24 @@ TerarkZipTableBuilder::TerarkZipTableBuilder(
         uint64_t(randomGenerator_.max() * table_options_.sampleRatio);
     tmpSentryFile_.path = table_options_.localTempDir + "/Terark-XXXXXX";
     tmpSentryFile_.open_temp();
+    if (table_options_.streamingBuildMaxSize > 0 &&
+        !table_options_.memTempDir.empty()) {
+      memSentryFile_.path = table_options_.memTempDir + "/Terark-XXXXXX";
+      try {
+        memSentryFile_.open_temp();
+        streaming_ = true;
+      } catch (const std::exception& ex) {
+        WARN(tbo.ioptions.info_log,
+             "TerarkZipTableBuilder(): memTempDir %s unusable, no streaming "
+             "build: %s\n",
+             table_options_.memTempDir.c_str(), ex.what());
+      }
+    }
     tmpSampleFile_.path = tmpSentryFile_.path + ".sample";
     tmpSampleFile_.open();
-    tmpIndexFile_.fpath = tmpSentryFile_.path + ".index";
-    tmpStoreFile_.fpath = tmpSentryFile_.path + ".bs";
-    tmpZipStoreFile_.fpath = tmpSentryFile_.path + ".zbs";
+    tmpIndexFile_.fpath = TempFilePrefix() + ".index";
+    tmpStoreFile_.fpath = TempFilePrefix() + ".bs";
+    tmpZipStoreFile_.fpath = TempFilePrefix() + ".zbs";
     if (table_options_.debugLevel == 3) {
       tmpDumpFile_.open(tmpSentryFile_.path + ".dump", "wb+");
     }
@@ -264,9 +313,87 @@ DictZipBlobStore::ZipBuilder* TerarkZipTableBuilder::createZipBuilder() const {
   return DictZipBlobStore::createZipBuilder(dzopt);
 }
 
+bool TerarkZipTableBuilder::ReserveShmMem(size_t size) {
+  // reserve in 1MB steps, not to take zipMutex for every key
+  size_t reserve = std::min<size_t>(size + (1 << 20),
+                                    table_options_.streamingBuildMaxSize);
+  std::unique_lock<std::mutex> zipLock(zipMutex);
+  if (sumWorkingMem + sumShmMem - shmMem_ + reserve >
+      table_options_.softZipWorkingMemLimit) {
+    return false;
+  }
+  sumShmMem += reserve - shmMem_;
+  shmMem_ = reserve;
+  return true;
+}
+
+Status TerarkZipTableBuilder::StopStreaming() {
+  // the index and store files are appended to by every part, move what the
+  // parts built so far wrote. The spools of those parts stay in memTempDir,
+  // they are within shmMem_ and may still be read by their index builds.
+  // All three are copied before any of them is switched, so a failure leaves
+  // the build streaming as it was
+  std::unique_lock<std::mutex> indexLock(indexBuildMutex_);
+  std::unique_lock<std::mutex> storeLock(storeBuildMutex_);
+  AutoDeleteFile* files[] = {&tmpIndexFile_, &tmpStoreFile_,
+                             &tmpZipStoreFile_};
+  const char* suffixes[] = {".index", ".bs", ".zbs"};
+  std::string paths[3];
+  uint64_t movedSize = 0;
+  Env* env = ioptions_.env;
+  for (size_t i = 0; i < 3; ++i) {
+    paths[i] = tmpSentryFile_.path + suffixes[i];
+    uint64_t size;
+    Status s = CopyTempFile(env, *files[i], paths[i], &size);
+    if (!s.ok()) {
+      for (size_t j = 0; j < i; ++j) {
+        env->DeleteFile(paths[j]);
+      }
+      return s;
+    }
+    movedSize += size;
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    files[i]->Delete();
+    files[i]->fpath = std::move(paths[i]);
+  }
+  streaming_ = false;
+
+  std::unique_lock<std::mutex> zipLock(zipMutex);
+  size_t release = size_t(std::min<uint64_t>(movedSize, shmMem_));
+  assert(sumShmMem >= release);
+  sumShmMem -= release;
+  shmMem_ -= release;
+  zipCond.notify_all();
+  return Status::OK();
+}
+
+void TerarkZipTableBuilder::SpillFilePair() {
+  // values of a user key are in the file pair of its key, so the spools are
+  // switched between user keys
+  filePair_->key.complete_write();
+  filePair_->value.complete_write();
+  filePair_ = NewFilePair();
+  r00_->fileVec.push_back(filePair_);
+  r10_->fileVec.push_back(filePair_);
+  r20_->fileVec.push_back(filePair_);
+  prevSamePrefix_ = 0;
+  keyDataSize_ = 0;
+  valueDataSize_ = 0;
+}
+
 TerarkZipTableBuilder::~TerarkZipTableBuilder() {
   std::unique_lock<std::mutex> zipLock(zipMutex);
+  if (shmMem_ > 0) {
+    assert(sumShmMem >= shmMem_);
+    sumShmMem -= shmMem_;
+    zipCond.notify_all();
+  }
   waitQueue.trim(boost::remove_if(waitQueue, TERARK_GET(.tztb) == this));
+  if (maxWorkMem_ > 0 && offset_ > 0) {
+    buildMemPerTableByte =
+        buildMemPerTableByte * 0.9 + 0.1 * maxWorkMem_ / offset_;
+  }
 }
 
 uint64_t TerarkZipTableBuilder::FileSize() const {
@@ -372,11 +499,12 @@ std::shared_ptr<FilePair> TerarkZipTableBuilder::NewFilePair() {
   auto pair = std::make_shared<FilePair>();
   char buffer[32];
   snprintf(buffer, sizeof buffer, ".key.%06zd", nameSeed_);
-  pair->key.path = tmpSentryFile_.path + buffer;
+  pair->key.path = TempFilePrefix() + buffer;
   pair->key.open();
   snprintf(buffer, sizeof buffer, ".value.%06zd", nameSeed_);
-  pair->value.path = tmpSentryFile_.path + buffer;
+  pair->value.path = TempFilePrefix() + buffer;
   pair->value.open();
+  filePairInMem_ = streaming_;
   ++nameSeed_;
   return pair;
 };
@@ -402,6 +530,17 @@ Status TerarkZipTableBuilder::Add(const Slice& key,
   ++properties_.num_entries;
   properties_.raw_key_size += key.size();
   properties_.raw_value_size += value.size();
+  if (streaming_) {
+    size_t rawSize = properties_.raw_key_size + properties_.raw_value_size;
+    if (rawSize > table_options_.streamingBuildMaxSize ||
+        (rawSize > shmMem_ && !ReserveShmMem(rawSize))) {
+      // too large to hold in memory, spill what comes next to localTempDir
+      s = StopStreaming();
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
 
   uint64_t seqType = DecodeFixed64(key.data() + key.size() - 8);
   ValueType value_type = ValueType(seqType & 255);
@@ -503,6 +642,9 @@ Status TerarkZipTableBuilder::Add(const Slice& key,
   } else if (prevUserKey != userKey) {
     assert((prevUserKey < userKey) ^ isReverseBytewiseOrder_);
     AddPrevUserKey(samePrefix, {r00_.get(), r10_.get(), r20_.get()}, {});
+    if (filePairInMem_ && !streaming_) {
+      SpillFilePair();
+    }
     keyDataSize_ += userKey.size();
   }
   prevKey_.DecodeFrom(key);
@@ -514,7 +656,7 @@ Status TerarkZipTableBuilder::Add(const Slice& key,
     tmpSampleFile_.writer << fstringOf(value);
     sampleLenSum_ += value.size();
   }
-  if (filePair_->isFullValue && second_pass_iter_ &&
+  if (filePair_->isFullValue && second_pass_iter_ && !streaming_ &&
       table_options_.debugLevel != 2 && valueDataSize_ > (1ull << 20) &&
       valueDataSize_ > keyDataSize_ * 2) {
     filePair_->isFullValue = false;
@@ -606,6 +748,10 @@ void TerarkZipTableBuilder::WaitHandle::Release(size_t size) {
     sumWorkingMem -= size;
     zipCond.notify_all();
     myWorkMem -= size;
+    if (myWorkMem == 0) {
+      assert(numWorkingTasks > 0);
+      --numWorkingTasks;
+    }
   }
 }
 TerarkZipTableBuilder::WaitHandle::~WaitHandle() { Release(myWorkMem); }
@@ -620,19 +766,25 @@ TerarkZipTableBuilder::WaitHandle TerarkZipTableBuilder::WaitForMemory(
   long long myStartTime = 0, now;
   auto shouldWait = [&]() {
     bool w;
+    size_t usedMem = sumWorkingMem + sumShmMem;
     if (myWorkMem < softMemLimit) {
-      w = (sumWorkingMem + myWorkMem >= hardMemLimit) ||
-          (sumWorkingMem + myWorkMem >= softMemLimit && myWorkMem >= smallmem);
+      // urgent builds may take memory up to the hard limit
+      w = (usedMem + myWorkMem >= hardMemLimit) ||
+          (!urgent_ && usedMem + myWorkMem >= softMemLimit &&
+           myWorkMem >= smallmem);
     } else {
-      w = sumWorkingMem > softMemLimit / 4;
+      w = usedMem > softMemLimit / 4;
     }
     now = g_pf.now();
     if (!w) {
       assert(!waitQueue.empty());
-      if (myWorkMem < smallmem) {
+      if (myWorkMem < smallmem || urgent_) {
         return false;  // do not wait
       }
-      if (sumWaitingMem + sumWorkingMem < softMemLimit) {
+      if (numUrgentWaitingTasks > 0) {
+        return true;  // wait, flush and L0 builds go first
+      }
+      if (sumWaitingMem + usedMem < softMemLimit) {
         return false;  // do not wait
       }
       if (waitQueue.size() == 1) {
@@ -663,8 +815,13 @@ TerarkZipTableBuilder::WaitHandle TerarkZipTableBuilder::WaitForMemory(
       waitInited_ = true;
     }
   }
+  uint64_t waitStartMicros = ioptions_.env->NowMicros();
   std::unique_lock<std::mutex> zipLock(zipMutex);
+  MeasureTime(ioptions_.statistics, TABLE_BUILD_MEMORY_QUEUE_DEPTH,
+              numWaitingTasks);
   sumWaitingMem += myWorkMem;
+  ++numWaitingTasks;
+  numUrgentWaitingTasks += urgent_;
   while (shouldWait()) {
     INFO(
         ioptions_.info_log,
@@ -691,6 +848,18 @@ TerarkZipTableBuilder::WaitHandle TerarkZipTableBuilder::WaitForMemory(
        (properties_.raw_key_size + properties_.raw_value_size) / 1e9);
   sumWaitingMem -= myWorkMem;
   sumWorkingMem += myWorkMem;
+  --numWaitingTasks;
+  if (urgent_) {
+    --numUrgentWaitingTasks;
+    zipCond.notify_all();
+  }
+  if (myWorkMem > 0) {
+    ++numWorkingTasks;
+  }
+  maxWorkMem_ = std::max(maxWorkMem_, myWorkMem);
+  zipLock.unlock();
+  MeasureTime(ioptions_.statistics, TABLE_BUILD_MEMORY_WAIT_MICROS,
+              ioptions_.env->NowMicros() - waitStartMicros);
   return WaitHandle{myWorkMem};
 }
 
@@ -1207,6 +1376,73 @@ TerarkZipTableBuilder::WaitHandle TerarkZipTableBuilder::LoadSample(
     return WaitHandle();
   }
 
+  auto& sharedDict = table_factory_->GetSharedDict();
+  bool refreshSharedDict = false;
+  std::string newSharedSample;
+  auto refreshSharedSample = [&] {
+    auto s = sharedDict.refresh(std::move(newSharedSample),
+                                ioptions_.env->NowMicros(), ioptions_.env,
+                                table_options_.sharedDictFile);
+    if (!s.ok()) {
+      WARN(ioptions_.info_log,
+           "TerarkZipTableBuilder::LoadSample(): save shared dict sample to "
+           "%s failed: %s\n",
+           table_options_.sharedDictFile.c_str(), s.ToString().c_str());
+    }
+  };
+  if (table_options_.enableSharedDict) {
+    if (!table_options_.sharedDictFile.empty()) {
+      auto s = sharedDict.load(ioptions_.env, table_options_.sharedDictFile);
+      if (!s.ok()) {
+        WARN(ioptions_.info_log,
+             "TerarkZipTableBuilder::LoadSample(): load shared dict sample "
+             "from %s failed, it is rebuilt by compactions: %s\n",
+             table_options_.sharedDictFile.c_str(), s.ToString().c_str());
+      }
+    }
+    refreshSharedDict =
+        level_ > 0 && sharedDict.need_refresh(ioptions_.env->NowMicros());
+    auto sharedSample = sharedDict.get_sample();
+    if (sharedSample && sharedSample->size() > sampleLenSum_) {
+      // few samples, the shared sample gives a better dict. The dict is
+      // embedded in the table, so use a prefix of it proportional to our own
+      // samples, rounded up to a power of 2 for similar tables to share it
+      size_t sharedLen = 4096;
+      while (sharedLen < sampleLenSum_ * 4) {
+        sharedLen *= 2;
+      }
+      fstring sample(*sharedSample);
+      sample = sample.substr(0, std::min(sharedLen, sample.size()));
+      auto waitHandle = WaitForMemory("dictZip", sample.size() * 6);
+      zbuilder->addSample(sample);
+      if (refreshSharedDict) {
+        // our samples still replace the oldest ones of the shared sample
+        NativeDataInput<InputBuffer> sampleInput(&tmpSampleFile_.fp);
+        valvec<byte_t> rec;
+        for (size_t len = 0; len < sampleLenSum_;) {
+          sampleInput >> rec;
+          newSharedSample.append((const char*)rec.data(), rec.size());
+          len += rec.size();
+        }
+        refreshSharedSample();
+      }
+      tmpSampleFile_.close();
+      zbuilder->finishSample();
+      INFO(ioptions_.info_log,
+           "TerarkZipTableBuilder::LoadSample():this=%12p:\n"
+           "sample_len = %zd, shared_sample_len = %zd, level = %d\n",
+           this, sampleLenSum_, sample.size(), level_);
+      return waitHandle;
+    }
+  }
+  auto addSample = [&](fstring rec) {
+    zbuilder->addSample(rec);
+    if (refreshSharedDict &&
+        newSharedSample.size() + rec.size() <= SharedDictInfo::kMaxSampleSize) {
+      newSharedSample.append(rec.data(), rec.size());
+    }
+  };
+
   size_t sampleMax =
       std::min<size_t>(INT32_MAX, table_options_.softZipWorkingMemLimit / 7);
   size_t dictWorkingMemory = std::min<size_t>(sampleMax, sampleLenSum_) * 6;
@@ -1223,7 +1459,7 @@ TerarkZipTableBuilder::WaitHandle TerarkZipTableBuilder::LoadSample(
   if (newSampleLen >= sampleLenSum_) {
     for (size_t len = 0; len < sampleLenSum_;) {
       sampleInput >> sample;
-      zbuilder->addSample(sample);
+      addSample(fstring(sample));
       len += sample.size();
     }
     realSampleLenSum = sampleLenSum_;
@@ -1235,10 +1471,9 @@ TerarkZipTableBuilder::WaitHandle TerarkZipTableBuilder::LoadSample(
       if (randomGenerator_() < upperBoundSample) {
         realSampleLenSum += sample.size();
         if (realSampleLenSum < newSampleLen) {
-          zbuilder->addSample(sample);
+          addSample(fstring(sample));
         } else {
-          zbuilder->addSample(
-              fstring(sample).substr(0, realSampleLenSum - newSampleLen));
+          addSample(fstring(sample).substr(0, realSampleLenSum - newSampleLen));
           break;
         }
       }
@@ -1257,6 +1492,9 @@ TerarkZipTableBuilder::WaitHandle TerarkZipTableBuilder::LoadSample(
             ? fstring("Hello World!")
             : fstring(sample).substr(0, std::min(sample.size(), newSampleLen)));
   }
+  if (!newSharedSample.empty()) {
+    refreshSharedSample();
+  }
   zbuilder->finishSample();
   return waitHandle;
 }
@@ -1352,7 +1590,7 @@ Status TerarkZipTableBuilder::buildZipOffsetBlobStore(
 Status TerarkZipTableBuilder::ZipValueToFinish() {
   assert(prefixBuildInfos_.size() == 1);
   auto& kvs = *prefixBuildInfos_.front();
-  AutoDeleteFile tmpDictFile{tmpSentryFile_.path + ".dict"};
+  AutoDeleteFile tmpDictFile{TempFilePrefix() + ".dict"};
   std::unique_ptr<DictZipBlobStore::ZipBuilder> zbuilder;
   WaitHandle dictWaitHandle;
   std::unique_ptr<AsyncTask<Status>> dictWait;
@@ -1419,7 +1657,7 @@ Status TerarkZipTableBuilder::ZipValueToFinish() {
 
 Status TerarkZipTableBuilder::ZipValueToFinishMulti() {
   assert(prefixBuildInfos_.size() > 1);
-  AutoDeleteFile tmpDictFile{tmpSentryFile_.path + ".dict"};
+  AutoDeleteFile tmpDictFile{TempFilePrefix() + ".dict"};
   std::unique_ptr<DictZipBlobStore::ZipBuilder> zbuilder;
   WaitHandle dictWaitHandle;
   std::unique_ptr<AsyncTask<Status>> dictWait;
@@ -1832,7 +2070,7 @@ Status TerarkZipTableBuilder::WriteIndexStore(
   auto writeAppend =
       std::bind(&TerarkZipTableBuilder::DoWriteAppend, this, _1, _2);
   BuildReorderParams params;
-  params.tmpReorderFile.fpath = tmpSentryFile_.path + ".reorder";
+  params.tmpReorderFile.fpath = TempFilePrefix() + ".reorder";
   std::unique_ptr<TerarkIndex> index;
   BuildReorderMap(index, params, kvs, indexMmap, store, t6);
   size_t indexSize;
@@ -1843,7 +2081,7 @@ Status TerarkZipTableBuilder::WriteIndexStore(
     params.type.swap(kvs.type); // kvs.type will be written to file
     ZReorderMap reorder(params.tmpReorderFile.fpath);
     t7 = g_pf.now();
-    std::string reorder_tmp = tmpSentryFile_.path + ".reorder-tmp";
+    std::string reorder_tmp = TempFilePrefix() + ".reorder-tmp";
     try {
       offset = offset_;
       // Composite Index needs reorder
@@ -2377,6 +2615,9 @@ void TerarkZipTableBuilder::Abandon() {
   if (tmpSentryFile_.fp) {
     tmpSentryFile_.complete_write();
   }
+  if (memSentryFile_.fp) {
+    memSentryFile_.complete_write();
+  }
   if (tmpSampleFile_.fp) {
     tmpSampleFile_.complete_write();
   }
@@ -2487,6 +2728,24 @@ bool TerarkZipTableBuilder::MergeRangeStatus(RangeStatus* aa, RangeStatus* bb,
   return aai.estimate_size + bbi.estimate_size >= aai.estimate_size * 0.9;
 }
 
+bool TerarkZipAdmitBuild(const TerarkZipTableOptions& tzo, uint64_t table_size,
+                         bool urgent) {
+  if (urgent) {
+    return true;  // flush and L0 builds are ordered in WaitForMemory
+  }
+  const size_t softMemLimit = tzo.softZipWorkingMemLimit;
+  static const size_t cpuCount =
+      std::max<size_t>(1, std::thread::hardware_concurrency());
+  std::unique_lock<std::mutex> zipLock(zipMutex);
+  if (numWorkingTasks == 0) {
+    return true;  // nothing to wait for
+  }
+  size_t projected = size_t(buildMemPerTableByte * table_size);
+  return numUrgentWaitingTasks == 0 && numWorkingTasks < cpuCount &&
+         sumWaitingMem + sumWorkingMem + sumShmMem + projected <
+             softMemLimit;
+}
+
 TableBuilder* createTerarkZipTableBuilder(
     const TerarkZipTableFactory* table_factory,
     const TerarkZipTableOptions& tzo, const TableBuilderOptions& tbo,
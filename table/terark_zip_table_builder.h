@@ -130,6 +130,17 @@ class TerarkZipTableBuilder : public TableBuilder, boost::noncopyable {
     KeyValueStatus(RangeStatus&& s, freq_hist_o1&& f);
   };
   std::shared_ptr<FilePair> NewFilePair();
+  // temp files go to memTempDir while the build is streaming
+  const std::string& TempFilePrefix() const {
+    return streaming_ ? memSentryFile_.path : tmpSentryFile_.path;
+  }
+  // counts the temp files in memTempDir against the zip memory limits,
+  // false if the soft limit is reached
+  bool ReserveShmMem(size_t size);
+  // spill to localTempDir, moving the index and store files
+  Status StopStreaming();
+  // continue the spools of the current part in localTempDir
+  void SpillFilePair();
   void AddPrevUserKey(size_t samePrefix, std::initializer_list<RangeStatus*> r,
                       std::initializer_list<RangeStatus*> e);
   void AddValueBit();
@@ -221,6 +232,7 @@ class TerarkZipTableBuilder : public TableBuilder, boost::noncopyable {
   size_t keyDataSize_ = 0;
   size_t valueDataSize_ = 0;
   size_t prevSamePrefix_ = 0;
+  size_t shmMem_ = 0;  // reserved in sumShmMem
   std::unique_ptr<RangeStatus> r22_, r11_, r00_, r21_, r10_, r20_;
   struct FreqPair {
     freq_hist_o1 k, v;
@@ -232,6 +244,7 @@ class TerarkZipTableBuilder : public TableBuilder, boost::noncopyable {
   std::shared_ptr<FilePair> filePair_;
   InternalKey prevKey_;
   TempFileDeleteOnClose tmpSentryFile_;
+  TempFileDeleteOnClose memSentryFile_;
   TempFileDeleteOnClose tmpSampleFile_;
   AutoDeleteFile tmpIndexFile_;
   AutoDeleteFile tmpStoreFile_;
@@ -260,9 +273,13 @@ class TerarkZipTableBuilder : public TableBuilder, boost::noncopyable {
   valvec<byte_t> valueTestBuf_;
   uint64_t next_freq_size_ = 1ULL << 20;
   bool waitInited_ = false;
+  bool streaming_ = false;
+  bool filePairInMem_ = false;
   bool closed_ = false;  // Either Finish() or Abandon() has been called.
   bool isReverseBytewiseOrder_;
+  bool urgent_;  // flush or L0 compaction, goes first for working memory
   int level_;
+  size_t maxWorkMem_ = 0;  // largest working memory of one build task
 
   long long t0 = 0;
   // Tags in following union are only indicating different function types for
@@ -2,6 +2,8 @@
 
   M_String(localTempDir);
   M_String(indexType);
+  M_String(sharedDictFile);
+  M_String(memTempDir);
   M_NumFmt(checksumLevel            , "%d");
   M_NumFmt(checksumSmallValSize     , "%d");
   M_NumFmt(entropyAlgo              , "%d");
@@ -21,6 +23,7 @@
   M_Boolea(optimizeCpuL3Cache);
   M_Boolea(forceMetaInMemory);
   M_Boolea(enableEntropyStore);
+  M_Boolea(enableSharedDict);
   M_NumFmt(cbtHashBits              , "%d");
   M_NumFmt(minPreadLen              , "%d");
   M_NumFmt(offsetArrayBlockUnits    , "%d");
@@ -29,6 +32,7 @@
   M_NumGiB(softZipWorkingMemLimit);
   M_NumGiB(hardZipWorkingMemLimit);
   M_NumGiB(smallTaskMemory);
+  M_NumGiB(streamingBuildMaxSize);
   M_NumGiB(singleIndexMinSize);
   M_NumGiB(singleIndexMaxSize);
   M_NumGiB(cacheCapacityBytes);
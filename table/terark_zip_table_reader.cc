@@ -13,6 +13,8 @@
 #include <terark/util/crc.hpp>
 #include <terark/util/function.hpp>
 #include <terark/util/hugepage.hpp>
+// std headers
+#include <algorithm>
 
 #ifndef _MSC_VER
 #include <fcntl.h>
@@ -153,6 +155,40 @@ Status DecompressDict(const TableProperties& table_properties, fstring dict,
   return Status::OK();
 }
 
+// Decompressed dicts are shared by readers of the same table factory when
+// enableSharedDict, files built from the same shared sample hold the same dict
+Status LoadDict(const TerarkZipTableFactory* table_factory,
+                const TerarkZipTableOptions& tzto,
+                const TableProperties& table_properties, fstring dict,
+                std::shared_ptr<const valvec<byte_t>>* output_dict,
+                TerarkZipTableReaderBase* reader) {
+  output_dict->reset();
+  auto find =
+      table_properties.user_collected_properties.find(kTerarkZipTableDictInfo);
+  bool is_compressed =
+      find != table_properties.user_collected_properties.end() &&
+      !find->second.empty();
+  if (tzto.enableSharedDict && is_compressed) {
+    *output_dict = table_factory->GetSharedDict().get_dict(dict);
+    if (*output_dict) {
+      reader->MmapColdize(dict);
+      return Status::OK();
+    }
+  }
+  auto raw_dict = std::make_shared<valvec<byte_t>>();
+  Status s = DecompressDict(table_properties, dict, raw_dict.get(), reader);
+  if (!s.ok() || raw_dict->empty()) {
+    return s;
+  }
+  if (tzto.enableSharedDict) {
+    *output_dict =
+        table_factory->GetSharedDict().put_dict(dict, std::move(raw_dict));
+  } else {
+    *output_dict = std::move(raw_dict);
+  }
+  return s;
+}
+
 static void MmapAdviseRandom(const void* addr, size_t len) {
   size_t low = terark::align_up(size_t(addr), 4096);
   size_t hig = terark::align_down(size_t(addr) + len, 4096);
@@ -256,6 +292,9 @@ class TerarkZipTableIterator : public TerarkZipTableIndexIterator,
   TerarkContext ctx_;
   TerarkContext* ctx_ptr_;
   valvec<byte_t> iter_storage_;
+  // ReadOptions::key_only, records holding nothing but the value are not
+  // unzipped
+  bool key_only_;
 
   using TerarkZipTableIndexIterator::iter_;
   using TerarkZipTableIndexIterator::subReader_;
@@ -296,11 +335,12 @@ class TerarkZipTableIterator : public TerarkZipTableIndexIterator,
  public:
   TerarkZipTableIterator(const TableReaderOptions& tro,
                          const TerarkZipSubReader* subReader,
-                         const ReadOptions& /*ro*/, SequenceNumber global_seqno,
+                         const ReadOptions& ro, SequenceNumber global_seqno,
                          TerarkContext* ctx)
       : table_reader_options_(&tro),
         global_seqno_(global_seqno),
-        ctx_ptr_(ctx == nullptr ? &ctx_ : ctx) {
+        ctx_ptr_(ctx == nullptr ? &ctx_ : ctx),
+        key_only_(ro.key_only) {
     subReader_ = subReader;
     if (subReader_ != nullptr) {
       iter_storage_.swap(ctx_ptr_->alloc(subReader_->index_->IteratorSize()));
@@ -542,7 +582,11 @@ class TerarkZipTableIterator : public TerarkZipTableIndexIterator,
             key_length_ + subReader_->estimateUnzipCap_ + mulnum_size);
         value_buffer.resize_no_init(mulnum_size);
         *reinterpret_cast<size_t*>(value_buffer.data()) = 1;
-        subReader_->GetRecordAppend(recId, cache_offsets_);
+        // kZeroSeq keeps the seqno and type in the type array, the record is
+        // the bare value. Other types need the record for the seqno
+        if (!key_only_ || ZipValueType::kZeroSeq != zip_value_type_) {
+          subReader_->GetRecordAppend(recId, cache_offsets_);
+        }
       } catch (const std::exception& ex) {  // crc checksum error
         SetIterInvalid();
         status_ = Status::Corruption(
@@ -1038,6 +1082,41 @@ size_t TerarkZipSubReader::DictRank(fstring key) const {
   return index_->DictRank(key, terark::GetTlsTerarkContext());
 }
 
+void TerarkZipSubReader::AppendKeysAtRanks(
+    const size_t* ranks, size_t count, std::vector<std::string>* keys) const {
+  if (count == 0) {
+    return;
+  }
+  auto g_tctx = terark::GetTlsTerarkContext();
+  valvec<byte_t> iter_storage;
+  iter_storage.swap(g_tctx->alloc(index_->IteratorSize()));
+  TerarkIndex::Iterator* iter = index_->NewIterator(&iter_storage, g_tctx);
+  size_t rank = 0;
+  size_t i = 0;
+  for (bool ok = iter->SeekToFirst(); ok && i < count;
+       ok = iter->Next(), ++rank) {
+    if (rank == ranks[i]) {
+      fstring key = iter->key();
+      keys->emplace_back(key.data(), key.size());
+      ++i;
+    }
+  }
+  call_destructor(iter);
+  ContextBuffer(std::move(iter_storage), g_tctx);
+}
+
+// Ranks splitting `num_keys` keys into `num_anchors + 1` equal pieces
+static std::vector<size_t> AnchorRanks(size_t num_keys, size_t num_anchors) {
+  num_anchors = std::min(num_anchors, num_keys > 0 ? num_keys - 1 : 0);
+  std::vector<size_t> ranks;
+  ranks.reserve(num_anchors);
+  double stride = double(num_keys) / (num_anchors + 1);
+  for (size_t k = 1; k <= num_anchors; ++k) {
+    ranks.emplace_back(size_t(k * stride));
+  }
+  return ranks;
+}
+
 TerarkZipSubReader::~TerarkZipSubReader() { type_.risk_release_ownership(); }
 
 Status TerarkEmptyTableReader::Open(RandomAccessFileReader* file,
@@ -1135,11 +1214,12 @@ Status TerarkZipTableReader::Open(RandomAccessFileReader* file,
                           kTerarkZipTableValueDictBlock, &valueDictBlock);
   Slice dict = valueDictBlock.data;
   if (s.ok()) {
-    s = DecompressDict(*props, fstringOf(valueDictBlock.data), &dict_, this);
+    s = LoadDict(table_factory_, tzto_, *props,
+                 fstringOf(valueDictBlock.data), &dict_, this);
     if (!s.ok()) {
       return s;
     }
-    dict = dict_.empty() ? valueDictBlock.data : SliceOf(dict_);
+    dict = dict_ ? SliceOf(*dict_) : valueDictBlock.data;
   }
   props->user_collected_properties.emplace(kTerarkZipTableDictSize,
                                            lcast(dict.size()));
@@ -1396,6 +1476,19 @@ uint64_t TerarkZipTableReader::ApproximateOffsetOf(const Slice& ikey) {
   return offset;
 }
 
+// The index has no select, so the keys are found by walking it. That is
+// still far cheaper than the compaction the anchors are taken for.
+Status TerarkZipTableReader::GetKeyAnchors(size_t num_anchors,
+                                           std::vector<std::string>* anchors) {
+  auto ranks = AnchorRanks(subReader_.index_->NumKeys(), num_anchors);
+  size_t begin = anchors->size();
+  subReader_.AppendKeysAtRanks(ranks.data(), ranks.size(), anchors);
+  if (isReverseBytewiseOrder_) {
+    std::reverse(anchors->begin() + begin, anchors->end());
+  }
+  return Status::OK();
+}
+
 TerarkZipTableReader::~TerarkZipTableReader() {
   if (subReader_.storeUsePread_) {
     if (subReader_.cache_) {
@@ -1656,6 +1749,34 @@ uint64_t TerarkZipTableMultiReader::ApproximateOffsetOf(const Slice& ikey) {
   return offset;
 }
 
+Status TerarkZipTableMultiReader::GetKeyAnchors(
+    size_t num_anchors, std::vector<std::string>* anchors) {
+  if (isReverseBytewiseOrder_) {
+    return Status::NotSupported();
+  }
+  size_t num_keys = 0;
+  for (size_t i = 0; i < subIndex_.GetSubCount(); ++i) {
+    num_keys += subIndex_.GetSubReader(i)->index_->NumKeys();
+  }
+  auto ranks = AnchorRanks(num_keys, num_anchors);
+  // Walk each part only as far as its last anchor
+  size_t part_begin = 0;
+  auto it = ranks.begin();
+  std::vector<size_t> part_ranks;
+  for (size_t i = 0; i < subIndex_.GetSubCount() && it != ranks.end(); ++i) {
+    auto subReader = subIndex_.GetSubReader(i);
+    size_t part_end = part_begin + subReader->index_->NumKeys();
+    part_ranks.clear();
+    for (; it != ranks.end() && *it < part_end; ++it) {
+      part_ranks.emplace_back(*it - part_begin);
+    }
+    subReader->AppendKeysAtRanks(part_ranks.data(), part_ranks.size(),
+                                 anchors);
+    part_begin = part_end;
+  }
+  return Status::OK();
+}
+
 TerarkZipTableMultiReader::~TerarkZipTableMultiReader() {}
 
 TerarkZipTableMultiReader::TerarkZipTableMultiReader(
@@ -1715,11 +1836,12 @@ Status TerarkZipTableMultiReader::Open(RandomAccessFileReader* file,
                           kTerarkZipTableValueDictBlock, &valueDictBlock);
   Slice dict;
   if (s.ok()) {
-    s = DecompressDict(*props, fstringOf(valueDictBlock.data), &dict_, this);
+    s = LoadDict(table_factory_, tzto_, *props,
+                 fstringOf(valueDictBlock.data), &dict_, this);
     if (!s.ok()) {
       return s;
     }
-    dict = dict_.empty() ? valueDictBlock.data : SliceOf(dict_);
+    dict = dict_ ? SliceOf(*dict_) : valueDictBlock.data;
   }
   props->user_collected_properties.emplace(kTerarkZipTableDictSize,
                                            lcast(dict.size()));
@@ -159,6 +159,9 @@ struct TerarkZipSubReader {
   Status Get(SequenceNumber, const ReadOptions&, const Slice& key, GetContext*,
              int flag) const;
   size_t DictRank(fstring key) const;
+  // Appends the keys at the given ascending ranks, walking the index only
+  void AppendKeysAtRanks(const size_t* ranks, size_t count,
+                         std::vector<std::string>* keys) const;
 
   ~TerarkZipSubReader();
 };
@@ -191,6 +194,8 @@ class TerarkZipTableReader : public TerarkZipTableReaderBase {
                                        LazyBuffer&& value)) override;
 
   uint64_t ApproximateOffsetOf(const Slice& key) override;
+  Status GetKeyAnchors(size_t num_anchors,
+                       std::vector<std::string>* anchors) override;
   void SetupForCompaction() override {}
 
   size_t ApproximateMemoryUsage() const override { return file_data_.size(); }
@@ -205,7 +210,7 @@ class TerarkZipTableReader : public TerarkZipTableReaderBase {
 
   TerarkZipSubReader subReader_;
   static const size_t kNumInternalBytes = 8;
-  valvec<byte_t> dict_;
+  std::shared_ptr<const valvec<byte_t>> dict_;
   valvec<byte_t> meta_;
   const TerarkZipTableFactory* table_factory_;
   SequenceNumber global_seqno_;
@@ -239,6 +244,8 @@ class TerarkZipTableMultiReader : public TerarkZipTableReaderBase {
                                        LazyBuffer&& value)) override;
 
   uint64_t ApproximateOffsetOf(const Slice& key) override;
+  Status GetKeyAnchors(size_t num_anchors,
+                       std::vector<std::string>* anchors) override;
   void SetupForCompaction() override {}
 
   size_t ApproximateMemoryUsage() const override { return file_data_.size(); }
@@ -285,7 +292,7 @@ class TerarkZipTableMultiReader : public TerarkZipTableReaderBase {
 
   SubIndex subIndex_;
   static const size_t kNumInternalBytes = 8;
-  valvec<byte_t> dict_;
+  std::shared_ptr<const valvec<byte_t>> dict_;
   valvec<byte_t> meta_;
   const TerarkZipTableFactory* table_factory_;
   SequenceNumber global_seqno_;
@@ -61,6 +61,66 @@ void ManifestAnalysis::ListCFNames(
   }
 }
 
+void ManifestAnalysis::Stat(const std::string& manifest_fname) {
+  std::unique_ptr<SequentialFileReader> file_reader;
+  {
+    std::unique_ptr<SequentialFile> manifest_file;
+    auto s = options_.env->NewSequentialFile(manifest_fname, &manifest_file,
+                                             envOptions_);
+    if (!s.ok()) {
+      std::cout << "Open Manifest File Error!" << std::endl;
+      return;
+    }
+    file_reader.reset(
+        new SequentialFileReader(std::move(manifest_file), manifest_fname));
+  }
+
+  LogReporter reporter;
+  Status s;
+  reporter.status = &s;
+  log::Reader reader(nullptr, std::move(file_reader), &reporter, true, 0,
+                     false);
+
+  uint64_t num_edits = 0, total_bytes = 0, max_edit_bytes = 0;
+  uint64_t num_added = 0, num_deleted = 0;
+  // file numbers are unique across column families
+  std::unordered_set<uint64_t> live_files;
+  Slice record;
+  std::string scratch;
+  while (reader.ReadRecord(&record, &scratch) && s.ok()) {
+    VersionEdit edit;
+    s = edit.DecodeFrom(record);
+    if (!s.ok()) {
+      std::cout << "Decode from manifest record, failed!" << std::endl;
+      break;
+    }
+    ++num_edits;
+    total_bytes += record.size();
+    max_edit_bytes = std::max<uint64_t>(max_edit_bytes, record.size());
+    for (auto& pair : edit.GetDeletedFiles()) {
+      live_files.erase(pair.second);
+      ++num_deleted;
+    }
+    for (auto& pair : edit.GetNewFiles()) {
+      live_files.insert(pair.second.fd.GetNumber());
+      ++num_added;
+    }
+  }
+
+  std::cout << "edits: " << num_edits << std::endl;
+  std::cout << "bytes: " << total_bytes << std::endl;
+  std::cout << "largest edit bytes: " << max_edit_bytes << std::endl;
+  std::cout << "files added: " << num_added << std::endl;
+  std::cout << "files deleted: " << num_deleted << std::endl;
+  std::cout << "live files: " << live_files.size() << std::endl;
+  // A freshly rolled manifest holds one file entry per live file, anything
+  // above that is tail recovery has to replay on top of the checkpoint
+  std::cout << "replay amplification: "
+            << (live_files.empty() ? 0.0
+                                   : double(num_added) / live_files.size())
+            << std::endl;
+}
+
 void ManifestAnalysis::Validate(const std::string& manifest_fname) {
   std::unique_ptr<SequentialFileReader> manifest_reader;
   {
@@ -97,6 +157,7 @@ void ManifestAnalysis::Validate(const std::string& manifest_fname) {
 void PrintHelp() {
   std::cout << "usage:" << std::endl;
   std::cout << "\t./manifest validate [manifest_file]" << std::endl;
+  std::cout << "\t./manifest stat [manifest_file]" << std::endl;
 }
 
 int main(const int argc, const char** argv) {
@@ -111,6 +172,8 @@ int main(const int argc, const char** argv) {
 
   if (memcmp(argv[1], "validate", 8) == 0) {
     ma->Validate(manifest_fname);
+  } else if (memcmp(argv[1], "stat", 4) == 0) {
+    ma->Stat(manifest_fname);
   } else {
     std::cout << "Unsupported Operation!" << std::endl;
     PrintHelp();
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <map>
+#include <unordered_set>
 
 #include <db/version_set.h>
 #include <options/cf_options.h>
@@ -47,6 +49,10 @@ class ManifestAnalysis {
 
   void Validate(const std::string& manifest_fname);
 
+  // Summarizes how much of the manifest recovery has to replay compared to
+  // the live state it ends up with, see DBOptions::max_manifest_tail_ratio
+  void Stat(const std::string& manifest_fname);
+
   void ListCFNames(std::unique_ptr<SequentialFileReader>& file_reader,
                    std::map<uint32_t, std::string>& result);
 };
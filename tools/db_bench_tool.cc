@@ -26,6 +26,7 @@
 #include <sys/types.h>
 
 #include <atomic>
+#include <cmath>
 #include <condition_variable>
 #include <cstddef>
 #include <memory>
@@ -126,7 +127,11 @@ DEFINE_string(
     "fillseekseq,"
     "randomtransaction,"
     "randomreplacekeys,"
-    "timeseries",
+    "timeseries,"
+    "overwriteseparated,"
+    "updatezipfianwithgc,"
+    "scanseparated,"
+    "workload",
 
     "Comma-separated list of operations to run in the specified"
     " order. Available benchmarks:\n"
@@ -187,7 +192,16 @@ DEFINE_string(
     "\trandomreplacekeys     -- randomly replaces N keys by deleting "
     "the old version and putting the new version\n\n"
     "\ttimeseries            -- 1 writer generates time series data "
-    "and multiple readers doing random reads on id\n\n"
+    "and multiple readers doing random reads on id\n"
+    "\toverwriteseparated    -- overwrite N values in random key order, "
+    "every value is large enough to be separated by blob_size\n"
+    "\tupdatezipfianwithgc   -- overwrite N values with Zipfian skewed "
+    "keys, uneven blob garbage for garbage collection\n"
+    "\tscanseparated         -- N random seeks, read seek_nexts separated "
+    "values after each seek\n"
+    "\tworkload              -- mix of gets, puts, merges, scans, range "
+    "deletions and multigets set by the workload_* flags, closed loop or "
+    "open loop at workload_qps\n\n"
     "Meta operations:\n"
     "\tcompact     -- Compact the entire DB; If multiple, randomly choose one\n"
     "\tcompactall  -- Compact the entire DB\n"
@@ -308,6 +322,11 @@ DEFINE_bool(enable_numa, false,
             "CPU and memory of same node. Use \"$numactl --hardware\" command "
             "to see NUMA memory architecture.");
 
+DEFINE_bool(numa_aware, false,
+            "Set DBOptions::numa_aware, binding background threads to NUMA "
+            "nodes and allocating memtable memory on the writer's node, and "
+            "give every node its own block cache shards");
+
 DEFINE_int64(db_write_buffer_size, rocksdb::Options().db_write_buffer_size,
              "Number of bytes to buffer in all memtables before compacting");
 
@@ -735,11 +754,32 @@ DEFINE_uint64(fifo_compaction_ttl, 0, "TTL for the SST Files in seconds.");
 DEFINE_bool(report_bg_io_stats, false,
             "Measure times spents on I/Os while in compactions. ");
 
+DEFINE_uint64(io_heatmap_sample_period, 0,
+              "If non-zero, sample one in this many SST block I/Os into the "
+              "rocksdb.io-heatmap property, which is printed after the "
+              "benchmarks");
+
+DEFINE_string(io_heatmap_dump_file, "",
+              "If non-empty, write the raw I/O heatmap samples to this file "
+              "as CSV after the benchmarks. Requires "
+              "--io_heatmap_sample_period");
+
 DEFINE_bool(use_stderr_info_logger, false,
             "Write info logs to stderr instead of to LOG file. ");
 
 DEFINE_string(trace_file, "", "Trace workload to a file. ");
 
+DEFINE_int32(trace_replay_threads, 1,
+             "Number of threads replaying the trace of the replay benchmark");
+
+DEFINE_double(trace_replay_fast_forward, 1.0,
+              "Replay speed relative to the traced speed, 0 replays the "
+              "trace as fast as possible");
+
+DEFINE_bool(trace_replay_shard_by_thread, false,
+            "Replay the operations of one traced thread on one replay thread "
+            "instead of sharding them by key");
+
 static enum rocksdb::CompressionType StringToCompressionType(
     const char* ctype) {
   assert(ctype);
@@ -955,6 +995,76 @@ DEFINE_double(blob_large_key_ratio, 1, "Key Value Separate large key ratio");
 
 DEFINE_double(blob_gc_ratio, 0.2, "Blob SST gc ratio");
 
+DEFINE_double(zipf_theta, 0.99,
+              "Skew of the Zipfian key distribution, in [0, 1). Larger "
+              "values concentrate more operations on fewer keys");
+
+DEFINE_bool(separation_stats_per_interval, false,
+            "Print garbage collection throughput, blob garbage ratio, read "
+            "amplification and space amplification every stats_interval");
+
+DEFINE_bool(scan_key_only, false,
+            "scanseparated sets ReadOptions::key_only, separated values are "
+            "never fetched");
+
+DEFINE_double(workload_get_ratio, 0.8, "Weight of Get in the workload mix");
+
+DEFINE_double(workload_put_ratio, 0.2, "Weight of Put in the workload mix");
+
+DEFINE_double(workload_merge_ratio, 0,
+              "Weight of Merge in the workload mix, needs --merge_operator");
+
+DEFINE_double(workload_seek_ratio, 0,
+              "Weight of Seek followed by seek_nexts Next() calls in the "
+              "workload mix");
+
+DEFINE_double(workload_delete_range_ratio, 0,
+              "Weight of DeleteRange over range_tombstone_width keys in the "
+              "workload mix");
+
+DEFINE_double(workload_multiget_ratio, 0,
+              "Weight of MultiGet of batch_size keys in the workload mix");
+
+DEFINE_string(workload_key_dist, "uniform",
+              "Key distribution of the workload benchmark: uniform, zipfian "
+              "(skew set by zipf_theta), hotspot or latest. With latest, "
+              "puts insert new keys and reads favor recently inserted ones");
+
+DEFINE_double(workload_hotspot_key_fraction, 0.2,
+              "Fraction of the key space that is hot with "
+              "workload_key_dist=hotspot");
+
+DEFINE_double(workload_hotspot_op_fraction, 0.8,
+              "Fraction of operations that go to the hot keys with "
+              "workload_key_dist=hotspot");
+
+DEFINE_string(workload_value_size_dist, "fixed",
+              "Value size distribution of the workload benchmark: fixed "
+              "(value_size), uniform or pareto between workload_value_size_min "
+              "and workload_value_size_max. The size is a function of the key, "
+              "so rewrites of a key keep its size");
+
+DEFINE_int32(workload_value_size_min, 16,
+             "Smallest value written by the workload benchmark");
+
+DEFINE_int32(workload_value_size_max, 1024,
+             "Largest value written by the workload benchmark");
+
+DEFINE_double(workload_value_size_pareto_alpha, 1.2,
+              "Shape of the pareto value size distribution, smaller values "
+              "give a longer tail");
+
+DEFINE_uint64(workload_qps, 0,
+              "Target operations per second of the workload benchmark over "
+              "all threads. 0 runs closed loop. Otherwise operations are "
+              "issued on a fixed schedule and latency is measured from the "
+              "scheduled start, so stalls show up in the histograms instead "
+              "of lowering the offered load");
+
+DEFINE_bool(workload_poisson_arrivals, false,
+            "Schedule open loop operations with exponential inter-arrival "
+            "times instead of a fixed interval");
+
 DEFINE_uint64(wal_ttl_seconds, 0, "Set the TTL for the WAL Files in seconds.");
 DEFINE_uint64(wal_size_limit_MB, 0,
               "Set the size limit for the WAL Files"
@@ -1329,6 +1439,174 @@ class RandomGenerator {
   }
 };
 
+// Uniform double in [0, 1).
+static double NextDouble(Random64* rnd) {
+  return (rnd->Next() >> 11) * (1.0 / (uint64_t(1) << 53));
+}
+
+// Scrambled Zipfian generator from YCSB, after Gray et al. "Quickly
+// Generating Billion-Record Synthetic Databases". Popular items are hashed
+// over the whole key space instead of being clustered at its start.
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t num, double theta)
+      : num_(std::max<uint64_t>(num, 2)), theta_(theta) {
+    assert(theta >= 0 && theta < 1);
+    zetan_ = Zeta(num_, theta_);
+    alpha_ = 1 / (1 - theta_);
+    eta_ = (1 - std::pow(2.0 / num_, 1 - theta_)) /
+           (1 - Zeta(2, theta_) / zetan_);
+  }
+
+  uint64_t Next(Random64* rnd) const {
+    uint64_t rank = NextRank(rnd);
+    return XXH64(&rank, sizeof rank, 0) % num_;
+  }
+
+  // Unscrambled rank, 0 is the most popular item.
+  uint64_t NextRank(Random64* rnd) const {
+    double u = NextDouble(rnd);
+    double uz = u * zetan_;
+    uint64_t rank;
+    if (uz < 1) {
+      rank = 0;
+    } else if (uz < 1 + std::pow(0.5, theta_)) {
+      rank = 1;
+    } else {
+      rank = static_cast<uint64_t>(num_ *
+                                   std::pow(eta_ * u - eta_ + 1, alpha_));
+    }
+    return std::min(rank, num_ - 1);
+  }
+
+ private:
+  static double Zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; ++i) {
+      sum += 1 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+  }
+
+  uint64_t num_;
+  double theta_;
+  double zetan_;
+  double alpha_;
+  double eta_;
+};
+
+// Key ids of the workload benchmark, following --workload_key_dist.
+class WorkloadKeyGenerator {
+ public:
+  enum Distribution { kUniform, kZipfian, kHotspot, kLatest };
+
+  WorkloadKeyGenerator(Distribution dist, uint64_t num)
+      : dist_(dist), num_(std::max<uint64_t>(num, 1)), latest_(num_) {
+    if (dist_ == kZipfian || dist_ == kLatest) {
+      zipf_.reset(new ZipfianGenerator(num_, FLAGS_zipf_theta));
+    }
+    hot_keys_ = std::max<uint64_t>(
+        static_cast<uint64_t>(num_ * FLAGS_workload_hotspot_key_fraction), 1);
+    hot_keys_ = std::min(hot_keys_, num_);
+  }
+
+  static bool Parse(const std::string& name, Distribution* dist) {
+    if (name == "uniform") {
+      *dist = kUniform;
+    } else if (name == "zipfian") {
+      *dist = kZipfian;
+    } else if (name == "hotspot") {
+      *dist = kHotspot;
+    } else if (name == "latest") {
+      *dist = kLatest;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // Key read, merged or deleted by the next operation.
+  uint64_t NextKey(Random64* rnd) const {
+    switch (dist_) {
+      case kZipfian:
+        return zipf_->Next(rnd);
+      case kHotspot:
+        if (hot_keys_ < num_ &&
+            NextDouble(rnd) >= FLAGS_workload_hotspot_op_fraction) {
+          return hot_keys_ + rnd->Next() % (num_ - hot_keys_);
+        }
+        return rnd->Next() % hot_keys_;
+      case kLatest: {
+        uint64_t latest = latest_.load(std::memory_order_relaxed);
+        uint64_t rank = zipf_->NextRank(rnd);
+        return rank < latest ? latest - 1 - rank : 0;
+      }
+      default:
+        return rnd->Next() % num_;
+    }
+  }
+
+  // Key written by the next put. Only the latest distribution inserts new
+  // keys, the others overwrite keys of the loaded key space.
+  uint64_t NextPutKey(Random64* rnd) {
+    if (dist_ == kLatest) {
+      return latest_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return NextKey(rnd);
+  }
+
+ private:
+  Distribution dist_;
+  uint64_t num_;
+  uint64_t hot_keys_;
+  std::atomic<uint64_t> latest_;
+  std::unique_ptr<ZipfianGenerator> zipf_;
+};
+
+// Value sizes of the workload benchmark, following --workload_value_size_dist.
+// The size is derived from the key id so that a key keeps its size across
+// overwrites, like rows of a production table.
+class WorkloadValueSizeGenerator {
+ public:
+  enum Distribution { kFixed, kUniform, kPareto };
+
+  explicit WorkloadValueSizeGenerator(Distribution dist) : dist_(dist) {}
+
+  static bool Parse(const std::string& name, Distribution* dist) {
+    if (name == "fixed") {
+      *dist = kFixed;
+    } else if (name == "uniform") {
+      *dist = kUniform;
+    } else if (name == "pareto") {
+      *dist = kPareto;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  unsigned int Size(uint64_t key_id) const {
+    if (dist_ == kFixed) {
+      return FLAGS_value_size;
+    }
+    uint64_t min_size = FLAGS_workload_value_size_min;
+    uint64_t max_size = FLAGS_workload_value_size_max;
+    uint64_t h = XXH64(&key_id, sizeof key_id, FLAGS_seed);
+    if (dist_ == kUniform) {
+      return static_cast<unsigned int>(min_size +
+                                       h % (max_size - min_size + 1));
+    }
+    double u = (h >> 11) * (1.0 / (uint64_t(1) << 53));
+    double size = min_size * std::pow(
+        1 - u, -1 / FLAGS_workload_value_size_pareto_alpha);
+    return static_cast<unsigned int>(
+        std::min(size, static_cast<double>(max_size)));
+  }
+
+ private:
+  Distribution dist_;
+};
+
 static void AppendWithSpace(std::string* str, Slice msg) {
   if (msg.empty()) return;
   if (!str->empty()) {
@@ -1535,6 +1813,8 @@ enum OperationType : unsigned char {
   kUncompress,
   kCrc,
   kHash,
+  kMultiGet,
+  kDeleteRange,
   kOthers
 };
 
@@ -1544,8 +1824,85 @@ static std::unordered_map<OperationType, std::string, std::hash<unsigned char>>
                            {kMerge, "merge"},       {kUpdate, "update"},
                            {kCompress, "compress"}, {kCompress, "uncompress"},
                            {kCrc, "crc"},           {kHash, "hash"},
+                           {kMultiGet, "multiget"}, {kDeleteRange, "deleterange"},
                            {kOthers, "op"}};
 
+// Counts the work done by KV separation garbage collection
+class GarbageCollectionListener : public EventListener {
+ public:
+  void OnCompactionCompleted(DB* /*db*/, const CompactionJobInfo& ci) override {
+    if (ci.compaction_reason == CompactionReason::kGarbageCollection) {
+      num_jobs.fetch_add(1, std::memory_order_relaxed);
+      input_bytes.fetch_add(ci.stats.total_input_bytes,
+                            std::memory_order_relaxed);
+      output_bytes.fetch_add(ci.stats.total_output_bytes,
+                             std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<uint64_t> num_jobs{0};
+  std::atomic<uint64_t> input_bytes{0};
+  std::atomic<uint64_t> output_bytes{0};
+};
+
+static std::shared_ptr<GarbageCollectionListener> gc_listener =
+    std::make_shared<GarbageCollectionListener>();
+
+// Reports how KV separation and lazy compaction are doing. Garbage
+// collection throughput covers the time since the previous report, space
+// amplification compares the SSTs on disk with num keys of key_size +
+// value_size bytes, which assumes the benchmark overwrites a filled DB.
+class SeparationStatsReporter {
+ public:
+  SeparationStatsReporter() { Reset(); }
+
+  void Reset() {
+    last_micros_ = FLAGS_env->NowMicros();
+    last_gc_input_bytes_ = gc_listener->input_bytes.load();
+    last_gc_output_bytes_ = gc_listener->output_bytes.load();
+  }
+
+  std::string Report(DB* db) {
+    uint64_t now = FLAGS_env->NowMicros();
+    double seconds = std::max<uint64_t>(now - last_micros_, 1) * 1e-6;
+    uint64_t gc_input_bytes = gc_listener->input_bytes.load();
+    uint64_t gc_output_bytes = gc_listener->output_bytes.load();
+    uint64_t blob_size = 0, blob_entries = 0, blob_antiquation = 0;
+    uint64_t live_size = 0;
+    std::string read_amp = "n/a";
+    db->GetIntProperty(DB::Properties::kBlobFilesSize, &blob_size);
+    db->GetIntProperty(DB::Properties::kBlobNumEntries, &blob_entries);
+    db->GetIntProperty(DB::Properties::kBlobNumAntiquation,
+                       &blob_antiquation);
+    db->GetIntProperty(DB::Properties::kLiveSstFilesSize, &live_size);
+    db->GetProperty(DB::Properties::kReadAmplification, &read_amp);
+    double logical_size =
+        static_cast<double>(FLAGS_num) * (FLAGS_key_size + FLAGS_value_size);
+
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "GC jobs: %" PRIu64 " (%.1f MB/s in, %.1f MB/s out), "
+             "blob: %.1f MB (garbage ratio %.3f), read amp: %s, "
+             "space amp: %.2f",
+             gc_listener->num_jobs.load(),
+             (gc_input_bytes - last_gc_input_bytes_) / 1048576.0 / seconds,
+             (gc_output_bytes - last_gc_output_bytes_) / 1048576.0 / seconds,
+             blob_size / 1048576.0,
+             blob_entries == 0 ? 0.0 : double(blob_antiquation) / blob_entries,
+             read_amp.c_str(),
+             logical_size == 0 ? 0.0 : live_size / logical_size);
+    last_micros_ = now;
+    last_gc_input_bytes_ = gc_input_bytes;
+    last_gc_output_bytes_ = gc_output_bytes;
+    return buf;
+  }
+
+ private:
+  uint64_t last_micros_;
+  uint64_t last_gc_input_bytes_;
+  uint64_t last_gc_output_bytes_;
+};
+
 class CombinedStats;
 class Stats {
  private:
@@ -1559,6 +1916,7 @@ class Stats {
   uint64_t next_report_;
   uint64_t bytes_;
   uint64_t last_op_finish_;
+  uint64_t intended_start_;
   uint64_t last_report_finish_;
   std::unordered_map<OperationType, std::shared_ptr<HistogramImpl>,
                      std::hash<unsigned char>>
@@ -1566,6 +1924,7 @@ class Stats {
   std::string message_;
   bool exclude_from_merge_;
   ReporterAgent* reporter_agent_;  // does not own
+  SeparationStatsReporter separation_reporter_;
   friend class CombinedStats;
 
  public:
@@ -1579,6 +1938,7 @@ class Stats {
     id_ = id;
     next_report_ = FLAGS_stats_interval ? FLAGS_stats_interval : 100;
     last_op_finish_ = start_;
+    intended_start_ = 0;
     hist_.clear();
     done_ = 0;
     last_report_done_ = 0;
@@ -1591,6 +1951,7 @@ class Stats {
     message_.clear();
     // When set, stats from this thread won't be merged with others.
     exclude_from_merge_ = false;
+    separation_reporter_.Reset();
   }
 
   void Merge(const Stats& other) {
@@ -1666,6 +2027,11 @@ class Stats {
     last_op_finish_ = FLAGS_env->NowMicros();
   }
 
+  // Measure the latency of the next op from `micros`, the time an open loop
+  // schedule wanted it to start, instead of from the end of the previous op.
+  // An op that is late because earlier ops stalled is charged for the wait.
+  void SetIntendedStart(uint64_t micros) { intended_start_ = micros; }
+
   void FinishedOps(DBWithColumnFamilies* db_with_cfh, DB* db, int64_t num_ops,
                    enum OperationType op_type = kOthers) {
     if (reporter_agent_) {
@@ -1673,7 +2039,9 @@ class Stats {
     }
     if (FLAGS_histogram) {
       uint64_t now = FLAGS_env->NowMicros();
-      uint64_t micros = now - last_op_finish_;
+      uint64_t micros =
+          now - (intended_start_ != 0 ? intended_start_ : last_op_finish_);
+      intended_start_ = 0;
 
       if (hist_.find(op_type) == hist_.end()) {
         auto hist_temp = std::make_shared<HistogramImpl>();
@@ -1772,6 +2140,10 @@ class Stats {
             }
           }
 
+          if (id_ == 0 && FLAGS_separation_stats_per_interval && db) {
+            fprintf(stderr, "%s\n", separation_reporter_.Report(db).c_str());
+          }
+
           next_report_ += FLAGS_stats_interval;
           last_report_finish_ = now;
           last_report_done_ = done_;
@@ -1786,6 +2158,10 @@ class Stats {
 
   void AddBytes(int64_t n) { bytes_ += n; }
 
+  void AddSeparationStats(DB* db) {
+    AddMessage(separation_reporter_.Report(db));
+  }
+
   void Report(const Slice& name) {
     // Pretend at least one op was done in case we are running a benchmark
     // that does not call FinishedOps().
@@ -2063,6 +2439,11 @@ class Benchmark {
   };
 
   std::shared_ptr<ErrorHandlerListener> listener_;
+  // Key distribution of updatezipfianwithgc
+  std::unique_ptr<ZipfianGenerator> zipf_;
+  // Key and value size distributions of workload
+  std::unique_ptr<WorkloadKeyGenerator> workload_keys_;
+  std::unique_ptr<WorkloadValueSizeGenerator> workload_value_sizes_;
 
   bool SanityCheck() {
     if (FLAGS_compression_ratio > 1) {
@@ -2311,9 +2692,11 @@ class Benchmark {
       }
       return cache;
     } else {
-      return NewLRUCache((size_t)capacity, FLAGS_cache_numshardbits,
-                         false /*strict_capacity_limit*/,
-                         FLAGS_cache_high_pri_pool_ratio);
+      LRUCacheOptions cache_opts((size_t)capacity, FLAGS_cache_numshardbits,
+                                 false /*strict_capacity_limit*/,
+                                 FLAGS_cache_high_pri_pool_ratio);
+      cache_opts.numa_aware = FLAGS_numa_aware;
+      return NewLRUCache(cache_opts);
     }
   }
 
@@ -2622,6 +3005,63 @@ class Benchmark {
         method = &Benchmark::MultiWriteUniqueRandom;
       } else if (name == "overwrite") {
         method = &Benchmark::WriteRandom;
+      } else if (name == "overwriteseparated") {
+        if (static_cast<uint64_t>(value_size_) < FLAGS_blob_size) {
+          fprintf(stderr,
+                  "overwriteseparated needs value_size >= blob_size, values "
+                  "would not be separated\n");
+          exit(1);
+        }
+        method = &Benchmark::OverwriteSeparated;
+      } else if (name == "updatezipfianwithgc") {
+        zipf_.reset(new ZipfianGenerator(FLAGS_num, FLAGS_zipf_theta));
+        method = &Benchmark::UpdateZipfianWithGC;
+      } else if (name == "scanseparated") {
+        method = &Benchmark::ScanSeparated;
+      } else if (name == "workload") {
+        WorkloadKeyGenerator::Distribution key_dist;
+        WorkloadValueSizeGenerator::Distribution value_size_dist;
+        if (!WorkloadKeyGenerator::Parse(FLAGS_workload_key_dist, &key_dist)) {
+          fprintf(stderr, "unknown workload_key_dist %s\n",
+                  FLAGS_workload_key_dist.c_str());
+          exit(1);
+        }
+        if (!WorkloadValueSizeGenerator::Parse(FLAGS_workload_value_size_dist,
+                                               &value_size_dist)) {
+          fprintf(stderr, "unknown workload_value_size_dist %s\n",
+                  FLAGS_workload_value_size_dist.c_str());
+          exit(1);
+        }
+        if (value_size_dist != WorkloadValueSizeGenerator::kFixed &&
+            (FLAGS_workload_value_size_min <= 0 ||
+             FLAGS_workload_value_size_min > FLAGS_workload_value_size_max ||
+             FLAGS_workload_value_size_max >
+                 std::max(1048576, FLAGS_value_size))) {
+          fprintf(stderr,
+                  "workload_value_size_min and workload_value_size_max must "
+                  "satisfy 0 < min <= max <= max(1MB, value_size)\n");
+          exit(1);
+        }
+        if (FLAGS_workload_merge_ratio > 0 && FLAGS_merge_operator.empty()) {
+          fprintf(stderr, "workload_merge_ratio needs --merge_operator\n");
+          exit(1);
+        }
+        if (FLAGS_workload_get_ratio < 0 || FLAGS_workload_put_ratio < 0 ||
+            FLAGS_workload_merge_ratio < 0 || FLAGS_workload_seek_ratio < 0 ||
+            FLAGS_workload_delete_range_ratio < 0 ||
+            FLAGS_workload_multiget_ratio < 0 ||
+            FLAGS_workload_get_ratio + FLAGS_workload_put_ratio +
+                    FLAGS_workload_merge_ratio + FLAGS_workload_seek_ratio +
+                    FLAGS_workload_delete_range_ratio +
+                    FLAGS_workload_multiget_ratio <=
+                0) {
+          fprintf(stderr, "workload_*_ratio must be >= 0 with a positive sum\n");
+          exit(1);
+        }
+        workload_keys_.reset(new WorkloadKeyGenerator(key_dist, FLAGS_num));
+        workload_value_sizes_.reset(
+            new WorkloadValueSizeGenerator(value_size_dist));
+        method = &Benchmark::Workload;
       } else if (name == "fillsync") {
         fresh_db = true;
         num_ /= 1000;
@@ -2857,6 +3297,10 @@ class Benchmark {
     }
 #endif  // ROCKSDB_LITE
 
+    if (FLAGS_io_heatmap_sample_period > 0) {
+      DumpIOHeatmap();
+    }
+
     if (FLAGS_statistics) {
       fprintf(stdout, "STATISTICS:\n%s\n", dbstats->ToString().c_str());
     }
@@ -2869,6 +3313,34 @@ class Benchmark {
   }
 
  private:
+  void DumpIOHeatmap() {
+    // Each DB samples into its own heatmap, only the first one is reported
+    // with --num_multi_db.
+    DB* db = db_.db != nullptr
+                 ? db_.db
+                 : (multi_dbs_.empty() ? nullptr : multi_dbs_[0].db);
+    if (db == nullptr) {
+      return;
+    }
+    std::string heatmap;
+    if (db->GetProperty(DB::Properties::kIOHeatmap, &heatmap)) {
+      fprintf(stdout, "%s\n", heatmap.c_str());
+    }
+    if (FLAGS_io_heatmap_dump_file.empty()) {
+      return;
+    }
+    std::string samples;
+    if (!db->GetProperty(DB::Properties::kIOHeatmapSamples, &samples)) {
+      return;
+    }
+    Status s = WriteStringToFile(FLAGS_env, samples,
+                                 FLAGS_io_heatmap_dump_file, true);
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to write I/O heatmap samples to %s: %s\n",
+              FLAGS_io_heatmap_dump_file.c_str(), s.ToString().c_str());
+    }
+  }
+
   std::shared_ptr<TimestampEmulator> timestamp_emulator_;
 
   struct ThreadArg {
@@ -3514,6 +3986,9 @@ class Benchmark {
     }
     options.max_successive_merges = FLAGS_max_successive_merges;
     options.report_bg_io_stats = FLAGS_report_bg_io_stats;
+    options.io_heatmap_sample_period =
+        static_cast<uint32_t>(FLAGS_io_heatmap_sample_period);
+    options.numa_aware = FLAGS_numa_aware;
 
     // set universal style compaction configurations, if applicable
     if (FLAGS_universal_size_ratio != 0) {
@@ -3617,6 +4092,7 @@ class Benchmark {
     }
 
     options.listeners.emplace_back(listener_);
+    options.listeners.emplace_back(gc_listener);
     if (FLAGS_num_multi_db <= 1) {
       OpenDb(options, FLAGS_db, &db_);
     } else {
@@ -5123,6 +5599,263 @@ class Benchmark {
     thread->stats.AddMessage(msg);
   }
 
+  void OverwriteSeparated(ThreadState* thread) {
+    DoWrite(thread, RANDOM);
+    if (thread->tid == 0) {
+      thread->stats.AddSeparationStats(SelectDB(thread));
+    }
+  }
+
+  // Overwrites Zipfian skewed keys. Values of hot keys turn into garbage much
+  // faster than those of cold keys, so blob SSTs end up with uneven garbage
+  // ratios for garbage collection to pick from.
+  void UpdateZipfianWithGC(ThreadState* thread) {
+    RandomGenerator gen;
+    int64_t bytes = 0;
+    Duration duration(FLAGS_duration, writes_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      GenerateKeyFromInt(zipf_->Next(&thread->rand), FLAGS_num, &key, -1);
+
+      if (thread->shared->write_rate_limiter) {
+        thread->shared->write_rate_limiter->Request(
+            key.size() + value_size_, Env::IO_HIGH, nullptr /*stats*/,
+            RateLimiter::OpType::kWrite);
+      }
+
+      Status s = db->Put(write_options_, key, gen.Generate(value_size_));
+      if (!s.ok()) {
+        fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+        exit(1);
+      }
+      bytes += key.size() + value_size_;
+      thread->stats.FinishedOps(nullptr, db, 1, kUpdate);
+    }
+    thread->stats.AddBytes(bytes);
+    if (thread->tid == 0) {
+      thread->stats.AddSeparationStats(SelectDB(thread));
+    }
+  }
+
+  // Seeks to random keys and reads seek_nexts values after each seek. With
+  // KV separation each value is fetched from its blob SST, scan_key_only
+  // runs the same scans without fetching them.
+  void ScanSeparated(ThreadState* thread) {
+    ReadOptions options(FLAGS_verify_checksum, true);
+    options.key_only = FLAGS_scan_key_only;
+    int64_t read = 0;
+    int64_t bytes = 0;
+    Duration duration(FLAGS_duration, reads_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+    char value_buffer[256];
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      std::unique_ptr<Iterator> iter(db->NewIterator(options));
+      GenerateKeyFromInt(thread->rand.Next() % FLAGS_num, FLAGS_num, &key, -1);
+      iter->Seek(key);
+      for (int j = 0; j < std::max(FLAGS_seek_nexts, 1) && iter->Valid();
+           ++j) {
+        // Copy out iterator's value to make sure we read them.
+        Slice value = iter->value();
+        memcpy(value_buffer, value.data(),
+               std::min(value.size(), sizeof(value_buffer)));
+        bytes += iter->key().size() + value.size();
+        ++read;
+        iter->Next();
+      }
+      if (!iter->status().ok()) {
+        fprintf(stderr, "scan error: %s\n", iter->status().ToString().c_str());
+        exit(1);
+      }
+      thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+    }
+    char msg[100];
+    snprintf(msg, sizeof(msg), "(%" PRIu64 " values read)", read);
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(msg);
+    if (thread->tid == 0) {
+      thread->stats.AddSeparationStats(SelectDB(thread));
+    }
+  }
+
+  // Runs the operation mix of the workload_*_ratio flags over keys drawn from
+  // workload_key_dist. With workload_qps each thread issues its share of the
+  // target rate on a fixed schedule, whether or not earlier operations have
+  // finished in time, and the histograms measure latency from the scheduled
+  // start of each operation.
+  void Workload(ThreadState* thread) {
+    enum WorkloadOp {
+      kWorkloadGet,
+      kWorkloadPut,
+      kWorkloadMerge,
+      kWorkloadSeek,
+      kWorkloadDeleteRange,
+      kWorkloadMultiGet,
+      kNumWorkloadOps
+    };
+    const double weights[kNumWorkloadOps] = {
+        FLAGS_workload_get_ratio,          FLAGS_workload_put_ratio,
+        FLAGS_workload_merge_ratio,        FLAGS_workload_seek_ratio,
+        FLAGS_workload_delete_range_ratio, FLAGS_workload_multiget_ratio};
+    double total_weight = 0;
+    for (double w : weights) {
+      total_weight += w;
+    }
+
+    ReadOptions options(FLAGS_verify_checksum, true);
+    RandomGenerator gen;
+    std::string value;
+    int64_t counts[kNumWorkloadOps] = {};
+    int64_t found = 0;
+    int64_t bytes = 0;
+    int64_t behind_schedule = 0;
+    Duration duration(FLAGS_duration, readwrites_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+    std::unique_ptr<const char[]> end_key_guard;
+    Slice end_key = AllocateKey(&end_key_guard);
+    std::vector<Slice> keys;
+    std::vector<std::unique_ptr<const char[]>> key_guards;
+    std::vector<std::string> values;
+    while (static_cast<int64_t>(keys.size()) < entries_per_batch_) {
+      key_guards.push_back(std::unique_ptr<const char[]>());
+      keys.push_back(AllocateKey(&key_guards.back()));
+    }
+
+    // Micros between two scheduled operations of this thread, 0 for closed
+    // loop.
+    double interval = 0;
+    if (FLAGS_workload_qps > 0) {
+      interval = 1e6 * thread->shared->total / FLAGS_workload_qps;
+    }
+    double next_start = static_cast<double>(FLAGS_env->NowMicros());
+
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      if (interval > 0) {
+        uint64_t intended = static_cast<uint64_t>(next_start);
+        uint64_t now = FLAGS_env->NowMicros();
+        if (now < intended) {
+          FLAGS_env->SleepForMicroseconds(static_cast<int>(intended - now));
+        } else if (now - intended > interval) {
+          ++behind_schedule;
+        }
+        thread->stats.SetIntendedStart(intended);
+        next_start += FLAGS_workload_poisson_arrivals
+                          ? -std::log(1 - NextDouble(&thread->rand)) * interval
+                          : interval;
+      }
+
+      double pick = NextDouble(&thread->rand) * total_weight;
+      int op = 0;
+      while (op < kNumWorkloadOps - 1 && pick >= weights[op]) {
+        pick -= weights[op];
+        ++op;
+      }
+      // Zero weight ops are never picked, even by rounding at the end.
+      while (weights[op] <= 0) {
+        --op;
+      }
+      ++counts[op];
+
+      Status s;
+      switch (op) {
+        case kWorkloadGet: {
+          GenerateKeyFromInt(workload_keys_->NextKey(&thread->rand), FLAGS_num,
+                             &key, -1);
+          s = db->Get(options, key, &value);
+          if (s.ok()) {
+            ++found;
+            bytes += key.size() + value.size();
+          }
+          thread->stats.FinishedOps(nullptr, db, 1, kRead);
+          break;
+        }
+        case kWorkloadPut:
+        case kWorkloadMerge: {
+          uint64_t key_id = op == kWorkloadPut
+                                ? workload_keys_->NextPutKey(&thread->rand)
+                                : workload_keys_->NextKey(&thread->rand);
+          GenerateKeyFromInt(key_id, FLAGS_num, &key, -1);
+          Slice val = gen.Generate(workload_value_sizes_->Size(key_id));
+          if (op == kWorkloadPut) {
+            s = db->Put(write_options_, key, val);
+          } else {
+            s = db->Merge(write_options_, key, val);
+          }
+          bytes += key.size() + val.size();
+          thread->stats.FinishedOps(nullptr, db, 1,
+                                    op == kWorkloadPut ? kWrite : kMerge);
+          break;
+        }
+        case kWorkloadSeek: {
+          GenerateKeyFromInt(workload_keys_->NextKey(&thread->rand), FLAGS_num,
+                             &key, -1);
+          std::unique_ptr<Iterator> iter(db->NewIterator(options));
+          iter->Seek(key);
+          for (int j = 0; j < FLAGS_seek_nexts && iter->Valid(); ++j) {
+            bytes += iter->key().size() + iter->value().size();
+            iter->Next();
+          }
+          if (iter->Valid()) {
+            ++found;
+          }
+          s = iter->status();
+          thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+          break;
+        }
+        case kWorkloadDeleteRange: {
+          uint64_t begin = workload_keys_->NextKey(&thread->rand);
+          GenerateKeyFromInt(begin, FLAGS_num, &key, -1);
+          GenerateKeyFromInt(begin + range_tombstone_width_, FLAGS_num,
+                             &end_key, -1);
+          s = db->DeleteRange(write_options_, db->DefaultColumnFamily(), key,
+                              end_key);
+          thread->stats.FinishedOps(nullptr, db, 1, kDeleteRange);
+          break;
+        }
+        case kWorkloadMultiGet: {
+          for (int64_t i = 0; i < entries_per_batch_; ++i) {
+            GenerateKeyFromInt(workload_keys_->NextKey(&thread->rand),
+                               FLAGS_num, &keys[i], -1);
+          }
+          std::vector<Status> statuses = db->MultiGet(options, keys, &values);
+          for (size_t i = 0; i < statuses.size(); ++i) {
+            if (statuses[i].ok()) {
+              ++found;
+              bytes += keys[i].size() + values[i].size();
+            } else if (!statuses[i].IsNotFound()) {
+              s = statuses[i];
+            }
+          }
+          thread->stats.FinishedOps(nullptr, db, 1, kMultiGet);
+          break;
+        }
+      }
+      if (!s.ok() && !s.IsNotFound()) {
+        fprintf(stderr, "workload error: %s\n", s.ToString().c_str());
+        exit(1);
+      }
+    }
+
+    char msg[256];
+    snprintf(msg, sizeof(msg),
+             "( gets:%" PRIi64 " puts:%" PRIi64 " merges:%" PRIi64
+             " seeks:%" PRIi64 " deleteranges:%" PRIi64 " multigets:%" PRIi64
+             " found:%" PRIi64 " behind schedule:%" PRIi64 ")",
+             counts[kWorkloadGet], counts[kWorkloadPut], counts[kWorkloadMerge],
+             counts[kWorkloadSeek], counts[kWorkloadDeleteRange],
+             counts[kWorkloadMultiGet], found, behind_schedule);
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(msg);
+  }
+
   // Read-XOR-write for random keys. Xors the existing value with a randomly
   // generated value, and stores the result. Assuming A in the array of bytes
   // representing the existing value, we generate an array B of the same size,
@@ -5754,10 +6487,31 @@ class Benchmark {
     }
     Replayer replayer(db_with_cfh->db, db_with_cfh->cfh,
                       std::move(trace_reader));
-    s = replayer.Replay();
+    TraceReplayOptions replay_options;
+    replay_options.num_threads = FLAGS_trace_replay_threads;
+    replay_options.fast_forward = FLAGS_trace_replay_fast_forward;
+    replay_options.sharding = FLAGS_trace_replay_shard_by_thread
+                                  ? TraceReplayOptions::kShardByThread
+                                  : TraceReplayOptions::kShardByKey;
+    std::map<TraceType, std::shared_ptr<HistogramImpl>> latencies;
+    s = replayer.MultiThreadReplay(replay_options, &latencies);
     if (s.ok()) {
       fprintf(stdout, "Replay started from trace_file: %s\n",
               FLAGS_trace_file.c_str());
+      if (FLAGS_histogram) {
+        static const std::map<TraceType, std::string> kTraceTypeNames = {
+            {kTraceWrite, "write"},
+            {kTraceGet, "get"},
+            {kTraceIteratorSeek, "seek"},
+            {kTraceIteratorSeekForPrev, "seekforprev"},
+            {kTraceMultiGet, "multiget"}};
+        for (auto& pair : latencies) {
+          auto name = kTraceTypeNames.find(pair.first);
+          fprintf(stdout, "Microseconds per replayed %s:\n%s\n",
+                  name != kTraceTypeNames.end() ? name->second.c_str() : "op",
+                  pair.second->ToString().c_str());
+        }
+      }
     } else {
       fprintf(stderr, "Starting replay failed. Error: %s\n",
               s.ToString().c_str());
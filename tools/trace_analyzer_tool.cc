@@ -273,6 +273,7 @@ TraceAnalyzer::TraceAnalyzer(std::string& trace_path, std::string& output_path,
       analyzer_opts_(_analyzer_opts) {
   rocksdb::EnvOptions env_options;
   env_ = rocksdb::Env::Default();
+  trace_has_thread_id_ = false;
   offset_ = 0;
   c_time_ = 0;
   total_requests_ = 0;
@@ -390,6 +391,7 @@ Status TraceAnalyzer::PrepareProcessing() {
 
 Status TraceAnalyzer::ReadTraceHeader(Trace* header) {
   assert(header != nullptr);
+  trace_has_thread_id_ = false;
   Status s = ReadTraceRecord(header);
   if (!s.ok()) {
     return s;
@@ -400,6 +402,7 @@ Status TraceAnalyzer::ReadTraceHeader(Trace* header) {
   if (header->payload.substr(0, kTraceMagic.length()) != kTraceMagic) {
     return Status::Corruption("Corrupted trace file. Incorrect magic.");
   }
+  trace_has_thread_id_ = TraceHasThreadId(*header);
 
   return s;
 }
@@ -424,12 +427,7 @@ Status TraceAnalyzer::ReadTraceRecord(Trace* trace) {
     return s;
   }
 
-  Slice enc_slice = Slice(encoded_trace);
-  GetFixed64(&enc_slice, &trace->ts);
-  trace->type = static_cast<TraceType>(enc_slice[0]);
-  enc_slice.remove_prefix(kTraceTypeSize + kTracePayloadLengthSize);
-  trace->payload = enc_slice.ToString();
-  return s;
+  return DecodeTrace(encoded_trace, trace_has_thread_id_, trace);
 }
 
 // process the trace itself and redirect the trace content
@@ -199,6 +199,7 @@ class TraceAnalyzer {
   rocksdb::Env* env_;
   EnvOptions env_options_;
   std::unique_ptr<TraceReader> trace_reader_;
+  bool trace_has_thread_id_;
   size_t offset_;
   char buffer_[1024];
   uint64_t c_time_;
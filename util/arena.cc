@@ -18,10 +18,14 @@
 #ifndef OS_WIN
 #include <sys/mman.h>
 #endif
+#ifdef NUMA
+#include <numa.h>
+#endif
 #include <algorithm>
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "util/logging.h"
+#include "util/numa_util.h"
 #include "util/sync_point.h"
 
 namespace rocksdb {
@@ -90,6 +94,13 @@ Arena::~Arena() {
     }
   }
 #endif
+#ifdef NUMA
+  for (const auto& numa_block : numa_blocks_) {
+    if (numa_block.addr_ != nullptr) {
+      numa_free(numa_block.addr_, numa_block.length_);
+    }
+  }
+#endif
 }
 
 char* Arena::AllocateFallback(size_t bytes, bool aligned) {
@@ -159,6 +170,27 @@ char* Arena::AllocateFromHugePage(size_t bytes) {
 #endif
 }
 
+char* Arena::AllocateOnCurrentNumaNode(size_t bytes) {
+  ++irregular_block_num;
+#ifdef NUMA
+  if (NumaNumNodes() > 1) {
+    // Reserve first so a throwing emplace_back can't leak the block
+    numa_blocks_.emplace_back(nullptr /* addr */, 0 /* length */);
+    void* addr = numa_alloc_local(bytes);
+    if (addr != nullptr) {
+      numa_blocks_.back() = MmapInfo(addr, bytes);
+      blocks_memory_ += bytes;
+      if (tracker_ != nullptr) {
+        tracker_->Allocate(bytes);
+      }
+      return reinterpret_cast<char*>(addr);
+    }
+    numa_blocks_.pop_back();
+  }
+#endif
+  return AllocateNewBlock(bytes);
+}
+
 char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
                              Logger* logger) {
   assert((kAlignUnit & (kAlignUnit - 1)) ==
@@ -59,6 +59,11 @@ class Arena : public Allocator {
   char* AllocateAligned(size_t bytes, size_t huge_page_size = 0,
                         Logger* logger = nullptr) override;
 
+  // Allocates a separate block of `bytes` whose pages are bound to the NUMA
+  // node of the calling thread. Falls back to a regular irregular block
+  // without NUMA support. Does not touch the current block.
+  char* AllocateOnCurrentNumaNode(size_t bytes);
+
   // Returns an estimate of the total memory usage of data allocated
   // by the arena (exclude the space allocated but not yet used for future
   // allocations).
@@ -96,6 +101,8 @@ class Arena : public Allocator {
     MmapInfo(void* addr, size_t length) : addr_(addr), length_(length) {}
   };
   std::vector<MmapInfo> huge_blocks_;
+  // Blocks of AllocateOnCurrentNumaNode(), released by numa_free()
+  std::vector<MmapInfo> numa_blocks_;
   size_t irregular_block_num = 0;
 
   // Stats for current active block.
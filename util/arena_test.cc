@@ -8,6 +8,11 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "util/arena.h"
+
+#include <string.h>
+#include <vector>
+
+#include "util/concurrent_arena.h"
 #include "util/random.h"
 #include "util/testharness.h"
 
@@ -196,6 +201,31 @@ TEST_F(ArenaTest, Simple) {
   SimpleTest(0);
   SimpleTest(kHugePageSize);
 }
+
+TEST_F(ArenaTest, NumaLocalConcurrentArena) {
+  const size_t kBlockSize = 64 * 1024;
+  ConcurrentArena arena(kBlockSize, nullptr /*tracker*/, 0 /*huge_page_size*/,
+                        true /*numa_local*/);
+  std::vector<std::pair<char*, size_t>> allocated;
+  Random rnd(301);
+  size_t total = 0;
+  for (int i = 0; i < 2000; ++i) {
+    size_t bytes = 1 + rnd.Uniform(200);
+    char* p = i % 2 == 0 ? arena.Allocate(bytes) : arena.AllocateAligned(bytes);
+    memset(p, i % 256, bytes);
+    allocated.emplace_back(p, bytes);
+    total += bytes;
+  }
+  for (size_t i = 0; i < allocated.size(); ++i) {
+    for (size_t b = 0; b < allocated[i].second; ++b) {
+      ASSERT_EQ(static_cast<char>(i % 256), allocated[i].first[b]);
+    }
+  }
+  // Small allocations are served by shard blocks of their own
+  ASSERT_GT(arena.IrregularBlockNum(), 0);
+  ASSERT_GE(arena.MemoryAllocatedBytes(), total);
+  ASSERT_GE(arena.ApproximateMemoryUsage(), total);
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -43,9 +43,14 @@ class ConcurrentArena : public Allocator {
   // in fact just passed to the constructor of arena_.  The core-local
   // shards compute their shard_block_size as a fraction of block_size
   // that varies according to the hardware concurrency level.
+  //
+  // If numa_local is true, small allocations always go through the shard
+  // of the current core, and every shard block is a separate allocation
+  // bound to the NUMA node of the thread that refills it, so the memory a
+  // writer fills is local to the node it runs on.
   explicit ConcurrentArena(size_t block_size = Arena::kMinBlockSize,
                            AllocTracker* tracker = nullptr,
-                           size_t huge_page_size = 0);
+                           size_t huge_page_size = 0, bool numa_local = false);
 
   char* Allocate(size_t bytes) override {
     return AllocateImpl(bytes, false /*force_arena*/,
@@ -103,6 +108,7 @@ class ConcurrentArena : public Allocator {
   char padding0[56] ROCKSDB_FIELD_UNUSED;
 
   size_t shard_block_size_;
+  const bool numa_local_;
 
   CoreLocalArray<Shard> shards_;
 
@@ -135,7 +141,7 @@ class ConcurrentArena : public Allocator {
     // concurrency zero unless it might actually confer an advantage.
     std::unique_lock<SpinMutex> arena_lock(arena_mutex_, std::defer_lock);
     if (bytes > shard_block_size_ / 4 || force_arena ||
-        ((cpu = tls_cpuid) == 0 &&
+        ((cpu = tls_cpuid) == 0 && !numa_local_ &&
          !shards_.AccessAtCore(0)->allocated_and_unused_.load(
              std::memory_order_relaxed) &&
          arena_lock.try_lock())) {
@@ -148,7 +154,8 @@ class ConcurrentArena : public Allocator {
     }
 
     // pick a shard from which to allocate
-    Shard* s = shards_.AccessAtCore(cpu & (shards_.Size() - 1));
+    Shard* s = numa_local_ ? shards_.Access()
+                           : shards_.AccessAtCore(cpu & (shards_.Size() - 1));
     if (!s->mutex.try_lock()) {
       s = Repick();
       s->mutex.lock();
@@ -179,10 +186,15 @@ class ConcurrentArena : public Allocator {
         return rv;
       }
 
-      avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
-                  ? exact
-                  : shard_block_size_;
-      s->free_begin_ = arena_.AllocateAligned(avail);
+      if (numa_local_) {
+        avail = shard_block_size_;
+        s->free_begin_ = arena_.AllocateOnCurrentNumaNode(avail);
+      } else {
+        avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
+                    ? exact
+                    : shard_block_size_;
+        s->free_begin_ = arena_.AllocateAligned(avail);
+      }
       Fixup();
     }
     s->allocated_and_unused_.store(avail - bytes, std::memory_order_relaxed);
@@ -85,7 +85,9 @@ RandomAccessFileReader::RandomAccessFileReader(
       for_compaction_(for_compaction),
       file_read_hist_(file_read_hist),
       rate_limiter_(rate_limiter),
-      listeners_() {
+      listeners_(),
+      io_heatmap_(nullptr),
+      file_number_(0) {
 #ifndef ROCKSDB_LITE
   std::for_each(listeners.begin(), listeners.end(),
                 [this](const std::shared_ptr<EventListener>& e) {
@@ -103,6 +105,8 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
                                     char* scratch) const {
   Status s;
   uint64_t elapsed = 0;
+  bool sample_io = io_heatmap_ != nullptr && io_heatmap_->ShouldSample();
+  uint64_t sample_start = sample_io ? env_->NowMicros() : 0;
   {
     StopWatch sw(env_, stats_, hist_type_,
                  (stats_ != nullptr) ? &elapsed : nullptr, true /*overwrite*/,
@@ -218,6 +222,11 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   if (stats_ != nullptr && file_read_hist_ != nullptr) {
     file_read_hist_->Add(elapsed);
   }
+  if (sample_io) {
+    io_heatmap_->Record(file_number_, offset, n,
+                        env_->NowMicros() - sample_start,
+                        false /* is_write */);
+  }
   return s;
 }
 
@@ -488,6 +497,9 @@ Status WritableFileWriter::WriteBuffered(const char* data, size_t size,
       IOSTATS_TIMER_GUARD(write_nanos);
       TEST_SYNC_POINT("WritableFileWriter::Flush:BeforeAppend");
 
+      bool sample_io = io_heatmap_ != nullptr && io_heatmap_->ShouldSample();
+      uint64_t sample_start = sample_io ? env_->NowMicros() : 0;
+      uint64_t sample_offset = sample_io ? writable_file_->GetFileSize() : 0;
 #ifndef ROCKSDB_LITE
       FileOperationInfo::TimePoint start_ts;
       uint64_t old_size = writable_file_->GetFileSize();
@@ -503,6 +515,9 @@ Status WritableFileWriter::WriteBuffered(const char* data, size_t size,
         NotifyOnFileWriteFinish(old_size, allowed, start_ts, finish_ts, s);
       }
 #endif
+      if (sample_io) {
+        RecordIOHeatmap(sample_offset, allowed, sample_start);
+      }
       if (!s.ok()) {
         return s;
       }
@@ -574,12 +589,17 @@ Status WritableFileWriter::WriteDirect() {
       if (ShouldNotifyListeners()) {
         start_ts = std::chrono::system_clock::now();
       }
+      bool sample_io = io_heatmap_ != nullptr && io_heatmap_->ShouldSample();
+      uint64_t sample_start = sample_io ? env_->NowMicros() : 0;
       // direct writes must be positional
       s = writable_file_->PositionedAppend(Slice(src, size), write_offset);
       if (ShouldNotifyListeners()) {
         auto finish_ts = std::chrono::system_clock::now();
         NotifyOnFileWriteFinish(write_offset, size, start_ts, finish_ts, s);
       }
+      if (sample_io) {
+        RecordIOHeatmap(write_offset, size, sample_start);
+      }
       if (!s.ok()) {
         buf_.Size(file_advance + leftover_tail);
         return s;
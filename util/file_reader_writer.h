@@ -15,6 +15,7 @@
 #include "rocksdb/listener.h"
 #include "rocksdb/rate_limiter.h"
 #include "util/aligned_buffer.h"
+#include "util/io_heatmap.h"
 #include "util/sync_point.h"
 
 namespace rocksdb {
@@ -94,6 +95,8 @@ class RandomAccessFileReader {
   HistogramImpl*  file_read_hist_;
   RateLimiter* rate_limiter_;
   std::vector<std::shared_ptr<EventListener>> listeners_;
+  IOHeatmap* io_heatmap_;
+  uint64_t file_number_;
 
  public:
   explicit RandomAccessFileReader(
@@ -119,6 +122,13 @@ class RandomAccessFileReader {
 
   const std::string& file_name() const { return file_name_; }
 
+  // Sample the reads of this file, which is SST `file_number`, into
+  // `io_heatmap`. Needs an env to time the reads.
+  void SetIOHeatmap(IOHeatmap* io_heatmap, uint64_t file_number) {
+    io_heatmap_ = env_ != nullptr ? io_heatmap : nullptr;
+    file_number_ = file_number;
+  }
+
   void set_use_fsread(bool b) { use_fsread_ = b; }
   bool use_fsread() const { return use_fsread_; }
   bool use_direct_io() const { return file_->use_direct_io(); }
@@ -164,6 +174,14 @@ class WritableFileWriter {
   RateLimiter*            rate_limiter_;
   Statistics* stats_;
   std::vector<std::shared_ptr<EventListener>> listeners_;
+  IOHeatmap* io_heatmap_;
+  uint64_t file_number_;
+  Env* env_;
+
+  void RecordIOHeatmap(uint64_t offset, size_t size, uint64_t start_micros) {
+    io_heatmap_->Record(file_number_, offset, size,
+                        env_->NowMicros() - start_micros, true /* is_write */);
+  }
 
  public:
   WritableFileWriter(
@@ -183,7 +201,10 @@ class WritableFileWriter {
         bytes_per_sync_(options.bytes_per_sync),
         rate_limiter_(options.rate_limiter),
         stats_(stats),
-        listeners_() {
+        listeners_(),
+        io_heatmap_(nullptr),
+        file_number_(0),
+        env_(nullptr) {
     TEST_SYNC_POINT_CALLBACK("WritableFileWriter::WritableFileWriter:0",
                              reinterpret_cast<void*>(max_buffer_size_));
     buf_.Alignment(writable_file_->GetRequiredBufferAlignment());
@@ -208,6 +229,14 @@ class WritableFileWriter {
 
   const std::string& file_name() const { return file_name_; }
 
+  // Sample the writes of this file, which is SST `file_number`, into
+  // `io_heatmap`.
+  void SetIOHeatmap(IOHeatmap* io_heatmap, uint64_t file_number, Env* env) {
+    io_heatmap_ = io_heatmap;
+    file_number_ = file_number;
+    env_ = env;
+  }
+
   Status Append(const Slice& data);
 
   Status Pad(const size_t pad_bytes);
@@ -213,6 +213,10 @@ std::string IdentityFileName(const std::string& dbname) {
   return dbname + "/IDENTITY";
 }
 
+std::string TableWarmStateFileName(const std::string& dbname) {
+  return dbname + "/TABLE_WARM_STATE";
+}
+
 // Owned filenames have the form:
 //    dbname/IDENTITY
 //    dbname/CURRENT
@@ -251,6 +255,9 @@ bool ParseFileName(const std::string& fname, uint64_t* number,
   } else if (rest == "CONSOLE") {
     *number = 0;
     *type = kSocketFile;
+  } else if (rest == "TABLE_WARM_STATE") {
+    *number = 0;
+    *type = kTableWarmStateFile;
   } else if (info_log_name_prefix.size() > 0 &&
              rest.starts_with(info_log_name_prefix)) {
     rest.remove_prefix(info_log_name_prefix.size());
@@ -39,7 +39,8 @@ enum FileType {
   kMetaDatabase,
   kIdentityFile,
   kOptionsFile,
-  kSocketFile
+  kSocketFile,
+  kTableWarmStateFile
 };
 
 // Return the name of the log file with the specified number
@@ -140,6 +141,10 @@ extern std::string MetaDatabaseName(const std::string& dbname,
 // either from a backup-image or empty
 extern std::string IdentityFileName(const std::string& dbname);
 
+// Return the name of the file recording the hot SSTs on clean shutdown, see
+// DBOptions::persist_table_warm_state
+extern std::string TableWarmStateFileName(const std::string& dbname);
+
 // If filename is a rocksdb file, store the type of the file in *type.
 // The number encoded in the filename is stored in *number.  If the
 // filename was successfully parsed, returns true.  Else return false.
@@ -0,0 +1,205 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/io_heatmap.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+
+namespace rocksdb {
+
+IOHeatmap::IOHeatmap(uint32_t sample_period, size_t capacity)
+    : sample_period_(std::max<uint32_t>(sample_period, 1)),
+      capacity_(std::max<size_t>(capacity, 1)),
+      slots_(new Slot[capacity_]),
+      next_(0) {
+  for (size_t i = 0; i < capacity_; ++i) {
+    slots_[i].seq.store(0, std::memory_order_relaxed);
+  }
+}
+
+void IOHeatmap::Record(uint64_t file_number, uint64_t offset, size_t size,
+                       uint64_t micros, bool is_write) {
+  uint64_t pos = next_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[pos % capacity_];
+  slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.file_number.store(file_number, std::memory_order_relaxed);
+  slot.offset.store(offset, std::memory_order_relaxed);
+  uint64_t size32 = std::min<uint64_t>(size, UINT32_MAX);
+  uint64_t micros32 = std::min<uint64_t>(micros, UINT32_MAX);
+  slot.size_micros.store(size32 << 32 | micros32, std::memory_order_relaxed);
+  slot.is_write.store(is_write, std::memory_order_relaxed);
+  slot.seq.store(2 * pos + 2, std::memory_order_release);
+}
+
+void IOHeatmap::GetSamples(std::vector<Sample>* samples) const {
+  samples->clear();
+  uint64_t end = next_.load(std::memory_order_acquire);
+  uint64_t begin = end > capacity_ ? end - capacity_ : 0;
+  samples->reserve(static_cast<size_t>(end - begin));
+  for (uint64_t pos = begin; pos < end; ++pos) {
+    const Slot& slot = slots_[pos % capacity_];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * pos + 2) {
+      // Not published yet, or already overwritten by a newer sample
+      continue;
+    }
+    Sample sample;
+    sample.file_number = slot.file_number.load(std::memory_order_relaxed);
+    sample.offset = slot.offset.load(std::memory_order_relaxed);
+    uint64_t size_micros = slot.size_micros.load(std::memory_order_relaxed);
+    sample.size = static_cast<uint32_t>(size_micros >> 32);
+    sample.micros = static_cast<uint32_t>(size_micros);
+    sample.is_write = slot.is_write.load(std::memory_order_relaxed) != 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq) {
+      continue;
+    }
+    samples->push_back(sample);
+  }
+}
+
+std::string IOHeatmap::ToString(
+    const std::function<bool(uint64_t, int*)>& level_of,
+    size_t top_blocks) const {
+  struct FileStats {
+    int level = 0;
+    uint64_t reads = 0;
+    uint64_t read_bytes = 0;
+    uint64_t read_micros = 0;
+    uint64_t max_read_micros = 0;
+    uint64_t writes = 0;
+    uint64_t write_bytes = 0;
+  };
+  struct BlockStats {
+    uint64_t reads = 0;
+    uint64_t read_micros = 0;
+  };
+  const uint64_t kOtherFiles = UINT64_MAX;
+
+  std::vector<Sample> samples;
+  GetSamples(&samples);
+  std::map<uint64_t, FileStats> files;
+  std::map<std::pair<uint64_t, uint64_t>, BlockStats> blocks;
+  for (auto& sample : samples) {
+    int level = 0;
+    uint64_t file_number = sample.file_number;
+    if (!level_of(file_number, &level)) {
+      file_number = kOtherFiles;
+    }
+    FileStats& stats = files[file_number];
+    stats.level = level;
+    if (sample.is_write) {
+      ++stats.writes;
+      stats.write_bytes += sample.size;
+      continue;
+    }
+    ++stats.reads;
+    stats.read_bytes += sample.size;
+    stats.read_micros += sample.micros;
+    stats.max_read_micros = std::max<uint64_t>(stats.max_read_micros,
+                                               sample.micros);
+    if (file_number != kOtherFiles) {
+      BlockStats& block = blocks[std::make_pair(file_number, sample.offset)];
+      ++block.reads;
+      block.read_micros += sample.micros;
+    }
+  }
+
+  char buf[256];
+  std::string result;
+  snprintf(buf, sizeof(buf),
+           "IO heatmap: %" ROCKSDB_PRIszt " samples, 1 in %" PRIu32
+           " I/Os sampled, counts are scaled\n",
+           samples.size(), sample_period_);
+  result.append(buf);
+  snprintf(buf, sizeof(buf), "%10s %5s %12s %10s %10s %10s %12s %10s\n",
+           "File", "Level", "Reads", "Read(MB)", "AvgUs", "MaxUs", "Writes",
+           "Write(MB)");
+  result.append(buf);
+  const double kMB = 1048576.0;
+  for (auto& pair : files) {
+    const FileStats& stats = pair.second;
+    char file[32];
+    char level[16];
+    if (pair.first == kOtherFiles) {
+      snprintf(file, sizeof(file), "other");
+      snprintf(level, sizeof(level), "-");
+    } else {
+      snprintf(file, sizeof(file), "%06" PRIu64, pair.first);
+      if (stats.level == kBlobLevel) {
+        snprintf(level, sizeof(level), "blob");
+      } else if (stats.level == kDependenceLevel) {
+        snprintf(level, sizeof(level), "dep");
+      } else {
+        snprintf(level, sizeof(level), "L%d", stats.level);
+      }
+    }
+    snprintf(buf, sizeof(buf),
+             "%10s %5s %12" PRIu64 " %10.2f %10.1f %10" PRIu64 " %12" PRIu64
+             " %10.2f\n",
+             file, level, stats.reads * sample_period_,
+             stats.read_bytes * sample_period_ / kMB,
+             stats.reads == 0 ? 0.0
+                              : static_cast<double>(stats.read_micros) /
+                                    stats.reads,
+             stats.max_read_micros, stats.writes * sample_period_,
+             stats.write_bytes * sample_period_ / kMB);
+    result.append(buf);
+  }
+
+  std::vector<std::pair<std::pair<uint64_t, uint64_t>, BlockStats>> hot(
+      blocks.begin(), blocks.end());
+  size_t n = std::min(top_blocks, hot.size());
+  std::partial_sort(hot.begin(), hot.begin() + n, hot.end(),
+                    [](const std::pair<std::pair<uint64_t, uint64_t>,
+                                       BlockStats>& a,
+                       const std::pair<std::pair<uint64_t, uint64_t>,
+                                       BlockStats>& b) {
+                      return a.second.reads > b.second.reads;
+                    });
+  if (n > 0) {
+    snprintf(buf, sizeof(buf), "Hot blocks:\n%10s %14s %12s %10s\n", "File",
+             "Offset", "Reads", "AvgUs");
+    result.append(buf);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    snprintf(buf, sizeof(buf), "%10" PRIu64 " %14" PRIu64 " %12" PRIu64
+             " %10.1f\n",
+             hot[i].first.first, hot[i].first.second,
+             hot[i].second.reads * sample_period_,
+             static_cast<double>(hot[i].second.read_micros) /
+                 hot[i].second.reads);
+    result.append(buf);
+  }
+  return result;
+}
+
+std::string IOHeatmap::ToCSV(
+    const std::function<bool(uint64_t, int*)>& level_of) const {
+  std::vector<Sample> samples;
+  GetSamples(&samples);
+  std::string result;
+  char buf[128];
+  for (auto& sample : samples) {
+    int file_level = 0;
+    char level[16] = "";
+    if (level_of(sample.file_number, &file_level)) {
+      snprintf(level, sizeof(level), "%d", file_level);
+    }
+    snprintf(buf, sizeof(buf),
+             "%" PRIu64 ",%s,%" PRIu64 ",%" PRIu32 ",%" PRIu32 ",%s\n",
+             sample.file_number, level, sample.offset, sample.size,
+             sample.micros, sample.is_write ? "write" : "read");
+    result.append(buf);
+  }
+  return result;
+}
+
+}  // namespace rocksdb
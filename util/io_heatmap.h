@@ -0,0 +1,88 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "util/random.h"
+
+namespace rocksdb {
+
+// Samples SST and blob SST I/O into a fixed size ring buffer. Recording is
+// lock free: a writer claims a slot with one fetch_add and publishes it with
+// a sequence number, readers skip slots that are being overwritten. Old
+// samples are overwritten once the ring wraps, so the heatmap always shows
+// the most recent I/O.
+class IOHeatmap {
+ public:
+  static const size_t kDefaultCapacity = 65536;
+
+  // Levels reported for level -1 files: blob SSTs, which garbage collection
+  // may pick, and the SSTs it must not, such as those map SSTs depend on.
+  static const int kBlobLevel = -1;
+  static const int kDependenceLevel = -2;
+
+  struct Sample {
+    uint64_t file_number;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t micros;
+    bool is_write;
+  };
+
+  // Records one of every `sample_period` I/Os on average.
+  explicit IOHeatmap(uint32_t sample_period,
+                     size_t capacity = kDefaultCapacity);
+
+  uint32_t sample_period() const { return sample_period_; }
+
+  bool ShouldSample() const {
+    return sample_period_ <= 1 ||
+           Random::GetTLSInstance()->OneIn(static_cast<int>(sample_period_));
+  }
+
+  void Record(uint64_t file_number, uint64_t offset, size_t size,
+              uint64_t micros, bool is_write);
+
+  // Copies out the samples currently held by the ring, oldest first.
+  void GetSamples(std::vector<Sample>* samples) const;
+
+  // Per-file counts and latencies scaled by the sample period, followed by
+  // the `top_blocks` most read blocks. `level_of` maps a file number to its
+  // level, kBlobLevel or kDependenceLevel, or returns false for files that
+  // are not part of the caller's view, whose samples are summed into one
+  // line.
+  std::string ToString(const std::function<bool(uint64_t, int*)>& level_of,
+                       size_t top_blocks) const;
+
+  // The samples as CSV lines "file,level,offset,size,micros,op", oldest
+  // first. The level is empty for files `level_of` returns false for.
+  std::string ToCSV(
+      const std::function<bool(uint64_t, int*)>& level_of) const;
+
+ private:
+  struct Slot {
+    // 2 * position + 2 once published, odd while being written
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> file_number;
+    std::atomic<uint64_t> offset;
+    // size << 32 | micros
+    std::atomic<uint64_t> size_micros;
+    std::atomic<uint8_t> is_write;
+  };
+
+  const uint32_t sample_period_;
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> next_;
+};
+
+}  // namespace rocksdb
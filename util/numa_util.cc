@@ -0,0 +1,80 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/numa_util.h"
+
+#ifdef NUMA
+#include <numa.h>
+
+#include <algorithm>
+#include <vector>
+#endif
+
+#include "port/port.h"
+
+namespace rocksdb {
+
+#ifdef NUMA
+namespace {
+
+struct NumaTopology {
+  int num_nodes = 1;
+  // Node of every configured CPU
+  std::vector<int> cpu_node;
+
+  NumaTopology() {
+    if (numa_available() < 0) {
+      return;
+    }
+    num_nodes = std::max(1, numa_num_configured_nodes());
+    int num_cpus = numa_num_configured_cpus();
+    cpu_node.resize(num_cpus > 0 ? num_cpus : 0, 0);
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      int node = numa_node_of_cpu(cpu);
+      cpu_node[cpu] = node < 0 || node >= num_nodes ? 0 : node;
+    }
+  }
+};
+
+const NumaTopology& GetNumaTopology() {
+  static NumaTopology topology;
+  return topology;
+}
+
+}  // anonymous namespace
+
+int NumaNumNodes() { return GetNumaTopology().num_nodes; }
+
+int NumaNodeOfCurrentThread() {
+  const NumaTopology& topology = GetNumaTopology();
+  if (topology.num_nodes == 1) {
+    return 0;
+  }
+  int cpu = port::PhysicalCoreID();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= topology.cpu_node.size()) {
+    return 0;
+  }
+  return topology.cpu_node[cpu];
+}
+
+void NumaBindCurrentThread(int node) {
+  if (GetNumaTopology().num_nodes == 1) {
+    return;
+  }
+  numa_run_on_node(node);
+  numa_set_preferred(node);
+}
+
+#else  // NUMA
+
+int NumaNumNodes() { return 1; }
+
+int NumaNodeOfCurrentThread() { return 0; }
+
+void NumaBindCurrentThread(int /*node*/) {}
+
+#endif  // NUMA
+
+}  // namespace rocksdb
@@ -0,0 +1,25 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+namespace rocksdb {
+
+// NUMA helpers. Without NUMA support, either not built with -DNUMA or not
+// available on the running system, there is a single node 0 and binding is a
+// no-op, so callers don't need to special case it.
+
+// Number of NUMA nodes the process may run on
+int NumaNumNodes();
+
+// Node of the CPU the calling thread is running on. The thread may migrate
+// right after, so the result is a placement hint only.
+int NumaNodeOfCurrentThread();
+
+// Restricts the calling thread to the CPUs of `node` and makes it prefer
+// memory of `node` for new allocations.
+void NumaBindCurrentThread(int node);
+
+}  // namespace rocksdb
@@ -41,6 +41,7 @@ static const char* msgs[static_cast<int>(Status::kMaxSubCode)] = {
     "Space limit reached",                                // kSpaceLimit
     "Bad allocation",                                     // kBadAlloc
     "Require mmap open file",                             // kRequireMmap
+    "Table build memory exhausted",                       // kBuildDeferred
 };
 
 Status::Status(Code _code, SubCode _subcode, const Slice& msg,
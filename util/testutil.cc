@@ -266,6 +266,9 @@ void RandomInitDBOptions(DBOptions* db_opt, Random* rnd) {
   db_opt->max_background_compactions = rnd->Uniform(100);
   db_opt->max_background_flushes = rnd->Uniform(100);
   db_opt->max_file_opening_threads = rnd->Uniform(100);
+  db_opt->persist_table_warm_state = rnd->Uniform(2);
+  db_opt->io_heatmap_sample_period = rnd->Uniform(100);
+  db_opt->numa_aware = rnd->Uniform(2);
   db_opt->max_open_files = rnd->Uniform(100);
   db_opt->table_cache_numshardbits = rnd->Uniform(100);
 
@@ -289,7 +292,13 @@ void RandomInitDBOptions(DBOptions* db_opt, Random* rnd) {
   db_opt->delete_obsolete_files_period_micros = uint_max + rnd->Uniform(100000);
   db_opt->max_manifest_file_size = uint_max + rnd->Uniform(100000);
   db_opt->max_manifest_edit_count = uint_max + rnd->Uniform(100000);
+  db_opt->max_manifest_tail_ratio =
+      static_cast<double>(rnd->Uniform(80)) / 10;
   db_opt->max_wal_size = uint_max + rnd->Uniform(100000);
+  db_opt->compaction_throttle_read_p99_micros = rnd->Uniform(100000);
+  db_opt->compaction_throttle_write_p99_micros = rnd->Uniform(100000);
+  db_opt->compaction_throttle_min_ratio =
+      static_cast<double>(rnd->Uniform(100)) / 100;
   db_opt->max_total_wal_size = uint_max + rnd->Uniform(100000);
   db_opt->wal_bytes_per_sync = uint_max + rnd->Uniform(100000);
 
@@ -311,6 +320,7 @@ void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, Random* rnd) {
   cf_opt->paranoid_file_checks = rnd->Uniform(2);
   cf_opt->purge_redundant_kvs_while_flush = rnd->Uniform(2);
   cf_opt->force_consistency_checks = rnd->Uniform(2);
+  cf_opt->temperature_aware_placement = rnd->Uniform(2);
   cf_opt->compaction_options_fifo.allow_compaction = rnd->Uniform(2);
 
   // double options
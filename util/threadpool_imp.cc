@@ -11,6 +11,7 @@
 
 #include "monitoring/thread_status_util.h"
 #include "port/port.h"
+#include "util/numa_util.h"
 
 #ifndef OS_WIN
 #include <unistd.h>
@@ -57,6 +58,8 @@ struct ThreadPoolImpl::Impl {
 
   void LowerCPUPriority();
 
+  void BindToNumaNodes();
+
   void WakeUpAllThreads() { bgsignal_.notify_all(); }
 
   void BGThread(size_t thread_id);
@@ -99,6 +102,7 @@ struct ThreadPoolImpl::Impl {
 
   bool low_io_priority_;
   bool low_cpu_priority_;
+  bool numa_bound_;
   Env::Priority priority_;
   Env* env_;
 
@@ -125,6 +129,7 @@ struct ThreadPoolImpl::Impl {
 inline ThreadPoolImpl::Impl::Impl()
     : low_io_priority_(false),
       low_cpu_priority_(false),
+      numa_bound_(false),
       priority_(Env::LOW),
       env_(nullptr),
       total_threads_limit_(0),
@@ -172,9 +177,15 @@ inline void ThreadPoolImpl::Impl::LowerCPUPriority() {
   low_cpu_priority_ = true;
 }
 
+inline void ThreadPoolImpl::Impl::BindToNumaNodes() {
+  std::lock_guard<std::mutex> lock(mu_);
+  numa_bound_ = true;
+}
+
 void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
   bool low_io_priority = false;
   bool low_cpu_priority = false;
+  bool numa_bound = false;
 
   while (true) {
     // Wait until there is an item that is ready to run
@@ -215,8 +226,14 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
 
     bool decrease_io_priority = (low_io_priority != low_io_priority_);
     bool decrease_cpu_priority = (low_cpu_priority != low_cpu_priority_);
+    bool bind_numa_node = (numa_bound != numa_bound_);
     lock.unlock();
 
+    if (bind_numa_node) {
+      NumaBindCurrentThread(static_cast<int>(thread_id % NumaNumNodes()));
+      numa_bound = true;
+    }
+
 #ifdef OS_LINUX
     if (decrease_cpu_priority) {
       setpriority(PRIO_PROCESS,
@@ -428,6 +445,8 @@ void ThreadPoolImpl::LowerIOPriority() { impl_->LowerIOPriority(); }
 
 void ThreadPoolImpl::LowerCPUPriority() { impl_->LowerCPUPriority(); }
 
+void ThreadPoolImpl::BindToNumaNodes() { impl_->BindToNumaNodes(); }
+
 void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num) {
   impl_->SetBackgroundThreadsInternal(num, false);
 }
@@ -53,6 +53,11 @@ class ThreadPoolImpl : public ThreadPool {
   // Currently only has effect on Linux
   void LowerCPUPriority();
 
+  // Bind threads round robin to the NUMA nodes, so every node has its own
+  // share of the pool and their allocations stay node local. No-op without
+  // NUMA support
+  void BindToNumaNodes();
+
   // Ensure there is at aleast num threads in the pool
   // but do not kill threads if there are more
   void IncBackgroundThreadsIfNeeded(int num);
@@ -5,13 +5,21 @@
 
 #include "util/trace_replay.h"
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <thread>
 #include "db/db_impl.h"
+#include "db/dbformat.h"
+#include "db/write_batch_internal.h"
+#include "monitoring/histogram.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/write_batch.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "util/string_util.h"
 
 namespace rocksdb {
@@ -29,8 +37,62 @@ void DecodeCFAndKey(std::string& buffer, uint32_t* cf_id, Slice* key) {
   GetFixed32(&buf, cf_id);
   GetLengthPrefixedSlice(&buf, key);
 }
+
+// MultiGet payload: key count followed by the cf id and key of every key.
+void DecodeMultiGet(const std::string& buffer, std::vector<uint32_t>* cf_ids,
+                    std::vector<Slice>* keys) {
+  Slice buf(buffer);
+  uint32_t count = 0;
+  GetFixed32(&buf, &count);
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t cf_id = 0;
+    Slice key;
+    if (!GetFixed32(&buf, &cf_id) || !GetLengthPrefixedSlice(&buf, &key)) {
+      break;
+    }
+    cf_ids->push_back(cf_id);
+    keys->push_back(key);
+  }
+}
 }  // namespace
 
+void EncodeTrace(const Trace& trace, std::string* encoded_trace) {
+  PutFixed64(encoded_trace, trace.ts);
+  encoded_trace->push_back(trace.type);
+  PutFixed32(encoded_trace, static_cast<uint32_t>(trace.payload.size() +
+                                                  kTraceThreadIdSize));
+  encoded_trace->append(trace.payload);
+  PutFixed64(encoded_trace, trace.thread_id);
+}
+
+bool TraceHasThreadId(const Trace& header) {
+  return header.payload.find("Trace Version: 0.1\t") == std::string::npos;
+}
+
+Status DecodeTrace(const std::string& encoded_trace, bool has_thread_id,
+                   Trace* trace) {
+  Slice enc_slice(encoded_trace);
+  uint32_t payload_len = 0;
+  if (enc_slice.size() < kTraceMetadataSize) {
+    return Status::Corruption("Corrupted trace record. Too short.");
+  }
+  GetFixed64(&enc_slice, &trace->ts);
+  trace->type = static_cast<TraceType>(enc_slice[0]);
+  enc_slice.remove_prefix(kTraceTypeSize);
+  GetFixed32(&enc_slice, &payload_len);
+  if (payload_len > enc_slice.size() ||
+      (has_thread_id && payload_len < kTraceThreadIdSize)) {
+    return Status::Corruption("Corrupted trace record. Bad payload length.");
+  }
+  trace->thread_id = 0;
+  if (has_thread_id) {
+    payload_len -= kTraceThreadIdSize;
+    trace->thread_id = DecodeFixed64(enc_slice.data() + payload_len);
+  }
+  trace->payload.assign(enc_slice.data(), payload_len);
+  return Status::OK();
+}
+
 Tracer::Tracer(Env* env, const TraceOptions& trace_options,
                std::unique_ptr<TraceWriter>&& trace_writer)
     : env_(env),
@@ -47,6 +109,7 @@ Status Tracer::Write(WriteBatch* write_batch) {
   }
   Trace trace;
   trace.ts = env_->NowMicros();
+  trace.thread_id = env_->GetThreadID();
   trace.type = kTraceWrite;
   trace.payload = write_batch->Data();
   return WriteTrace(trace);
@@ -58,6 +121,7 @@ Status Tracer::Get(ColumnFamilyHandle* column_family, const Slice& key) {
   }
   Trace trace;
   trace.ts = env_->NowMicros();
+  trace.thread_id = env_->GetThreadID();
   trace.type = kTraceGet;
   EncodeCFAndKey(&trace.payload, column_family->GetID(), key);
   return WriteTrace(trace);
@@ -69,6 +133,7 @@ Status Tracer::IteratorSeek(const uint32_t& cf_id, const Slice& key) {
   }
   Trace trace;
   trace.ts = env_->NowMicros();
+  trace.thread_id = env_->GetThreadID();
   trace.type = kTraceIteratorSeek;
   EncodeCFAndKey(&trace.payload, cf_id, key);
   return WriteTrace(trace);
@@ -80,11 +145,29 @@ Status Tracer::IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key) {
   }
   Trace trace;
   trace.ts = env_->NowMicros();
+  trace.thread_id = env_->GetThreadID();
   trace.type = kTraceIteratorSeekForPrev;
   EncodeCFAndKey(&trace.payload, cf_id, key);
   return WriteTrace(trace);
 }
 
+Status Tracer::MultiGet(const std::vector<ColumnFamilyHandle*>& column_families,
+                        const std::vector<Slice>& keys) {
+  if (IsTraceFileOverMax()) {
+    return Status::OK();
+  }
+  assert(column_families.size() == keys.size());
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.thread_id = env_->GetThreadID();
+  trace.type = kTraceMultiGet;
+  PutFixed32(&trace.payload, static_cast<uint32_t>(keys.size()));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EncodeCFAndKey(&trace.payload, column_families[i]->GetID(), keys[i]);
+  }
+  return WriteTrace(trace);
+}
+
 bool Tracer::IsTraceFileOverMax() {
   uint64_t trace_file_size = trace_writer_->GetFileSize();
   return (trace_file_size > trace_options_.max_trace_file_size);
@@ -93,13 +176,14 @@ bool Tracer::IsTraceFileOverMax() {
 Status Tracer::WriteHeader() {
   std::ostringstream s;
   s << kTraceMagic << "\t"
-    << "Trace Version: 0.1\t"
+    << "Trace Version: 0.2\t"
     << "RocksDB Version: " << kMajorVersion << "." << kMinorVersion << "\t"
     << "Format: Timestamp OpType Payload\n";
   std::string header(s.str());
 
   Trace trace;
   trace.ts = env_->NowMicros();
+  trace.thread_id = env_->GetThreadID();
   trace.type = kTraceBegin;
   trace.payload = header;
   return WriteTrace(trace);
@@ -108,6 +192,7 @@ Status Tracer::WriteHeader() {
 Status Tracer::WriteFooter() {
   Trace trace;
   trace.ts = env_->NowMicros();
+  trace.thread_id = env_->GetThreadID();
   trace.type = kTraceEnd;
   trace.payload = "";
   return WriteTrace(trace);
@@ -115,10 +200,7 @@ Status Tracer::WriteFooter() {
 
 Status Tracer::WriteTrace(const Trace& trace) {
   std::string encoded_trace;
-  PutFixed64(&encoded_trace, trace.ts);
-  encoded_trace.push_back(trace.type);
-  PutFixed32(&encoded_trace, static_cast<uint32_t>(trace.payload.size()));
-  encoded_trace.append(trace.payload);
+  EncodeTrace(trace, &encoded_trace);
   return trace_writer_->Write(Slice(encoded_trace));
 }
 
@@ -126,7 +208,7 @@ Status Tracer::Close() { return WriteFooter(); }
 
 Replayer::Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
                    std::unique_ptr<TraceReader>&& reader)
-    : trace_reader_(std::move(reader)) {
+    : trace_reader_(std::move(reader)), trace_has_thread_id_(false) {
   assert(db != nullptr);
   db_ = static_cast<DBImpl*>(db->GetRootDB());
   for (ColumnFamilyHandle* cfh : handles) {
@@ -146,11 +228,7 @@ Status Replayer::Replay() {
 
   std::chrono::system_clock::time_point replay_epoch =
       std::chrono::system_clock::now();
-  WriteOptions woptions;
-  ReadOptions roptions;
   Trace trace;
-  uint64_t ops = 0;
-  Iterator* single_iter = nullptr;
   while (s.ok()) {
     trace.reset();
     s = ReadTrace(&trace);
@@ -160,76 +238,251 @@ Status Replayer::Replay() {
 
     std::this_thread::sleep_until(
         replay_epoch + std::chrono::microseconds(trace.ts - header.ts));
-    if (trace.type == kTraceWrite) {
-      WriteBatch batch(trace.payload);
-      db_->Write(woptions, &batch);
-      ops++;
-    } else if (trace.type == kTraceGet) {
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
+    if (trace.type == kTraceEnd) {
+      // Do nothing for now.
+      // TODO: Add some validations later.
+      break;
+    }
+    s = ReplayTrace(trace);
+  }
+
+  if (s.IsIncomplete()) {
+    // Reaching eof returns Incomplete status at the moment.
+    // Could happen when killing a process without calling EndTrace() API.
+    // TODO: Add better error handling.
+    return Status::OK();
+  }
+  return s;
+}
+
+namespace {
+// Records waiting for one replay thread. The reader blocks once
+// kMaxQueuedTraces records are waiting so a slow replay does not load the
+// whole trace into memory.
+struct ReplayQueue {
+  static const size_t kMaxQueuedTraces = 4096;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Trace> traces;
+  bool done = false;
+};
+}  // namespace
+
+Status Replayer::MultiThreadReplay(
+    const TraceReplayOptions& options,
+    std::map<TraceType, std::shared_ptr<HistogramImpl>>* latencies) {
+  if (options.num_threads < 1 || options.fast_forward < 0) {
+    return Status::InvalidArgument(
+        "num_threads must be positive and fast_forward not negative");
+  }
+  Status s;
+  Trace header;
+  s = ReadHeader(&header);
+  if (!s.ok()) {
+    return s;
+  }
+
+  Env* env = db_->GetEnv();
+  std::vector<ReplayQueue> queues(options.num_threads);
+  std::vector<std::map<TraceType, HistogramImpl>> thread_latencies(
+      options.num_threads);
+  std::mutex error_mutex;
+  Status error;
+  std::atomic<bool> failed(false);
+  std::chrono::system_clock::time_point replay_epoch =
+      std::chrono::system_clock::now();
+
+  auto replay_thread = [&](size_t index) {
+    ReplayQueue& queue = queues[index];
+    Trace trace;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        queue.cv.wait(lock,
+                      [&queue] { return !queue.traces.empty() || queue.done; });
+        if (queue.traces.empty()) {
+          break;
+        }
+        trace = std::move(queue.traces.front());
+        queue.traces.pop_front();
       }
+      queue.cv.notify_all();
 
-      std::string value;
-      if (cf_id == 0) {
-        db_->Get(roptions, key, &value);
-      } else {
-        db_->Get(roptions, cf_map_[cf_id], key, &value);
+      if (options.fast_forward > 0) {
+        std::this_thread::sleep_until(
+            replay_epoch +
+            std::chrono::microseconds(static_cast<uint64_t>(
+                (trace.ts - header.ts) / options.fast_forward)));
       }
-      ops++;
-    } else if (trace.type == kTraceIteratorSeek) {
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
+      uint64_t start = env->NowMicros();
+      Status rs = ReplayTrace(trace);
+      thread_latencies[index][trace.type].Add(env->NowMicros() - start);
+      if (!rs.ok()) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (error.ok()) {
+          error = rs;
+        }
+        failed.store(true, std::memory_order_relaxed);
       }
+    }
+  };
 
-      if (cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
-      } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[cf_id]);
-      }
-      single_iter->Seek(key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceIteratorSeekForPrev) {
-      // Currently, only support to call the Seek()
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
+  std::vector<port::Thread> threads;
+  for (int i = 0; i < options.num_threads; ++i) {
+    threads.emplace_back(replay_thread, static_cast<size_t>(i));
+  }
+
+  Trace trace;
+  while (!failed.load(std::memory_order_relaxed)) {
+    trace.reset();
+    s = ReadTrace(&trace);
+    if (!s.ok() || trace.type == kTraceEnd) {
+      break;
+    }
+    ReplayQueue& queue = queues[Shard(trace, options)];
+    {
+      std::unique_lock<std::mutex> lock(queue.mutex);
+      queue.cv.wait(lock, [&queue, &failed] {
+        return queue.traces.size() < ReplayQueue::kMaxQueuedTraces ||
+               failed.load(std::memory_order_relaxed);
+      });
+      queue.traces.emplace_back(std::move(trace));
+    }
+    queue.cv.notify_all();
+  }
+
+  for (auto& queue : queues) {
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (failed.load(std::memory_order_relaxed)) {
+        queue.traces.clear();
       }
+      queue.done = true;
+    }
+    queue.cv.notify_all();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
 
-      if (cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
-      } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[cf_id]);
+  if (latencies != nullptr) {
+    for (auto& per_thread : thread_latencies) {
+      for (auto& pair : per_thread) {
+        auto& hist = (*latencies)[pair.first];
+        if (hist == nullptr) {
+          hist = std::make_shared<HistogramImpl>();
+        }
+        hist->Merge(pair.second);
       }
-      single_iter->SeekForPrev(key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceEnd) {
-      // Do nothing for now.
-      // TODO: Add some validations later.
-      break;
     }
   }
 
+  if (!error.ok()) {
+    return error;
+  }
   if (s.IsIncomplete()) {
-    // Reaching eof returns Incomplete status at the moment.
-    // Could happen when killing a process without calling EndTrace() API.
-    // TODO: Add better error handling.
+    // Reaching eof returns Incomplete status at the moment, see Replay().
     return Status::OK();
   }
   return s;
 }
 
+Status Replayer::ReplayTrace(const Trace& trace) {
+  WriteOptions woptions;
+  ReadOptions roptions;
+  if (trace.type == kTraceWrite) {
+    WriteBatch batch(trace.payload);
+    db_->Write(woptions, &batch);
+  } else if (trace.type == kTraceGet || trace.type == kTraceIteratorSeek ||
+             trace.type == kTraceIteratorSeekForPrev) {
+    uint32_t cf_id = 0;
+    Slice key;
+    std::string payload = trace.payload;
+    DecodeCFAndKey(payload, &cf_id, &key);
+    ColumnFamilyHandle* cfh = db_->DefaultColumnFamily();
+    if (cf_id > 0) {
+      auto it = cf_map_.find(cf_id);
+      if (it == cf_map_.end()) {
+        return Status::Corruption("Invalid Column Family ID.");
+      }
+      cfh = it->second;
+    }
+
+    if (trace.type == kTraceGet) {
+      std::string value;
+      db_->Get(roptions, cfh, key, &value);
+    } else {
+      std::unique_ptr<Iterator> single_iter(db_->NewIterator(roptions, cfh));
+      if (trace.type == kTraceIteratorSeek) {
+        single_iter->Seek(key);
+      } else {
+        single_iter->SeekForPrev(key);
+      }
+    }
+  } else if (trace.type == kTraceMultiGet) {
+    std::vector<uint32_t> cf_ids;
+    std::vector<Slice> keys;
+    DecodeMultiGet(trace.payload, &cf_ids, &keys);
+    std::vector<ColumnFamilyHandle*> handles;
+    for (uint32_t cf_id : cf_ids) {
+      if (cf_id == 0) {
+        handles.push_back(db_->DefaultColumnFamily());
+        continue;
+      }
+      auto it = cf_map_.find(cf_id);
+      if (it == cf_map_.end()) {
+        return Status::Corruption("Invalid Column Family ID.");
+      }
+      handles.push_back(it->second);
+    }
+    std::vector<std::string> values;
+    db_->MultiGet(roptions, handles, keys, &values);
+  }
+  return Status::OK();
+}
+
+size_t Replayer::Shard(const Trace& trace, const TraceReplayOptions& options) {
+  if (options.num_threads == 1) {
+    return 0;
+  }
+  if (options.sharding == TraceReplayOptions::kShardByThread) {
+    return GetSliceHash(Slice(reinterpret_cast<const char*>(&trace.thread_id),
+                              sizeof(trace.thread_id))) %
+           options.num_threads;
+  }
+  Slice key;
+  if (trace.type == kTraceWrite) {
+    Slice input(trace.payload);
+    if (input.size() > WriteBatchInternal::kHeader) {
+      input.remove_prefix(WriteBatchInternal::kHeader);
+      char tag;
+      uint32_t cf_id;
+      Slice value, blob, xid;
+      ReadRecordFromWriteBatch(&input, &tag, &cf_id, &key, &value, &blob,
+                               &xid);
+    }
+  } else if (trace.type == kTraceMultiGet) {
+    Slice input(trace.payload);
+    uint32_t count = 0, cf_id = 0;
+    if (GetFixed32(&input, &count) && count > 0) {
+      GetFixed32(&input, &cf_id);
+      GetLengthPrefixedSlice(&input, &key);
+    }
+  } else {
+    Slice input(trace.payload);
+    uint32_t cf_id = 0;
+    GetFixed32(&input, &cf_id);
+    GetLengthPrefixedSlice(&input, &key);
+  }
+  return GetSliceHash(key) % options.num_threads;
+}
+
 Status Replayer::ReadHeader(Trace* header) {
   assert(header != nullptr);
+  // The header is decoded as if it had no thread id, its version tells how
+  // to decode the records that follow.
+  trace_has_thread_id_ = false;
   Status s = ReadTrace(header);
   if (!s.ok()) {
     return s;
@@ -240,6 +493,13 @@ Status Replayer::ReadHeader(Trace* header) {
   if (header->payload.substr(0, kTraceMagic.length()) != kTraceMagic) {
     return Status::Corruption("Corrupted trace file. Incorrect magic.");
   }
+  trace_has_thread_id_ = TraceHasThreadId(*header);
+  if (trace_has_thread_id_) {
+    if (header->payload.size() < kTraceThreadIdSize) {
+      return Status::Corruption("Corrupted trace file. Incorrect header.");
+    }
+    header->payload.resize(header->payload.size() - kTraceThreadIdSize);
+  }
 
   return s;
 }
@@ -265,13 +525,7 @@ Status Replayer::ReadTrace(Trace* trace) {
   if (!s.ok()) {
     return s;
   }
-
-  Slice enc_slice = Slice(encoded_trace);
-  GetFixed64(&enc_slice, &trace->ts);
-  trace->type = static_cast<TraceType>(enc_slice[0]);
-  enc_slice.remove_prefix(kTraceTypeSize + kTracePayloadLengthSize);
-  trace->payload = enc_slice.ToString();
-  return s;
+  return DecodeTrace(encoded_trace, trace_has_thread_id_, trace);
 }
 
 }  // namespace rocksdb
@@ -5,9 +5,11 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
@@ -19,6 +21,8 @@ class ColumnFamilyHandle;
 class ColumnFamilyData;
 class DB;
 class DBImpl;
+class HistogramImpl;
+class Iterator;
 class Slice;
 class WriteBatch;
 
@@ -28,6 +32,9 @@ const unsigned int kTraceTypeSize = 1;
 const unsigned int kTracePayloadLengthSize = 4;
 const unsigned int kTraceMetadataSize =
     kTraceTimestampSize + kTraceTypeSize + kTracePayloadLengthSize;
+// Since trace version 0.2 the last 8 bytes covered by the payload length hold
+// the id of the thread that issued the operation.
+const unsigned int kTraceThreadIdSize = 8;
 
 enum TraceType : char {
   kTraceBegin = 1,
@@ -36,6 +43,7 @@ enum TraceType : char {
   kTraceGet = 4,
   kTraceIteratorSeek = 5,
   kTraceIteratorSeekForPrev = 6,
+  kTraceMultiGet = 7,
   kTraceMax,
 };
 
@@ -45,14 +53,29 @@ struct Trace {
   uint64_t ts;
   TraceType type;
   std::string payload;
+  // Id of the thread that issued the operation. Traces written before the id
+  // was recorded read back 0.
+  uint64_t thread_id = 0;
 
   void reset() {
     ts = 0;
     type = kTraceMax;
     payload.clear();
+    thread_id = 0;
   }
 };
 
+// Encodes a trace record: timestamp, type, payload length, payload and the
+// issuing thread id.
+void EncodeTrace(const Trace& trace, std::string* encoded_trace);
+// Whether the records following `header` carry thread ids, false for traces
+// of version 0.1.
+bool TraceHasThreadId(const Trace& header);
+// Decodes a record written by EncodeTrace, or by a version 0.1 tracer when
+// has_thread_id is false.
+Status DecodeTrace(const std::string& encoded_trace, bool has_thread_id,
+                   Trace* trace);
+
 // Trace RocksDB operations using a TraceWriter.
 class Tracer {
  public:
@@ -64,6 +87,8 @@ class Tracer {
   Status Get(ColumnFamilyHandle* cfname, const Slice& key);
   Status IteratorSeek(const uint32_t& cf_id, const Slice& key);
   Status IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key);
+  Status MultiGet(const std::vector<ColumnFamilyHandle*>& column_families,
+                  const std::vector<Slice>& keys);
   bool IsTraceFileOverMax();
 
   Status Close();
@@ -78,6 +103,22 @@ class Tracer {
   std::unique_ptr<TraceWriter> trace_writer_;
 };
 
+struct TraceReplayOptions {
+  enum Sharding : char {
+    // Operations on the same key go to the same thread. Write batches go by
+    // their first key and MultiGets by their first key.
+    kShardByKey,
+    // Operations of the same traced thread go to the same thread.
+    kShardByThread,
+  };
+
+  int num_threads = 1;
+  Sharding sharding = kShardByKey;
+  // Replay speed relative to the traced speed, 2.0 halves every gap between
+  // two operations. 0 replays every operation as soon as it is read.
+  double fast_forward = 1.0;
+};
+
 // Replay RocksDB operations from a trace.
 class Replayer {
  public:
@@ -87,13 +128,26 @@ class Replayer {
 
   Status Replay();
 
+  // Replays the trace on options.num_threads threads, each operation no
+  // earlier than its traced offset from the start divided by
+  // options.fast_forward. If latencies is not null it receives the latency
+  // in micros of the replayed operations, one histogram per trace type.
+  Status MultiThreadReplay(
+      const TraceReplayOptions& options,
+      std::map<TraceType, std::shared_ptr<HistogramImpl>>* latencies = nullptr);
+
  private:
   Status ReadHeader(Trace* header);
   Status ReadFooter(Trace* footer);
   Status ReadTrace(Trace* trace);
+  // Executes one operation record, the result of the operation is ignored.
+  Status ReplayTrace(const Trace& trace);
+  // Picks the replay thread of a record
+  size_t Shard(const Trace& trace, const TraceReplayOptions& options);
 
   DBImpl* db_;
   std::unique_ptr<TraceReader> trace_reader_;
+  bool trace_has_thread_id_;
   std::unordered_map<uint32_t, ColumnFamilyHandle*> cf_map_;
 };
 
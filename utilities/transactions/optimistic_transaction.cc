@@ -17,6 +17,7 @@
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "util/cast_util.h"
 #include "util/string_util.h"
+#include "utilities/transactions/optimistic_transaction_db_impl.h"
 #include "utilities/transactions/transaction_util.h"
 
 namespace rocksdb {
@@ -36,6 +37,7 @@ void OptimisticTransaction::Initialize(
   if (txn_options.set_snapshot) {
     SetSnapshot();
   }
+  group_commit_ = txn_options.group_commit;
 }
 
 void OptimisticTransaction::Reinitialize(
@@ -55,6 +57,10 @@ Status OptimisticTransaction::Prepare() {
 }
 
 Status OptimisticTransaction::Commit() {
+  if (group_commit_) {
+    return CommitGroup();
+  }
+
   // Set up callback which will call CheckTransactionForConflicts() to
   // check whether this transaction is safe to be committed.
   OptimisticTransactionCallback callback(this);
@@ -71,6 +77,21 @@ Status OptimisticTransaction::Commit() {
   return s;
 }
 
+Status OptimisticTransaction::CommitGroup() {
+  auto txn_db_impl = static_cast_with_check<OptimisticTransactionDBImpl,
+                                            OptimisticTransactionDB>(txn_db_);
+  OptimisticTransactionDBImpl::CommitRequest request(
+      &write_options_, GetWriteBatch()->GetWriteBatch(), &GetTrackedKeys());
+
+  Status s = txn_db_impl->CommitGroup(&request);
+
+  if (s.ok()) {
+    Clear();
+  }
+
+  return s;
+}
+
 Status OptimisticTransaction::Rollback() {
   Clear();
   return Status::OK();
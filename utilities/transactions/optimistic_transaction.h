@@ -54,6 +54,9 @@ class OptimisticTransaction : public TransactionBaseImpl {
  private:
   OptimisticTransactionDB* const txn_db_;
 
+  // Commit through OptimisticTransactionDBImpl::CommitGroup
+  bool group_commit_ = false;
+
   friend class OptimisticTransactionCallback;
 
   void Initialize(const OptimisticTransactionOptions& txn_options);
@@ -65,6 +68,9 @@ class OptimisticTransaction : public TransactionBaseImpl {
   // Should only be called on writer thread.
   Status CheckTransactionForConflicts(DB* db);
 
+  // Commits together with the other transactions committing at the same time
+  Status CommitGroup();
+
   void Clear() override;
 
   void UnlockGetForUpdate(ColumnFamilyHandle* /* unused */,
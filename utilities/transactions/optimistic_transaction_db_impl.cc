@@ -11,9 +11,13 @@
 #include <vector>
 
 #include "db/db_impl.h"
+#include "db/write_batch_internal.h"
+#include "db/write_callback.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
+#include "util/cast_util.h"
+#include "util/mutexlock.h"
 #include "utilities/transactions/optimistic_transaction.h"
 
 namespace rocksdb {
@@ -29,6 +33,122 @@ Transaction* OptimisticTransactionDBImpl::BeginTransaction(
   }
 }
 
+namespace {
+
+// Used at commit time to validate all the requests of a commit group
+class CommitGroupCallback : public WriteCallback {
+ public:
+  CommitGroupCallback(const std::vector<const TransactionKeyMap*>* keys,
+                      const std::vector<WriteBatch*>* batches,
+                      std::vector<Status>* statuses)
+      : keys_(keys), batches_(batches), statuses_(statuses) {}
+
+  Status Callback(DB* db) override {
+    auto db_impl = static_cast_with_check<DBImpl, DB>(db);
+    // Cache-only for the same reason as
+    // OptimisticTransaction::CheckTransactionForConflicts
+    return TransactionUtil::CheckGroupForConflicts(
+        db_impl, *keys_, *batches_, true /* cache_only */, statuses_);
+  }
+
+  // The group is already a single batch that must be validated as a whole
+  bool AllowWriteBatching() override { return false; }
+
+ private:
+  const std::vector<const TransactionKeyMap*>* keys_;
+  const std::vector<WriteBatch*>* batches_;
+  std::vector<Status>* statuses_;
+};
+
+// Whether the two commits can be written with the same WriteOptions. sync
+// is left out since a group is synced if any of its commits asks for it.
+bool CanShareWrite(const WriteOptions& a, const WriteOptions& b) {
+  return a.disableWAL == b.disableWAL &&
+         a.ignore_missing_column_families == b.ignore_missing_column_families &&
+         a.no_slowdown == b.no_slowdown && a.low_pri == b.low_pri;
+}
+
+}  // namespace
+
+Status OptimisticTransactionDBImpl::CommitGroup(CommitRequest* request) {
+  MutexLock l(&commit_group_mutex_);
+  commit_group_pending_.push_back(request);
+  while (!request->done) {
+    if (commit_group_leader_) {
+      commit_group_cv_.Wait();
+      continue;
+    }
+    // No group is being written, so the request is still pending. Lead a
+    // group made of it and of the pending requests it can share a write with.
+    commit_group_leader_ = true;
+    std::vector<CommitRequest*> group;
+    for (auto iter = commit_group_pending_.begin();
+         iter != commit_group_pending_.end();) {
+      if (CanShareWrite(*(*iter)->write_options, *request->write_options)) {
+        group.push_back(*iter);
+        iter = commit_group_pending_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    commit_group_mutex_.Unlock();
+    WriteCommitGroup(group);
+    commit_group_mutex_.Lock();
+    for (auto* member : group) {
+      member->done = true;
+    }
+    commit_group_leader_ = false;
+    commit_group_cv_.SignalAll();
+  }
+  return request->status;
+}
+
+void OptimisticTransactionDBImpl::WriteCommitGroup(
+    const std::vector<CommitRequest*>& group) {
+  assert(!group.empty());
+  WriteOptions write_options = *group.front()->write_options;
+  for (auto* member : group) {
+    write_options.sync |= member->write_options->sync;
+  }
+  auto db_impl = static_cast_with_check<DBImpl, DB>(GetRootDB());
+
+  std::vector<CommitRequest*> members = group;
+  while (!members.empty()) {
+    std::vector<const TransactionKeyMap*> keys;
+    std::vector<WriteBatch*> batches;
+    WriteBatch group_batch;
+    for (auto* member : members) {
+      keys.push_back(member->keys);
+      batches.push_back(member->batch);
+      WriteBatchInternal::Append(&group_batch, member->batch);
+    }
+    std::vector<Status> statuses;
+    CommitGroupCallback callback(&keys, &batches, &statuses);
+    Status s = db_impl->WriteWithCallback(write_options, &group_batch,
+                                          &callback);
+
+    // Drop the members that failed their check and write the others again.
+    // Their checks are repeated since more commits may have happened since.
+    std::vector<CommitRequest*> passed;
+    for (size_t i = 0; i < statuses.size(); i++) {
+      if (statuses[i].ok()) {
+        passed.push_back(members[i]);
+      } else {
+        members[i]->status = statuses[i];
+      }
+    }
+    if (s.ok() || statuses.empty() || passed.size() == members.size()) {
+      // Either written, or the write failed for a reason that is not a
+      // conflict, including before the callback got to run
+      for (auto* member : members) {
+        member->status = s;
+      }
+      break;
+    }
+    members.swap(passed);
+  }
+}
+
 Status OptimisticTransactionDB::Open(const Options& options,
                                      const std::string& dbname,
                                      OptimisticTransactionDB** dbptr) {
@@ -6,16 +6,23 @@
 #pragma once
 #ifndef ROCKSDB_LITE
 
+#include <deque>
+#include <vector>
+
+#include "port/port.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
+#include "utilities/transactions/transaction_util.h"
 
 namespace rocksdb {
 
 class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
  public:
   explicit OptimisticTransactionDBImpl(DB* db, bool take_ownership = true)
-      : OptimisticTransactionDB(db), db_owner_(take_ownership) {}
+      : OptimisticTransactionDB(db),
+        db_owner_(take_ownership),
+        commit_group_cv_(&commit_group_mutex_) {}
 
   ~OptimisticTransactionDBImpl() {
     // Prevent this stackable from destroying
@@ -29,10 +36,41 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
                                 const OptimisticTransactionOptions& txn_options,
                                 Transaction* old_txn) override;
 
+  // A transaction committed through CommitGroup.
+  struct CommitRequest {
+    CommitRequest(const WriteOptions* _write_options, WriteBatch* _batch,
+                  const TransactionKeyMap* _keys)
+        : write_options(_write_options), batch(_batch), keys(_keys) {}
+
+    const WriteOptions* write_options;
+    WriteBatch* batch;
+    const TransactionKeyMap* keys;
+    Status status;
+    bool done = false;
+  };
+
+  // Commits the request together with the ones that arrive while an earlier
+  // group is being written. The first waiting thread becomes the leader and
+  // writes the requests of all the others; the followers sleep until their
+  // status is set. Returns Busy or TryAgain if the request failed its conflict
+  // check, which does not affect the other requests of the group.
+  Status CommitGroup(CommitRequest* request);
+
  private:
 
    bool db_owner_;
 
+  // Validates and writes the requests with one write, leaving out and
+  // retrying without the ones that fail their conflict check.
+  void WriteCommitGroup(const std::vector<CommitRequest*>& group);
+
+  port::Mutex commit_group_mutex_;
+  port::CondVar commit_group_cv_;
+  // Whether a leader is writing a group. Protected by commit_group_mutex_.
+  bool commit_group_leader_ = false;
+  // Requests waiting for the next group. Protected by commit_group_mutex_.
+  std::deque<CommitRequest*> commit_group_pending_;
+
   void ReinitializeTransaction(Transaction* txn,
                                const WriteOptions& write_options,
                                const OptimisticTransactionOptions& txn_options =
@@ -15,6 +15,7 @@
 #include "util/crc32c.h"
 #include "util/logging.h"
 #include "util/random.h"
+#include "util/string_util.h"
 #include "util/testharness.h"
 #include "util/transaction_test_util.h"
 #include "port/port.h"
@@ -119,6 +120,89 @@ TEST_F(OptimisticTransactionTest, WriteConflictTest) {
   delete txn;
 }
 
+TEST_F(OptimisticTransactionTest, GroupCommitTest) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  OptimisticTransactionOptions txn_options;
+  txn_options.group_commit = true;
+  string value;
+  Status s;
+
+  txn_db->Put(write_options, "foo", "bar");
+
+  Transaction* txn = txn_db->BeginTransaction(write_options, txn_options);
+  ASSERT_TRUE(txn);
+  txn->Put("foo", "bar2");
+  txn->Put("foo2", "bar2");
+
+  // This Put outside of a transaction will conflict with the previous write
+  s = txn_db->Put(write_options, "foo", "barz");
+  ASSERT_OK(s);
+
+  s = txn->Commit();
+  ASSERT_TRUE(s.IsBusy());  // Txn should not commit
+
+  // Verify that transaction did not write anything
+  txn_db->Get(read_options, "foo", &value);
+  ASSERT_EQ(value, "barz");
+  s = txn_db->Get(read_options, "foo2", &value);
+  ASSERT_TRUE(s.IsNotFound());
+
+  txn = txn_db->BeginTransaction(write_options, txn_options, txn);
+  txn->Put("foo", "bar3");
+  txn->Put("foo2", "bar3");
+  s = txn->Commit();
+  ASSERT_OK(s);
+
+  txn_db->Get(read_options, "foo", &value);
+  ASSERT_EQ(value, "bar3");
+  txn_db->Get(read_options, "foo2", &value);
+  ASSERT_EQ(value, "bar3");
+
+  delete txn;
+}
+
+// Concurrent read-modify-writes of one key are only serializable if the
+// conflict check of a group commit sees the writes of the earlier members of
+// its group.
+TEST_F(OptimisticTransactionTest, GroupCommitCounterTest) {
+  const size_t num_threads = 8;
+  const size_t num_increments_per_thread = 200;
+  WriteOptions write_options;
+  ReadOptions read_options;
+  ASSERT_OK(txn_db->Put(write_options, "counter", "0"));
+
+  std::vector<port::Thread> threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back([&] {
+      OptimisticTransactionOptions txn_options;
+      txn_options.group_commit = true;
+      Transaction* txn = nullptr;
+      for (size_t n = 0; n < num_increments_per_thread;) {
+        txn = txn_db->BeginTransaction(write_options, txn_options, txn);
+        string value;
+        ASSERT_OK(txn->GetForUpdate(read_options, "counter", &value));
+        ASSERT_OK(txn->Put("counter", ToString(std::stoull(value) + 1)));
+        Status s = txn->Commit();
+        if (s.ok()) {
+          n++;
+        } else {
+          ASSERT_TRUE(s.IsBusy() || s.IsTryAgain());
+          txn->Rollback();
+        }
+      }
+      delete txn;
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  string value;
+  ASSERT_OK(txn_db->Get(read_options, "counter", &value));
+  ASSERT_EQ(ToString(num_threads * num_increments_per_thread), value);
+}
+
 TEST_F(OptimisticTransactionTest, WriteConflictTest2) {
   WriteOptions write_options;
   ReadOptions read_options;
@@ -1288,13 +1372,15 @@ namespace {
 Status OptimisticTransactionStressTestInserter(OptimisticTransactionDB* db,
                                                const size_t num_transactions,
                                                const size_t num_sets,
-                                               const size_t num_keys_per_set) {
+                                               const size_t num_keys_per_set,
+                                               bool group_commit = false) {
   size_t seed = std::hash<std::thread::id>()(std::this_thread::get_id());
   Random64 _rand(seed);
   WriteOptions write_options;
   ReadOptions read_options;
   OptimisticTransactionOptions txn_options;
   txn_options.set_snapshot = true;
+  txn_options.group_commit = group_commit;
 
   RandomTransactionInserter inserter(&_rand, write_options, read_options,
                                      num_keys_per_set,
@@ -1351,6 +1437,33 @@ TEST_F(OptimisticTransactionTest, OptimisticTransactionStressTest) {
   ASSERT_OK(s);
 }
 
+TEST_F(OptimisticTransactionTest, OptimisticTransactionGroupCommitStressTest) {
+  const size_t num_threads = 4;
+  const size_t num_transactions_per_thread = 10000;
+  const size_t num_sets = 3;
+  const size_t num_keys_per_set = 100;
+
+  std::vector<port::Thread> threads;
+
+  std::function<void()> call_inserter = [&] {
+    ASSERT_OK(OptimisticTransactionStressTestInserter(
+        txn_db, num_transactions_per_thread, num_sets, num_keys_per_set,
+        true /* group_commit */));
+  };
+
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(call_inserter);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // Verify that data is consistent
+  Status s = RandomTransactionInserter::Verify(txn_db, num_sets);
+  ASSERT_OK(s);
+}
+
 TEST_F(OptimisticTransactionTest, SequenceNumberAfterRecoverTest) {
   WriteOptions write_options;
   OptimisticTransactionOptions transaction_options;
@@ -35,7 +35,9 @@ PessimisticTransactionDB::PessimisticTransactionDB(
     : TransactionDB(db),
       db_impl_(static_cast_with_check<DBImpl, DB>(db)),
       txn_db_options_(txn_db_options),
-      lock_mgr_(this, txn_db_options_.num_stripes, txn_db_options.max_num_locks,
+      lock_mgr_(this, txn_db_options_.num_stripes,
+                txn_db_options_.lock_words_per_stripe,
+                txn_db_options.max_num_locks,
                 txn_db_options_.max_num_deadlocks,
                 txn_db_options_.custom_mutex_factory
                     ? txn_db_options_.custom_mutex_factory
@@ -66,7 +68,9 @@ PessimisticTransactionDB::PessimisticTransactionDB(
     : TransactionDB(db),
       db_impl_(static_cast_with_check<DBImpl, DB>(db->GetRootDB())),
       txn_db_options_(txn_db_options),
-      lock_mgr_(this, txn_db_options_.num_stripes, txn_db_options.max_num_locks,
+      lock_mgr_(this, txn_db_options_.num_stripes,
+                txn_db_options_.lock_words_per_stripe,
+                txn_db_options.max_num_locks,
                 txn_db_options_.max_num_deadlocks,
                 txn_db_options_.custom_mutex_factory
                     ? txn_db_options_.custom_mutex_factory
@@ -18,6 +18,7 @@
 #include <functional>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "monitoring/perf_context_imp.h"
@@ -48,8 +49,70 @@ struct LockInfo {
         expiration_time(lock_info.expiration_time) {}
 };
 
+// Lock word of a key locked exclusively without the stripe mutex. Holds the
+// owner's TransactionID, or 0 when free.
+struct LockWord {
+  // Set while the owner writes key, readers must retry
+  static const uint64_t kBusy = 1ull << 63;
+  // Set while a reader compares key, the owner waits for it before releasing
+  static const uint64_t kPinned = 1ull << 62;
+
+  std::atomic<uint64_t> word{0};
+  // Only written by the owner while kBusy is set
+  std::string key;
+
+  // Owner side, lock free
+
+  // Takes the word for id; Publish() or Abandon() must follow
+  bool TryAcquire(TransactionID id, const std::string& k) {
+    assert((id & (kBusy | kPinned)) == 0);
+    uint64_t expected = 0;
+    if (!word.compare_exchange_strong(expected, id | kBusy)) {
+      return false;
+    }
+    key.assign(k);
+    return true;
+  }
+  void Publish(TransactionID id) { word.store(id, std::memory_order_release); }
+  void Abandon() { word.store(0, std::memory_order_release); }
+
+  bool OwnedBy(TransactionID id, const std::string& k) const {
+    return (word.load(std::memory_order_relaxed) & ~kPinned) == id && key == k;
+  }
+
+  void Release(TransactionID id) {
+    uint64_t expected = id;
+    while (!word.compare_exchange_strong(expected, 0)) {
+      assert(expected == (id | kPinned));
+      expected = id;
+      std::this_thread::yield();
+    }
+  }
+
+  // Reader side. REQUIRED: stripe mutex held, so there is one reader at most.
+
+  // Returns the owner, or 0 if free. key is stable until Unpin(owner).
+  TransactionID Pin() {
+    uint64_t w = word.load();
+    while (w != 0) {
+      if (w & kBusy) {
+        std::this_thread::yield();
+        w = word.load();
+      } else if (word.compare_exchange_weak(w, w | kPinned)) {
+        break;
+      }
+    }
+    return w;
+  }
+  void Unpin(TransactionID owner) {
+    word.store(owner, std::memory_order_release);
+  }
+};
+
 struct LockMapStripe {
-  explicit LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory) {
+  explicit LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory,
+                         size_t num_lock_words)
+      : lock_words(num_lock_words) {
     stripe_mutex = factory->AllocateMutex();
     stripe_cv = factory->AllocateCondVar();
     assert(stripe_mutex);
@@ -65,16 +128,27 @@ struct LockMapStripe {
   // Locked keys mapped to the info about the transactions that locked them.
   // TODO(agiardullo): Explore performance of other data structures.
   std::unordered_map<std::string, LockInfo> keys;
+
+  // Exclusive locks taken by TryLockFast(), a key is never held both here
+  // and in keys
+  std::vector<LockWord> lock_words;
+
+  // Size of keys, and number of threads inside AcquireWithTimeout(). Both
+  // only change under stripe_mutex, the fast path is only taken while both
+  // are zero.
+  std::atomic<size_t> num_keys{0};
+  std::atomic<size_t> num_acquirers{0};
 };
 
 // Map of #num_stripes LockMapStripes
 struct LockMap {
-  explicit LockMap(size_t num_stripes,
+  explicit LockMap(size_t num_stripes, size_t lock_words_per_stripe,
                    std::shared_ptr<TransactionDBMutexFactory> factory)
-      : num_stripes_(num_stripes) {
+      : num_stripes_(num_stripes),
+        lock_words_per_stripe_(lock_words_per_stripe) {
     lock_map_stripes_.reserve(num_stripes);
     for (size_t i = 0; i < num_stripes; i++) {
-      LockMapStripe* stripe = new LockMapStripe(factory);
+      LockMapStripe* stripe = new LockMapStripe(factory, lock_words_per_stripe);
       lock_map_stripes_.push_back(stripe);
     }
   }
@@ -88,13 +162,16 @@ struct LockMap {
   // Number of sepearate LockMapStripes to create, each with their own Mutex
   const size_t num_stripes_;
 
+  const size_t lock_words_per_stripe_;
+
   // Count of keys that are currently locked in this column family.
   // (Only maintained if TransactionLockMgr::max_num_locks_ is positive.)
   std::atomic<int64_t> lock_cnt{0};
 
   std::vector<LockMapStripe*> lock_map_stripes_;
 
-  size_t GetStripe(const std::string& key) const;
+  // Sets *lock_word to the key's lock word within the stripe, if not null
+  size_t GetStripe(const std::string& key, size_t* lock_word = nullptr) const;
 };
 
 void DeadlockInfoBuffer::AddNewPath(DeadlockPath path) {
@@ -165,11 +242,13 @@ void UnrefLockMapsCache(void* ptr) {
 }  // anonymous namespace
 
 TransactionLockMgr::TransactionLockMgr(
-    TransactionDB* txn_db, size_t default_num_stripes, int64_t max_num_locks,
+    TransactionDB* txn_db, size_t default_num_stripes,
+    size_t lock_words_per_stripe, int64_t max_num_locks,
     uint32_t max_num_deadlocks,
     std::shared_ptr<TransactionDBMutexFactory> mutex_factory)
     : txn_db_impl_(nullptr),
       default_num_stripes_(default_num_stripes),
+      lock_words_per_stripe_(lock_words_per_stripe),
       max_num_locks_(max_num_locks),
       lock_maps_cache_(new ThreadLocalPtr(&UnrefLockMapsCache)),
       dlock_buffer_(max_num_deadlocks),
@@ -181,10 +260,14 @@ TransactionLockMgr::TransactionLockMgr(
 
 TransactionLockMgr::~TransactionLockMgr() {}
 
-size_t LockMap::GetStripe(const std::string& key) const {
+size_t LockMap::GetStripe(const std::string& key, size_t* lock_word) const {
   assert(num_stripes_ > 0);
   static murmur_hash hash;
-  size_t stripe = hash(key) % num_stripes_;
+  size_t h = hash(key);
+  size_t stripe = h % num_stripes_;
+  if (lock_word != nullptr && lock_words_per_stripe_ > 0) {
+    *lock_word = h / num_stripes_ % lock_words_per_stripe_;
+  }
   return stripe;
 }
 
@@ -194,7 +277,8 @@ void TransactionLockMgr::AddColumnFamily(uint32_t column_family_id) {
   if (lock_maps_.find(column_family_id) == lock_maps_.end()) {
     lock_maps_.emplace(column_family_id,
                        std::shared_ptr<LockMap>(
-                           new LockMap(default_num_stripes_, mutex_factory_)));
+                           new LockMap(default_num_stripes_,
+                                       lock_words_per_stripe_, mutex_factory_)));
   } else {
     // column_family already exists in lock map
     assert(false);
@@ -304,22 +388,79 @@ Status TransactionLockMgr::TryLock(PessimisticTransaction* txn,
   }
 
   // Need to lock the mutex for the stripe that this key hashes to
-  size_t stripe_num = lock_map->GetStripe(key);
+  size_t lock_word = 0;
+  size_t stripe_num = lock_map->GetStripe(key, &lock_word);
   assert(lock_map->lock_map_stripes_.size() > stripe_num);
   LockMapStripe* stripe = lock_map->lock_map_stripes_.at(stripe_num);
 
+  if (exclusive && TryLockFast(txn, stripe, lock_word, key)) {
+    return Status::OK();
+  }
+
   LockInfo lock_info(txn->GetID(), txn->GetExpirationTime(), exclusive);
   int64_t timeout = txn->GetLockTimeout();
 
-  return AcquireWithTimeout(txn, lock_map, stripe, column_family_id, key, env,
-                            timeout, lock_info);
+  return AcquireWithTimeout(txn, lock_map, stripe, lock_word, column_family_id,
+                            key, env, timeout, lock_info);
+}
+
+// Takes an exclusive lock on the key's lock word without the stripe mutex.
+// Only possible while the stripe holds no keys and nobody waits on it, so
+// lock words never conflict with the stripe's keys map. Locks that can
+// expire or count towards max_num_locks_ always go through the mutex.
+bool TransactionLockMgr::TryLockFast(PessimisticTransaction* txn,
+                                     LockMapStripe* stripe, size_t lock_word,
+                                     const std::string& key) {
+  if (stripe->lock_words.empty() || max_num_locks_ > 0 ||
+      txn->GetExpirationTime() > 0) {
+    return false;
+  }
+  LockWord& word = stripe->lock_words[lock_word];
+  TransactionID id = txn->GetID();
+  if (word.OwnedBy(id, key)) {
+    return true;
+  }
+  if (stripe->num_keys.load() != 0 || stripe->num_acquirers.load() != 0 ||
+      !word.TryAcquire(id, key)) {
+    return false;
+  }
+  // Pairs with the increment of num_acquirers before AcquireLocked() reads
+  // the lock word: either that reader sees this word, or we see it coming.
+  if (stripe->num_keys.load() != 0 || stripe->num_acquirers.load() != 0) {
+    word.Abandon();
+    return false;
+  }
+  word.Publish(id);
+  return true;
+}
+
+bool TransactionLockMgr::UnLockFast(const PessimisticTransaction* txn,
+                                    LockMapStripe* stripe, size_t lock_word,
+                                    const std::string& key) {
+  if (stripe->lock_words.empty()) {
+    return false;
+  }
+  LockWord& word = stripe->lock_words[lock_word];
+  TransactionID id = txn->GetID();
+  if (!word.OwnedBy(id, key)) {
+    return false;
+  }
+  word.Release(id);
+  if (stripe->num_acquirers.load() != 0) {
+    // A waiter counted itself before reading the word, taking the mutex
+    // makes sure it is already waiting on the condvar
+    stripe->stripe_mutex->Lock();
+    stripe->stripe_mutex->UnLock();
+    stripe->stripe_cv->NotifyAll();
+  }
+  return true;
 }
 
 // Helper function for TryLock().
 Status TransactionLockMgr::AcquireWithTimeout(
     PessimisticTransaction* txn, LockMap* lock_map, LockMapStripe* stripe,
-    uint32_t column_family_id, const std::string& key, Env* env,
-    int64_t timeout, const LockInfo& lock_info) {
+    size_t lock_word, uint32_t column_family_id, const std::string& key,
+    Env* env, int64_t timeout, const LockInfo& lock_info) {
   Status result;
   uint64_t end_time = 0;
 
@@ -339,11 +480,12 @@ Status TransactionLockMgr::AcquireWithTimeout(
     // failed to acquire mutex
     return result;
   }
+  stripe->num_acquirers++;
 
   // Acquire lock if we are able to
   uint64_t expire_time_hint = 0;
   autovector<TransactionID> wait_ids;
-  result = AcquireLocked(lock_map, stripe, key, env, lock_info,
+  result = AcquireLocked(lock_map, stripe, lock_word, key, env, lock_info,
                          &expire_time_hint, &wait_ids);
 
   if (!result.ok() && timeout != 0) {
@@ -374,6 +516,7 @@ Status TransactionLockMgr::AcquireWithTimeout(
           if (IncrementWaiters(txn, wait_ids, key, column_family_id,
                                lock_info.exclusive, env)) {
             result = Status::Busy(Status::SubCode::kDeadlock);
+            stripe->num_acquirers--;
             stripe->stripe_mutex->UnLock();
             return result;
           }
@@ -408,12 +551,13 @@ Status TransactionLockMgr::AcquireWithTimeout(
       }
 
       if (result.ok() || result.IsTimedOut()) {
-        result = AcquireLocked(lock_map, stripe, key, env, lock_info,
-                               &expire_time_hint, &wait_ids);
+        result = AcquireLocked(lock_map, stripe, lock_word, key, env,
+                               lock_info, &expire_time_hint, &wait_ids);
       }
     } while (!result.ok() && !timed_out);
   }
 
+  stripe->num_acquirers--;
   stripe->stripe_mutex->UnLock();
 
   return result;
@@ -526,6 +670,7 @@ bool TransactionLockMgr::IncrementWaiters(
 // REQUIRED:  Stripe mutex must be held.
 Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
                                          LockMapStripe* stripe,
+                                         size_t lock_word,
                                          const std::string& key, Env* env,
                                          const LockInfo& txn_lock_info,
                                          uint64_t* expire_time,
@@ -533,6 +678,23 @@ Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
   assert(txn_lock_info.txn_ids.size() == 1);
 
   Status result;
+  if (!stripe->lock_words.empty()) {
+    // Check if the key is held in its lock word, such locks never expire
+    LockWord& word = stripe->lock_words[lock_word];
+    TransactionID owner = word.Pin();
+    if (owner != 0) {
+      bool held = word.key == key;
+      word.Unpin(owner);
+      if (held) {
+        if (owner != txn_lock_info.txn_ids[0]) {
+          result = Status::TimedOut(Status::SubCode::kLockTimeout);
+          txn_ids->clear();
+          txn_ids->push_back(owner);
+        }
+        return result;
+      }
+    }
+  }
   // Check if this key is already locked
   auto stripe_iter = stripe->keys.find(key);
   if (stripe_iter != stripe->keys.end()) {
@@ -580,6 +742,7 @@ Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
     } else {
       // acquire lock
       stripe->keys.insert({key, txn_lock_info});
+      stripe->num_keys++;
 
       // Maintain lock count if there is a limit on the number of locks
       if (max_num_locks_) {
@@ -608,6 +771,7 @@ void TransactionLockMgr::UnLockKey(const PessimisticTransaction* txn,
     if (txn_it != txns.end()) {
       if (txns.size() == 1) {
         stripe->keys.erase(stripe_iter);
+        stripe->num_keys--;
       } else {
         auto last_it = txns.end() - 1;
         if (txn_it != last_it) {
@@ -641,16 +805,24 @@ void TransactionLockMgr::UnLock(PessimisticTransaction* txn,
   }
 
   // Lock the mutex for the stripe that this key hashes to
-  size_t stripe_num = lock_map->GetStripe(key);
+  size_t lock_word = 0;
+  size_t stripe_num = lock_map->GetStripe(key, &lock_word);
   assert(lock_map->lock_map_stripes_.size() > stripe_num);
   LockMapStripe* stripe = lock_map->lock_map_stripes_.at(stripe_num);
 
+  if (UnLockFast(txn, stripe, lock_word, key)) {
+    return;
+  }
+
   stripe->stripe_mutex->Lock();
   UnLockKey(txn, key, stripe, lock_map, env);
+  bool has_waiters = stripe->num_acquirers.load() != 0;
   stripe->stripe_mutex->UnLock();
 
   // Signal waiting threads to retry locking
-  stripe->stripe_cv->NotifyAll();
+  if (has_waiters) {
+    stripe->stripe_cv->NotifyAll();
+  }
 }
 
 void TransactionLockMgr::UnLock(const PessimisticTransaction* txn,
@@ -674,7 +846,12 @@ void TransactionLockMgr::UnLock(const PessimisticTransaction* txn,
     for (auto& key_iter : keys) {
       const std::string& key = key_iter.first;
 
-      size_t stripe_num = lock_map->GetStripe(key);
+      size_t lock_word = 0;
+      size_t stripe_num = lock_map->GetStripe(key, &lock_word);
+      if (UnLockFast(txn, lock_map->lock_map_stripes_[stripe_num], lock_word,
+                     key)) {
+        continue;
+      }
       keys_by_stripe[stripe_num].push_back(&key);
     }
 
@@ -691,11 +868,14 @@ void TransactionLockMgr::UnLock(const PessimisticTransaction* txn,
       for (const std::string* key : stripe_keys) {
         UnLockKey(txn, *key, stripe, lock_map, env);
       }
+      bool has_waiters = stripe->num_acquirers.load() != 0;
 
       stripe->stripe_mutex->UnLock();
 
       // Signal waiting threads to retry locking
-      stripe->stripe_cv->NotifyAll();
+      if (has_waiters) {
+        stripe->stripe_cv->NotifyAll();
+      }
     }
   }
 }
@@ -727,6 +907,17 @@ TransactionLockMgr::LockStatusData TransactionLockMgr::GetLockStatusData() {
         }
         data.insert({i, info});
       }
+      for (auto& word : j->lock_words) {
+        TransactionID owner = word.Pin();
+        if (owner != 0) {
+          struct KeyLockInfo info;
+          info.exclusive = true;
+          info.key = word.key;
+          info.ids.push_back(owner);
+          word.Unpin(owner);
+          data.insert({i, info});
+        }
+      }
     }
   }
 
@@ -54,7 +54,8 @@ class PessimisticTransactionDB;
 class TransactionLockMgr {
  public:
   TransactionLockMgr(TransactionDB* txn_db, size_t default_num_stripes,
-                     int64_t max_num_locks, uint32_t max_num_deadlocks,
+                     size_t lock_words_per_stripe, int64_t max_num_locks,
+                     uint32_t max_num_deadlocks,
                      std::shared_ptr<TransactionDBMutexFactory> factory);
 
   ~TransactionLockMgr();
@@ -90,6 +91,9 @@ class TransactionLockMgr {
   // Default number of lock map stripes per column family
   const size_t default_num_stripes_;
 
+  // Number of lock words of the lock-free fast path per stripe
+  const size_t lock_words_per_stripe_;
+
   // Limit on number of keys locked per column family
   const int64_t max_num_locks_;
 
@@ -99,6 +103,9 @@ class TransactionLockMgr {
   //   - stripe mutexes in ascending cf id, ascending stripe order
   //   - wait_txn_map_mutex_
   //
+  // Lock words are never waited on while holding a mutex, except for the
+  // short pin of a reader holding the stripe mutex.
+  //
   // Must be held when accessing/modifying lock_maps_.
   InstrumentedMutex lock_map_mutex_;
 
@@ -127,13 +134,20 @@ class TransactionLockMgr {
 
   std::shared_ptr<LockMap> GetLockMap(uint32_t column_family_id);
 
+  bool TryLockFast(PessimisticTransaction* txn, LockMapStripe* stripe,
+                   size_t lock_word, const std::string& key);
+
+  bool UnLockFast(const PessimisticTransaction* txn, LockMapStripe* stripe,
+                  size_t lock_word, const std::string& key);
+
   Status AcquireWithTimeout(PessimisticTransaction* txn, LockMap* lock_map,
-                            LockMapStripe* stripe, uint32_t column_family_id,
-                            const std::string& key, Env* env, int64_t timeout,
+                            LockMapStripe* stripe, size_t lock_word,
+                            uint32_t column_family_id, const std::string& key,
+                            Env* env, int64_t timeout,
                             const LockInfo& lock_info);
 
   Status AcquireLocked(LockMap* lock_map, LockMapStripe* stripe,
-                       const std::string& key, Env* env,
+                       size_t lock_word, const std::string& key, Env* env,
                        const LockInfo& lock_info, uint64_t* wait_time,
                        autovector<TransactionID>* txn_ids);
 
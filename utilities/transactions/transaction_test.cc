@@ -269,6 +269,46 @@ TEST_P(TransactionTest, WaitingTxn) {
   delete txn2;
 }
 
+TEST_P(TransactionTest, LockWordWakesWaiter) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  TransactionOptions txn_options;
+  string value;
+
+  txn_options.lock_timeout = 10000;
+  Transaction* txn1 = db->BeginTransaction(write_options);
+  Transaction* txn2 = db->BeginTransaction(write_options, txn_options);
+
+  // Uncontended, taken on the key's lock word
+  ASSERT_OK(txn1->Put("foo", "bar"));
+  auto lock_data = db->GetLockStatusData();
+  ASSERT_EQ(lock_data.size(), 1);
+  ASSERT_EQ(lock_data.begin()->second.key, "foo");
+  ASSERT_TRUE(lock_data.begin()->second.exclusive);
+  ASSERT_EQ(lock_data.begin()->second.ids[0], txn1->GetID());
+
+  std::atomic<bool> locked(false);
+  port::Thread waiter([&]() {
+    ASSERT_OK(txn2->Put("foo", "baz"));
+    locked = true;
+  });
+  env->SleepForMicroseconds(100000);
+  ASSERT_FALSE(locked);
+
+  // Releasing the lock word must wake the waiter up
+  ASSERT_OK(txn1->Commit());
+  waiter.join();
+  ASSERT_TRUE(locked);
+  ASSERT_OK(txn2->Commit());
+
+  ASSERT_OK(db->Get(read_options, "foo", &value));
+  ASSERT_EQ(value, "baz");
+  ASSERT_EQ(db->GetLockStatusData().size(), 0);
+
+  delete txn1;
+  delete txn2;
+}
+
 TEST_P(TransactionTest, SharedLocks) {
   WriteOptions write_options;
   ReadOptions read_options;
@@ -13,11 +13,13 @@
 
 #include <inttypes.h>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "db/db_impl.h"
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/write_batch_with_index.h"
+#include "rocksdb/write_batch.h"
 #include "util/string_util.h"
 
 namespace rocksdb {
@@ -160,6 +162,125 @@ Status TransactionUtil::CheckKeysForConflicts(DBImpl* db_impl,
   return result;
 }
 
+namespace {
+
+// Collects the keys written by the batches of a commit group, which the
+// transactions later in the group must not have seen modified.
+class GroupWrittenKeys : public WriteBatch::Handler {
+ public:
+  Status PutCF(uint32_t column_family_id, const Slice& key,
+               const Slice& /*value*/) override {
+    return Add(column_family_id, key);
+  }
+
+  Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+    return Add(column_family_id, key);
+  }
+
+  Status SingleDeleteCF(uint32_t column_family_id, const Slice& key) override {
+    return Add(column_family_id, key);
+  }
+
+  Status MergeCF(uint32_t column_family_id, const Slice& key,
+                 const Slice& /*value*/) override {
+    return Add(column_family_id, key);
+  }
+
+  // Transactions do not write ranges, so rather than comparing against them
+  // every later key of the column family is considered written.
+  Status DeleteRangeCF(uint32_t column_family_id, const Slice& /*begin_key*/,
+                       const Slice& /*end_key*/) override {
+    range_deleted_.insert(column_family_id);
+    return Status::OK();
+  }
+
+  bool Contains(uint32_t column_family_id, const std::string& key) const {
+    if (range_deleted_.count(column_family_id) > 0) {
+      return true;
+    }
+    auto iter = keys_.find(column_family_id);
+    return iter != keys_.end() && iter->second.count(key) > 0;
+  }
+
+ private:
+  Status Add(uint32_t column_family_id, const Slice& key) {
+    keys_[column_family_id].insert(key.ToString());
+    return Status::OK();
+  }
+
+  std::unordered_map<uint32_t, std::unordered_set<std::string>> keys_;
+  std::unordered_set<uint32_t> range_deleted_;
+};
+
+}  // namespace
+
+Status TransactionUtil::CheckGroupForConflicts(
+    DBImpl* db_impl, const std::vector<const TransactionKeyMap*>& key_maps,
+    const std::vector<WriteBatch*>& batches, bool cache_only,
+    std::vector<Status>* statuses) {
+  assert(key_maps.size() == batches.size());
+  struct ColumnFamilyState {
+    SuperVersion* sv;
+    SequenceNumber earliest_seq;
+  };
+  std::unordered_map<uint32_t, ColumnFamilyState> cf_states;
+  GroupWrittenKeys written_keys;
+  Status result;
+
+  statuses->assign(key_maps.size(), Status::OK());
+  for (size_t i = 0; i < key_maps.size(); i++) {
+    Status s;
+    for (auto& key_map_iter : *key_maps[i]) {
+      uint32_t cf_id = key_map_iter.first;
+      const auto& keys = key_map_iter.second;
+
+      auto cf_iter = cf_states.find(cf_id);
+      if (cf_iter == cf_states.end()) {
+        SuperVersion* sv = db_impl->GetAndRefSuperVersion(cf_id);
+        if (sv == nullptr) {
+          s = Status::InvalidArgument("Could not access column family " +
+                                      ToString(cf_id));
+          break;
+        }
+        ColumnFamilyState state = {
+            sv, db_impl->GetEarliestMemTableSequenceNumber(sv, true)};
+        cf_iter = cf_states.emplace(cf_id, state).first;
+      }
+
+      for (const auto& key_iter : keys) {
+        const auto& key = key_iter.first;
+        if (written_keys.Contains(cf_id, key)) {
+          // Written by an earlier transaction of this group
+          s = Status::Busy();
+        } else {
+          s = CheckKey(db_impl, cf_iter->second.sv,
+                       cf_iter->second.earliest_seq, key_iter.second.seq, key,
+                       cache_only);
+        }
+        if (!s.ok()) {
+          break;
+        }
+      }
+      if (!s.ok()) {
+        break;
+      }
+    }
+
+    if (s.ok()) {
+      s = batches[i]->Iterate(&written_keys);
+    }
+    if (!s.ok() && result.ok()) {
+      result = s;
+    }
+    (*statuses)[i] = s;
+  }
+
+  for (auto& cf_state : cf_states) {
+    db_impl->ReturnAndCleanupSuperVersion(cf_state.first, cf_state.second.sv);
+  }
+
+  return result;
+}
 
 }  // namespace rocksdb
 
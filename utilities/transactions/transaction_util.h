@@ -9,6 +9,7 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "db/read_callback.h"
 
@@ -38,6 +39,7 @@ using TransactionKeyMap =
 
 class DBImpl;
 struct SuperVersion;
+class WriteBatch;
 class WriteBatchWithIndex;
 
 class TransactionUtil {
@@ -70,6 +72,23 @@ class TransactionUtil {
                                       const TransactionKeyMap& keys,
                                       bool cache_only);
 
+  // Like CheckKeysForConflicts, but for a group of transactions that are
+  // written together as one batch. The SuperVersion of each column family is
+  // referenced once for the whole group. batches[i] holds the writes of the
+  // transaction that tracked key_maps[i]. Since those writes are not in the
+  // memtables yet, a key also conflicts if an earlier transaction of the group
+  // that passed its check writes it.
+  //
+  // (*statuses)[i] is set to the result of the i-th transaction. Returns the
+  // first non-OK result, or OK if all of them passed.
+  //
+  // REQUIRED: this function should only be called on the write thread or if the
+  // mutex is held.
+  static Status CheckGroupForConflicts(
+      DBImpl* db_impl, const std::vector<const TransactionKeyMap*>& key_maps,
+      const std::vector<WriteBatch*>& batches, bool cache_only,
+      std::vector<Status>* statuses);
+
  private:
   static Status CheckKey(DBImpl* db_impl, SuperVersion* sv,
                          SequenceNumber earliest_seq, SequenceNumber snap_seq,
@@ -807,6 +807,7 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
   SequenceNumber seq = 0;
   // Take the first snapshot that overlaps with two txn
   auto prep_seq = ++seq;
+  auto prep_seq1 = prep_seq;
   wp_db->AddPrepared(prep_seq);
   auto prep_seq2 = ++seq;
   wp_db->AddPrepared(prep_seq2);
@@ -820,6 +821,7 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
   wp_db->RemovePrepared(prep_seq2);
   // Take the 2nd and 3rd snapshot that overlap with the same txn
   prep_seq = ++seq;
+  auto prep_seq3 = prep_seq;
   wp_db->AddPrepared(prep_seq);
   auto snap_seq2 = seq;
   wp_db->TakeSnapshot(snap_seq2);
@@ -828,6 +830,7 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
   wp_db->TakeSnapshot(snap_seq3);
   seq++;
   commit_seq = ++seq;
+  auto commit_seq3 = commit_seq;
   wp_db->AddCommitted(prep_seq, commit_seq);
   wp_db->RemovePrepared(prep_seq);
   // Make sure max_evicted_seq_ will be larger than 2nd snapshot by evicting the
@@ -848,6 +851,11 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
     ASSERT_EQ(1, wp_db->old_commit_map_[snap_seq2].size());
     ASSERT_EQ(1, wp_db->old_commit_map_[snap_seq3].size());
   }
+  // The lock-free bounds cover all the entries
+  ASSERT_EQ(prep_seq1, wp_db->old_commit_map_min_prep_.load());
+  ASSERT_EQ(commit_seq3, wp_db->old_commit_map_max_commit_.load());
+  // and rule out the lookups that fall outside them
+  ASSERT_TRUE(wp_db->IsInSnapshot(prep_seq3, commit_seq3));
 
   // Verify that the 2nd snapshot is cleaned up after the release
   wp_db->ReleaseSnapshotInternal(snap_seq2);
@@ -867,6 +875,10 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
     ASSERT_EQ(1, wp_db->old_commit_map_.size());
     ASSERT_EQ(1, wp_db->old_commit_map_[snap_seq3].size());
   }
+  // The bounds shrink to the entries of the remaining snapshot
+  ASSERT_EQ(prep_seq3, wp_db->old_commit_map_min_prep_.load());
+  ASSERT_EQ(commit_seq3, wp_db->old_commit_map_max_commit_.load());
+  ASSERT_FALSE(wp_db->IsInSnapshot(prep_seq3, snap_seq3));
 
   // Verify that the 3rd snapshot is cleaned up after the release
   wp_db->ReleaseSnapshotInternal(snap_seq3);
@@ -875,6 +887,8 @@ TEST_P(WritePreparedTransactionTest, OldCommitMapGC) {
     ReadLock rl(&wp_db->old_commit_map_mutex_);
     ASSERT_EQ(0, wp_db->old_commit_map_.size());
   }
+  ASSERT_EQ(kMaxSequenceNumber, wp_db->old_commit_map_min_prep_.load());
+  ASSERT_EQ(0, wp_db->old_commit_map_max_commit_.load());
 }
 
 TEST_P(WritePreparedTransactionTest, CheckAgainstSnapshotsTest) {
@@ -580,6 +580,18 @@ void WritePreparedTxnDB::ReleaseSnapshotInternal(
       old_commit_map_.erase(snap_seq);
       old_commit_map_empty_.store(old_commit_map_.empty(),
                                   std::memory_order_release);
+      // Shrink the bounds to what is left. The vectors are sorted so the
+      // smallest prep_seq of each snapshot is at its front.
+      SequenceNumber min_prep = kMaxSequenceNumber;
+      for (auto& prep_set_entry : old_commit_map_) {
+        if (!prep_set_entry.second.empty()) {
+          min_prep = std::min(min_prep, prep_set_entry.second.front());
+        }
+      }
+      old_commit_map_min_prep_.store(min_prep, std::memory_order_release);
+      if (old_commit_map_.empty()) {
+        old_commit_map_max_commit_.store(0, std::memory_order_release);
+      }
     }
   }
 }
@@ -760,6 +772,13 @@ bool WritePreparedTxnDB::MaybeUpdateOldCommitMap(
     old_commit_map_empty_.store(false, std::memory_order_release);
     auto& vec = old_commit_map_[snapshot_seq];
     vec.insert(std::upper_bound(vec.begin(), vec.end(), prep_seq), prep_seq);
+    if (prep_seq < old_commit_map_min_prep_.load(std::memory_order_relaxed)) {
+      old_commit_map_min_prep_.store(prep_seq, std::memory_order_release);
+    }
+    if (old_commit_map_max_commit_.load(std::memory_order_relaxed) <
+        commit_seq) {
+      old_commit_map_max_commit_.store(commit_seq, std::memory_order_release);
+    }
     // We need to store it once for each overlapping snapshot. Returning true to
     // continue the search if there is more overlapping snapshot.
     return true;
@@ -215,6 +215,18 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
           prep_seq, snapshot_seq, 1);
       return true;
     }
+    // Every entry of old_commit_map_ is an evicted <prep_seq, commit_seq> that
+    // satisfies old_commit_map_min_prep_ <= prep_seq and snapshot_seq <
+    // commit_seq <= old_commit_map_max_commit_. Outside of this interval there
+    // is nothing to find, which spares most reads of old snapshots the mutex.
+    if (prep_seq < old_commit_map_min_prep_.load(std::memory_order_acquire) ||
+        old_commit_map_max_commit_.load(std::memory_order_acquire) <=
+            snapshot_seq) {
+      ROCKS_LOG_DETAILS(
+          info_log_, "IsInSnapshot %" PRIu64 " in %" PRIu64 " returns %" PRId32,
+          prep_seq, snapshot_seq, 1);
+      return true;
+    }
     {
       // We should not normally reach here unless sapshot_seq is old. This is a
       // rare case and it is ok to pay the cost of mutex ReadLock for such old,
@@ -602,6 +614,14 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
   std::atomic<bool> delayed_prepared_empty_ = {true};
   // Update when old_commit_map_.empty() changes. Expected to be true normally.
   std::atomic<bool> old_commit_map_empty_ = {true};
+  // The smallest prep_seq and the largest commit_seq of the entries added to
+  // old_commit_map_, which lets IsInSnapshot rule out most lookups without
+  // taking old_commit_map_mutex_. Written under old_commit_map_mutex_ before
+  // the entry is overwritten in commit_cache_. The min is recomputed when a
+  // snapshot is garbage collected and the max only drops when the map gets
+  // empty, so both remain valid bounds for the remaining entries.
+  std::atomic<SequenceNumber> old_commit_map_min_prep_ = {kMaxSequenceNumber};
+  std::atomic<SequenceNumber> old_commit_map_max_commit_ = {0};
   mutable port::RWMutex prepared_mutex_;
   mutable port::RWMutex old_commit_map_mutex_;
   mutable port::RWMutex commit_cache_mutex_;
@@ -0,0 +1,213 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#if !defined(GFLAGS) || defined(ROCKSDB_LITE)
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <inttypes.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "db/db_impl.h"
+#include "port/port.h"
+#include "port/stack_trace.h"
+#include "rocksdb/env.h"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+#include "util/stop_watch.h"
+#include "util/testharness.h"
+#include "utilities/transactions/write_prepared_txn_db.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_int32(num_txns, 1000000, "Number of transactions committed before "
+             "the lookups start");
+
+DEFINE_int32(concurrent_txns, 64,
+             "Number of transactions that are prepared but not yet "
+             "committed at any time");
+
+DEFINE_int32(num_snapshots, 2,
+             "Number of long-lived snapshots taken while the first 10% of "
+             "the transactions commit");
+
+DEFINE_int32(commit_cache_bits, 16,
+             "log2 of the number of commit cache entries. Smaller caches "
+             "evict more entries into the old commit map.");
+
+DEFINE_int32(snapshot_cache_bits, 7, "log2 of the snapshot cache size");
+
+DEFINE_int32(threads, 4, "Number of threads calling IsInSnapshot");
+
+DEFINE_int64(reads, 10000000, "Number of IsInSnapshot calls per thread");
+
+DEFINE_int32(old_snapshot_percent, 50,
+             "Percentage of the lookups done on the long-lived snapshots. "
+             "The others use the latest sequence number.");
+
+DEFINE_bool(verify, true,
+            "Check every result against the known commit sequence numbers "
+            "before timing the lookups");
+
+DEFINE_int64(seed, 0,
+             "Seed base for random number generators. "
+             "When 0 it is deterministic.");
+
+namespace rocksdb {
+
+namespace {
+
+// Feeds AdvanceMaxEvictedSeq with the benchmark snapshots instead of asking
+// the DB, which is never opened.
+class WritePreparedTxnDBBench : public WritePreparedTxnDB {
+ public:
+  WritePreparedTxnDBBench(DBImpl* db_impl, const TransactionDBOptions& opt)
+      : WritePreparedTxnDB(db_impl, opt, FLAGS_snapshot_cache_bits,
+                           FLAGS_commit_cache_bits) {}
+
+  void TakeSnapshot(SequenceNumber seq) { snapshots_.push_back(seq); }
+
+ protected:
+  virtual const std::vector<SequenceNumber> GetSnapshotListFromDB(
+      SequenceNumber /* unused */) override {
+    return snapshots_;
+  }
+
+ private:
+  std::vector<SequenceNumber> snapshots_;
+};
+
+struct ReadSnapshot {
+  SequenceNumber seq;
+  SequenceNumber min_uncommitted;
+};
+
+struct Lookup {
+  SequenceNumber prep_seq;
+  SequenceNumber commit_seq;
+};
+
+}  // namespace
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+
+  rocksdb::Options options;
+  rocksdb::TransactionDBOptions txn_db_options;
+  txn_db_options.write_policy = rocksdb::WRITE_PREPARED;
+  std::string dbname =
+      rocksdb::test::TmpDir() + "/write_prepared_txn_db_bench";
+  std::unique_ptr<rocksdb::WritePreparedTxnDBBench> wp_db(
+      new rocksdb::WritePreparedTxnDBBench(
+          new rocksdb::DBImpl(options, dbname), txn_db_options));
+
+  // Commit the transactions with a sliding window of concurrently prepared
+  // ones, so that each of them overlaps with a few others and the early
+  // snapshots see many evicted entries.
+  std::vector<rocksdb::ReadSnapshot> old_snapshots;
+  std::vector<rocksdb::Lookup> lookups;
+  lookups.reserve(FLAGS_num_txns);
+  std::deque<rocksdb::SequenceNumber> prepared;
+  rocksdb::SequenceNumber seq = 0;
+  const int snapshot_every =
+      std::max(FLAGS_num_txns / 10 / std::max(FLAGS_num_snapshots, 1), 1);
+  for (int i = 0; i < FLAGS_num_txns; i++) {
+    prepared.push_back(++seq);
+    wp_db->AddPrepared(seq);
+    if (static_cast<int>(old_snapshots.size()) < FLAGS_num_snapshots &&
+        i % snapshot_every == snapshot_every - 1) {
+      old_snapshots.push_back({seq, prepared.front()});
+      wp_db->TakeSnapshot(seq);
+    }
+    if (static_cast<int>(prepared.size()) > FLAGS_concurrent_txns) {
+      auto prep_seq = prepared.front();
+      prepared.pop_front();
+      wp_db->AddCommitted(prep_seq, ++seq);
+      wp_db->RemovePrepared(prep_seq);
+      lookups.push_back({prep_seq, seq});
+    }
+  }
+  const rocksdb::ReadSnapshot latest = {
+      seq, prepared.empty() ? seq + 1 : prepared.front()};
+  if (lookups.empty()) {
+    fprintf(stderr, "num_txns must be larger than concurrent_txns\n");
+    return 1;
+  }
+
+  auto pick_snapshot =
+      [&](rocksdb::Random64& rnd) -> const rocksdb::ReadSnapshot& {
+        if (!old_snapshots.empty() &&
+            static_cast<int>(rnd.Uniform(100)) < FLAGS_old_snapshot_percent) {
+          return old_snapshots[rnd.Uniform(old_snapshots.size())];
+        }
+        return latest;
+      };
+
+  if (FLAGS_verify) {
+    rocksdb::Random64 rnd(FLAGS_seed);
+    uint64_t wrong = 0;
+    for (auto& lookup : lookups) {
+      auto& snapshot = pick_snapshot(rnd);
+      bool expected = lookup.commit_seq <= snapshot.seq;
+      if (wp_db->IsInSnapshot(lookup.prep_seq, snapshot.seq,
+                              snapshot.min_uncommitted) != expected) {
+        wrong++;
+      }
+    }
+    if (wrong != 0) {
+      fprintf(stderr, "IsInSnapshot returned %" PRIu64 " wrong results\n",
+              wrong);
+      return 1;
+    }
+  }
+
+  std::atomic<uint64_t> visible(0);
+  std::vector<rocksdb::port::Thread> threads;
+  rocksdb::StopWatchNano timer(rocksdb::Env::Default(), true);
+  for (int t = 0; t < FLAGS_threads; t++) {
+    threads.emplace_back([&, t]() {
+      rocksdb::Random64 rnd(FLAGS_seed + t + 1);
+      uint64_t count = 0;
+      for (int64_t i = 0; i < FLAGS_reads; i++) {
+        auto& lookup = lookups[rnd.Uniform(lookups.size())];
+        auto& snapshot = pick_snapshot(rnd);
+        count += wp_db->IsInSnapshot(lookup.prep_seq, snapshot.seq,
+                                     snapshot.min_uncommitted);
+      }
+      visible.fetch_add(count, std::memory_order_relaxed);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  uint64_t elapsed = timer.ElapsedNanos();
+  uint64_t ops = static_cast<uint64_t>(FLAGS_reads) * FLAGS_threads;
+  fprintf(stdout,
+          "IsInSnapshot : %10.3f micros/op %10.0f ops/sec %" PRIu64
+          " ops %" PRIu64 " visible\n",
+          ops == 0 ? 0.0 : elapsed / 1000.0 / ops * FLAGS_threads,
+          elapsed == 0 ? 0.0 : ops * 1e9 / elapsed, ops, visible.load());
+  return 0;
+}
+
+#endif  // GFLAGS
@@ -0,0 +1,436 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include <algorithm>
+#include <cstring>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/utilities/write_batch_with_index.h"
+#include "util/arena.h"
+#include "utilities/write_batch_with_index/write_batch_with_index_internal.h"
+
+namespace rocksdb {
+
+namespace WriteBatchEntryBTreeIndexDetail {
+
+// Slots per node. The inline key chunks of a node fill four cache lines, so a
+// binary search over them rarely has to touch the write batch itself.
+static const size_t kFanout = 32;
+// Enough for kFanout ^ kMaxHeight entries
+static const size_t kMaxHeight = 16;
+
+// Big-endian load of key bytes [offset, offset + 8), zero padded. When two
+// chunks differ, their integer order is the bytewise order of the keys.
+inline uint64_t LoadKeyChunk(const Slice& key, size_t offset) {
+  uint64_t chunk = 0;
+  if (key.size() > offset) {
+    size_t n = std::min(sizeof chunk, key.size() - offset);
+    auto p = reinterpret_cast<const unsigned char*>(key.data()) + offset;
+    for (size_t i = 0; i < n; ++i) {
+      chunk |= uint64_t(p[i]) << (56 - 8 * i);
+    }
+  }
+  return chunk;
+}
+
+inline size_t SharedPrefixLength(const Slice& a, const Slice& b) {
+  size_t n = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < n && a[i] == b[i]) {
+    ++i;
+  }
+  return i;
+}
+
+}  // namespace WriteBatchEntryBTreeIndexDetail
+
+// B+tree over the entries of one column family. Every slot keeps, next to
+// the entry pointer, 8 key bytes following the prefix shared by all keys of
+// its node, so the common case of a comparison is an integer compare instead
+// of a lookup into the write batch. Inline chunks are only meaningful for
+// bytewise ordered keys; other comparators leave them zero and every
+// comparison falls through to the comparator.
+template <bool OverwriteKey>
+class WriteBatchEntryBTreeIndex : public WriteBatchEntryIndex {
+ protected:
+  typedef WriteBatchEntryComparator<OverwriteKey> EntryComparator;
+  static const size_t kFanout = WriteBatchEntryBTreeIndexDetail::kFanout;
+  static const size_t kMaxHeight = WriteBatchEntryBTreeIndexDetail::kMaxHeight;
+
+  struct Node {
+    uint32_t count;
+    uint32_t level;  // 0 for leaves
+    // Length of the key prefix shared by all slots, skipped by chunk
+    size_t shared;
+    uint64_t chunk[kFanout];
+    // Leaves: the entries. Inner nodes: the smallest entry of each child.
+    WriteBatchIndexEntry* entry[kFanout];
+  };
+  struct Leaf : public Node {
+    WriteBatchEntryBTreeIndex* tree;
+    Leaf* prev;
+    Leaf* next;
+  };
+  struct Inner : public Node {
+    Node* child[kFanout];
+  };
+  struct Path {
+    Inner* node[kMaxHeight];
+    size_t pos[kMaxHeight];
+    size_t depth;
+  };
+  struct Target {
+    WriteBatchIndexEntry* entry;
+    Slice key;
+  };
+
+  // Holds the current entry instead of a slot position: inserts shift slots
+  // and split leaves, but never move an entry out of the tree, so the
+  // position is recovered from the entry pointer on each step.
+  class BTreeIterator : public WriteBatchEntryIndex::Iterator {
+   public:
+    explicit BTreeIterator(Leaf* leaf) : key_(nullptr), leaf_(leaf) {}
+
+    bool Valid() const override { return key_ != nullptr; }
+    void SeekToFirst() override {
+      leaf_ = leaf_->tree->head_;
+      key_ = leaf_->count == 0 ? nullptr : leaf_->entry[0];
+    }
+    void SeekToLast() override {
+      leaf_ = leaf_->tree->tail_;
+      key_ = leaf_->count == 0 ? nullptr : leaf_->entry[leaf_->count - 1];
+    }
+    void Seek(WriteBatchIndexEntry* target) override {
+      key_ = leaf_->tree->Find(target, false, &leaf_);
+    }
+    void SeekForPrev(WriteBatchIndexEntry* target) override {
+      key_ = leaf_->tree->Find(target, true, &leaf_);
+    }
+    void Next() override {
+      assert(Valid());
+      size_t pos = Locate() + 1;
+      if (pos < leaf_->count) {
+        key_ = leaf_->entry[pos];
+      } else if (leaf_->next != nullptr) {
+        leaf_ = leaf_->next;
+        key_ = leaf_->entry[0];
+      } else {
+        key_ = nullptr;
+      }
+    }
+    void Prev() override {
+      assert(Valid());
+      size_t pos = Locate();
+      if (pos > 0) {
+        key_ = leaf_->entry[pos - 1];
+      } else if (leaf_->prev != nullptr) {
+        leaf_ = leaf_->prev;
+        key_ = leaf_->entry[leaf_->count - 1];
+      } else {
+        key_ = nullptr;
+      }
+    }
+    WriteBatchIndexEntry* key() const override { return key_; }
+
+   private:
+    size_t Locate() {
+      for (size_t i = 0; i < leaf_->count; ++i) {
+        if (leaf_->entry[i] == key_) {
+          return i;
+        }
+      }
+      // leaf was split since the last step
+      auto tree = leaf_->tree;
+      leaf_ = tree->Descend({key_, tree->Key(key_)}, nullptr);
+      for (size_t i = 0; i < leaf_->count; ++i) {
+        if (leaf_->entry[i] == key_) {
+          return i;
+        }
+      }
+      assert(false);
+      return 0;
+    }
+
+    WriteBatchIndexEntry* key_;
+    Leaf* leaf_;
+  };
+
+  EntryComparator comparator_;
+  Arena* arena_;
+  bool bytewise_;
+  Node* root_;
+  Leaf* head_;
+  Leaf* tail_;
+
+  Slice Key(const WriteBatchIndexEntry* entry) const {
+    return comparator_.extractor(entry);
+  }
+
+  Leaf* NewLeaf() {
+    auto leaf = new (arena_->AllocateAligned(sizeof(Leaf))) Leaf();
+    leaf->tree = this;
+    return leaf;
+  }
+  Inner* NewInner(uint32_t level) {
+    auto inner = new (arena_->AllocateAligned(sizeof(Inner))) Inner();
+    inner->level = level;
+    return inner;
+  }
+
+  // Number of slots of n ordered before target. With upper, slots equal to
+  // target are counted as well.
+  size_t Rank(const Node* n, const Target& t, bool upper) const {
+    size_t shared = n->shared;
+    if (shared > 0) {
+      Slice prefix = Key(n->entry[0]);
+      int c = memcmp(t.key.data(), prefix.data(),
+                     std::min(shared, t.key.size()));
+      if (c == 0 && t.key.size() < shared) {
+        c = -1;
+      }
+      if (c != 0) {
+        return c < 0 ? 0 : n->count;
+      }
+    }
+    uint64_t chunk =
+        bytewise_ ? WriteBatchEntryBTreeIndexDetail::LoadKeyChunk(t.key, shared)
+                  : 0;
+    size_t lo = 0, hi = n->count;
+    while (lo < hi) {
+      size_t mid = (lo + hi) / 2;
+      int c;
+      if (n->chunk[mid] != chunk) {
+        c = n->chunk[mid] < chunk ? -1 : 1;
+      } else {
+        c = comparator_(n->entry[mid], t.entry);
+      }
+      if (c < 0 || (upper && c == 0)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  // Returns the leaf whose key range covers target, recording the inner
+  // nodes on the way when path is not null
+  Leaf* Descend(const Target& t, Path* path) const {
+    Node* n = root_;
+    if (path != nullptr) {
+      path->depth = 0;
+    }
+    while (n->level > 0) {
+      size_t pos = Rank(n, t, true);
+      pos = pos == 0 ? 0 : pos - 1;
+      if (path != nullptr) {
+        path->node[path->depth] = static_cast<Inner*>(n);
+        path->pos[path->depth] = pos;
+        ++path->depth;
+      }
+      n = static_cast<Inner*>(n)->child[pos];
+    }
+    return static_cast<Leaf*>(n);
+  }
+
+  // First entry not less than target, or last entry not greater than target
+  // when backward
+  WriteBatchIndexEntry* Find(WriteBatchIndexEntry* target, bool backward,
+                             Leaf** leaf_ptr) const {
+    Target t{target, Key(target)};
+    Leaf* leaf = Descend(t, nullptr);
+    WriteBatchIndexEntry* result = nullptr;
+    if (!backward) {
+      size_t pos = Rank(leaf, t, false);
+      if (pos < leaf->count) {
+        result = leaf->entry[pos];
+      } else if (leaf->next != nullptr) {
+        leaf = leaf->next;
+        result = leaf->entry[0];
+      }
+    } else {
+      size_t pos = Rank(leaf, t, true);
+      if (pos > 0) {
+        result = leaf->entry[pos - 1];
+      } else if (leaf->prev != nullptr) {
+        leaf = leaf->prev;
+        result = leaf->entry[leaf->count - 1];
+      }
+    }
+    *leaf_ptr = leaf;
+    return result;
+  }
+
+  void Rechunk(Node* n) {
+    if (!bytewise_ || n->count == 0) {
+      return;
+    }
+    n->shared = WriteBatchEntryBTreeIndexDetail::SharedPrefixLength(
+        Key(n->entry[0]), Key(n->entry[n->count - 1]));
+    for (size_t i = 0; i < n->count; ++i) {
+      n->chunk[i] = WriteBatchEntryBTreeIndexDetail::LoadKeyChunk(
+          Key(n->entry[i]), n->shared);
+    }
+  }
+
+  // Refreshes the chunk of slot pos. Only a new first or last slot can
+  // shorten the shared prefix, which rechunks the whole node.
+  void UpdateChunk(Node* n, size_t pos) {
+    if (!bytewise_) {
+      n->chunk[pos] = 0;
+      return;
+    }
+    if (pos == 0 || pos + 1 == n->count) {
+      size_t shared = WriteBatchEntryBTreeIndexDetail::SharedPrefixLength(
+          Key(n->entry[0]), Key(n->entry[n->count - 1]));
+      if (shared != n->shared) {
+        Rechunk(n);
+        return;
+      }
+    }
+    n->chunk[pos] = WriteBatchEntryBTreeIndexDetail::LoadKeyChunk(
+        Key(n->entry[pos]), n->shared);
+  }
+
+  // Inserts entry (and child, for inner nodes) at pos of a node with a free
+  // slot
+  void NodeInsert(Node* n, size_t pos, WriteBatchIndexEntry* entry,
+                  Node* child) {
+    size_t move = n->count - pos;
+    memmove(n->chunk + pos + 1, n->chunk + pos, move * sizeof(uint64_t));
+    memmove(n->entry + pos + 1, n->entry + pos, move * sizeof(void*));
+    if (n->level > 0) {
+      auto inner = static_cast<Inner*>(n);
+      memmove(inner->child + pos + 1, inner->child + pos, move * sizeof(void*));
+      inner->child[pos] = child;
+    }
+    n->entry[pos] = entry;
+    ++n->count;
+    UpdateChunk(n, pos);
+  }
+
+  // Moves the upper half of a full node into a new right sibling
+  Node* Split(Node* n) {
+    size_t half = n->count / 2;
+    size_t move = n->count - half;
+    Node* right;
+    if (n->level == 0) {
+      auto leaf = static_cast<Leaf*>(n);
+      auto sibling = NewLeaf();
+      sibling->prev = leaf;
+      sibling->next = leaf->next;
+      if (leaf->next != nullptr) {
+        leaf->next->prev = sibling;
+      } else {
+        tail_ = sibling;
+      }
+      leaf->next = sibling;
+      right = sibling;
+    } else {
+      auto sibling = NewInner(n->level);
+      memcpy(sibling->child, static_cast<Inner*>(n)->child + half,
+             move * sizeof(void*));
+      right = sibling;
+    }
+    memcpy(right->entry, n->entry + half, move * sizeof(void*));
+    right->count = static_cast<uint32_t>(move);
+    n->count = static_cast<uint32_t>(half);
+    Rechunk(n);
+    Rechunk(right);
+    return right;
+  }
+
+  void Insert(Leaf* leaf, size_t pos, WriteBatchIndexEntry* entry,
+              Path* path) {
+    if (pos == 0) {
+      // new smallest entry, only reachable along the leftmost path
+      for (size_t i = path->depth; i-- > 0;) {
+        assert(path->pos[i] == 0);
+        path->node[i]->entry[0] = entry;
+        UpdateChunk(path->node[i], 0);
+      }
+    }
+    Node* n = leaf;
+    Node* child = nullptr;
+    while (n->count == kFanout) {
+      Node* right = Split(n);
+      if (pos > n->count) {
+        NodeInsert(right, pos - n->count, entry, child);
+      } else {
+        NodeInsert(n, pos, entry, child);
+      }
+      entry = right->entry[0];
+      child = right;
+      if (path->depth == 0) {
+        auto root = NewInner(n->level + 1);
+        NodeInsert(root, 0, n->entry[0], n);
+        NodeInsert(root, 1, entry, child);
+        root_ = root;
+        return;
+      }
+      --path->depth;
+      n = path->node[path->depth];
+      pos = path->pos[path->depth] + 1;
+    }
+    NodeInsert(n, pos, entry, child);
+  }
+
+ public:
+  WriteBatchEntryBTreeIndex(WriteBatchKeyExtractor e, const Comparator* c,
+                            Arena* a)
+      : comparator_({e, c}),
+        arena_(a),
+        bytewise_(strcmp(c->Name(), BytewiseComparator()->Name()) == 0) {
+    head_ = tail_ = NewLeaf();
+    root_ = head_;
+  }
+
+  Iterator* NewIterator() override { return new BTreeIterator(head_); }
+  void NewIterator(IteratorStorage& storage, bool /*ephemeral*/) override {
+    static_assert(sizeof(BTreeIterator) <= sizeof storage.buffer,
+                  "Need larger buffer for BTreeIterator");
+    storage.iter = new (storage.buffer) BTreeIterator(head_);
+  }
+  bool Upsert(WriteBatchIndexEntry* key) override {
+    Target t{key, Key(key)};
+    Path path;
+    Leaf* leaf = Descend(t, &path);
+    size_t pos = Rank(leaf, t, false);
+    if (OverwriteKey && pos < leaf->count &&
+        comparator_(leaf->entry[pos], key) == 0) {
+      // found, replace
+      std::swap(leaf->entry[pos]->offset, key->offset);
+      return false;
+    }
+    Insert(leaf, pos, key, &path);
+    return true;
+  }
+};
+
+const WriteBatchEntryIndexFactory* btree_WriteBatchEntryIndexFactory() {
+  class BTreeIndexFactory : public WriteBatchEntryIndexFactory {
+   public:
+    WriteBatchEntryIndex* New(WriteBatchEntryIndexContext* /*ctx*/,
+                              WriteBatchKeyExtractor e, const Comparator* c,
+                              Arena* a, bool overwite_key) const override {
+      if (overwite_key) {
+        typedef WriteBatchEntryBTreeIndex<true> index_t;
+        return new (a->AllocateAligned(sizeof(index_t))) index_t(e, c, a);
+      } else {
+        typedef WriteBatchEntryBTreeIndex<false> index_t;
+        return new (a->AllocateAligned(sizeof(index_t))) index_t(e, c, a);
+      }
+    }
+    const char* Name() const override final { return "btree"; }
+  };
+  static BTreeIndexFactory factory;
+  return &factory;
+}
+
+}  // namespace rocksdb
+
+#endif  // !ROCKSDB_LITE
@@ -0,0 +1,157 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#if !defined(GFLAGS) || defined(ROCKSDB_LITE)
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <inttypes.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/stack_trace.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/utilities/write_batch_with_index.h"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+#include "util/stop_watch.h"
+#include "util/string_util.h"
+#include "utilities/write_batch_with_index/write_batch_with_index_internal.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_string(benchmarks, "fillrandom,readrandom,seekrandom,readseq",
+              "Comma-separated list of benchmarks to run. Options:\n"
+              "\tfillrandom             -- put N keys in random order\n"
+              "\treadrandom             -- GetFromBatch N keys in random "
+              "order\n"
+              "\tseekrandom             -- seek an iterator to N random keys\n"
+              "\treadseq                -- scan the whole batch\n");
+
+DEFINE_string(index_types, "skip_list,btree,patricia",
+              "Comma-separated list of write batch index factories to "
+              "compare. Names that are not registered are skipped.");
+
+DEFINE_int32(num_operations, 1000000, "Number of keys put into each batch");
+
+DEFINE_int32(key_prefix_size, 16,
+             "Length of the prefix shared by all keys, emulating the "
+             "table or index prefix of encoded keys");
+
+DEFINE_int32(value_size, 16, "Number of bytes of each value");
+
+DEFINE_bool(overwrite_key, true,
+            "Keep only the newest entry of each key in the index");
+
+DEFINE_int64(seed, 0,
+             "Seed base for random number generators. "
+             "When 0 it is deterministic.");
+
+namespace rocksdb {
+
+namespace {
+
+std::string MakeKey(uint64_t k) {
+  char buf[32];
+  snprintf(buf, sizeof buf, "%016" PRIx64, k);
+  return std::string(FLAGS_key_prefix_size, 'k') + buf;
+}
+
+class Benchmark {
+ public:
+  Benchmark(const WriteBatchEntryIndexFactory* factory,
+            const std::vector<uint64_t>& keys)
+      : factory_(factory),
+        keys_(keys),
+        batch_(BytewiseComparator(), 0, FLAGS_overwrite_key, 0, factory),
+        value_(FLAGS_value_size, 'v') {}
+
+  void Run(const std::string& name) {
+    uint64_t ops = 0;
+    StopWatchNano timer(Env::Default(), true);
+    if (name == "fillrandom") {
+      batch_.Clear();
+      for (uint64_t k : keys_) {
+        batch_.Put(MakeKey(k), value_);
+      }
+      ops = keys_.size();
+    } else if (name == "readrandom") {
+      DBOptions options;
+      std::string value;
+      for (uint64_t k : keys_) {
+        batch_.GetFromBatch(options, MakeKey(k), &value);
+      }
+      ops = keys_.size();
+    } else if (name == "seekrandom") {
+      std::unique_ptr<WBWIIterator> iter(batch_.NewIterator());
+      for (uint64_t k : keys_) {
+        iter->Seek(MakeKey(k));
+      }
+      ops = keys_.size();
+    } else if (name == "readseq") {
+      std::unique_ptr<WBWIIterator> iter(batch_.NewIterator());
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ++ops;
+      }
+    } else {
+      fprintf(stderr, "Unknown benchmark: %s\n", name.c_str());
+      return;
+    }
+    uint64_t elapsed = timer.ElapsedNanos();
+    fprintf(stdout, "%-10s : %-12s : %10.3f micros/op %10" PRIu64 " ops\n",
+            factory_->Name(), name.c_str(),
+            ops == 0 ? 0.0 : elapsed / 1000.0 / ops, ops);
+  }
+
+ private:
+  const WriteBatchEntryIndexFactory* factory_;
+  const std::vector<uint64_t>& keys_;
+  WriteBatchWithIndex batch_;
+  std::string value_;
+};
+
+}  // namespace
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+
+  rocksdb::Random64 rnd(FLAGS_seed);
+  std::vector<uint64_t> keys(FLAGS_num_operations);
+  for (auto& k : keys) {
+    k = rnd.Next();
+  }
+
+  for (auto& type : rocksdb::StringSplit(FLAGS_index_types, ',')) {
+    auto factory = rocksdb::GetWriteBatchEntryIndexFactory(type.c_str());
+    if (factory == nullptr) {
+      fprintf(stdout, "%-10s : not registered, skipped\n", type.c_str());
+      continue;
+    }
+    rocksdb::Benchmark benchmark(factory, keys);
+    for (auto& name : rocksdb::StringSplit(FLAGS_benchmarks, ',')) {
+      benchmark.Run(name);
+    }
+  }
+  return 0;
+}
+
+#endif  // GFLAGS
@@ -243,26 +243,6 @@ Slice WriteBatchKeyExtractor::operator()(
   }
 }
 
-template <bool OverwriteKey>
-struct WriteBatchEntryComparator {
-  int operator()(WriteBatchIndexEntry* l, WriteBatchIndexEntry* r) const {
-    int cmp = c->Compare(extractor(l), extractor(r));
-    // unnecessary comp offset if overwrite key
-    if (OverwriteKey || cmp != 0) {
-      return cmp;
-    }
-    if (l->offset > r->offset) {
-      return 1;
-    }
-    if (l->offset < r->offset) {
-      return -1;
-    }
-    return 0;
-  }
-  WriteBatchKeyExtractor extractor;
-  const Comparator* c;
-};
-
 template <bool OverwriteKey>
 class WriteBatchEntrySkipListIndex : public WriteBatchEntryIndex {
  protected:
@@ -376,6 +356,7 @@ const WriteBatchEntryIndexFactory* GetWriteBatchEntryIndexFactory(
 }
 
 ROCKSDB_REGISTER_WRITE_BATCH_WITH_INDEX(skip_list);
+ROCKSDB_REGISTER_WRITE_BATCH_WITH_INDEX(btree);
 
 }  // namespace rocksdb
 
@@ -95,6 +95,26 @@ class WriteBatchKeyExtractor {
   const ReadableWriteBatch* write_batch_;
 };
 
+template <bool OverwriteKey>
+struct WriteBatchEntryComparator {
+  int operator()(WriteBatchIndexEntry* l, WriteBatchIndexEntry* r) const {
+    int cmp = c->Compare(extractor(l), extractor(r));
+    // unnecessary comp offset if overwrite key
+    if (OverwriteKey || cmp != 0) {
+      return cmp;
+    }
+    if (l->offset > r->offset) {
+      return 1;
+    }
+    if (l->offset < r->offset) {
+      return -1;
+    }
+    return 0;
+  }
+  WriteBatchKeyExtractor extractor;
+  const Comparator* c;
+};
+
 class WriteBatchEntryIndex {
  public:
   virtual ~WriteBatchEntryIndex() {}
@@ -276,6 +276,7 @@ void TestValueAsSecondaryIndexHelper(std::vector<Entry> entries,
 namespace {
   const std::initializer_list<const WriteBatchEntryIndexFactory*>& all_index_types = {
           skip_list_WriteBatchEntryIndexFactory(),
+          btree_WriteBatchEntryIndexFactory(),
   };
 }
 